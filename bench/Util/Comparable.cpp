@@ -0,0 +1,150 @@
+/****************************************
+ * bench/Util/Comparable.cpp
+ *
+ * CompDefが比較演算子を<演算子から求める場合と、<=>演算子から求める場合の時間を比べる。
+ * <演算子だけでは==演算子に二度の比較が要るので、整列して重複を除く処理や、
+ * 同じものを除きながら上位を保持するヒープで差が出る。
+ * 時刻(lfl::Time)のような整数一つの比較ではほとんど差が無く、
+ * 文字列(jig::STRING::Literal)のように比較が先頭から歩く型で差が出ることを確かめる。
+ ****************************************/
+#include "Util/Comparable.hpp"
+#include "jig.hpp"
+#include "lfl/Time.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+STATIC_CONSTEXPR std::size_t ELEMENT_NUM = 1 << 18;
+// 重複を作るために、値の種類を要素の数より少なくする。
+STATIC_CONSTEXPR std::size_t DISTINCT_NUM = ELEMENT_NUM / 4;
+STATIC_CONSTEXPR std::size_t TOP_NUM = 100;
+STATIC_CONSTEXPR int REPEAT_NUM = 8;
+STATIC_CONSTEXPR std::size_t NAME_LENGTH = 32;
+
+using Name = jig::STRING::Literal<char, NAME_LENGTH>;
+
+// <演算子だけを持つ時刻(これまでのTime)
+class LessTime : public UTIL::COMPARABLE::CompDef<LessTime> {
+public:
+  explicit LessTime( lfl::Time const time ) : time_( time ) {}
+  friend bool operator < ( LessTime const & lhs, LessTime const & rhs ) noexcept { return ( lhs.time_.ns() < rhs.time_.ns() ); }
+private:
+  lfl::Time time_;
+};
+
+// <演算子だけを持つ名前(比較そのものはLiteralと同じ)
+class LessName : public UTIL::COMPARABLE::CompDef<LessName> {
+public:
+  explicit LessName( Name const & name ) : name_( name ) {}
+  friend bool operator < ( LessName const & lhs, LessName const & rhs ) noexcept { return ( lhs.name_ < rhs.name_ ); }
+private:
+  Name name_;
+};
+
+std::uint64_t Next( std::uint64_t & state ) noexcept {
+  state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+  return state >> 33;
+}
+
+// 値の並び(乱数の代わりに線形合同法で再現できるようにする)
+std::vector<std::uint64_t> MakeKeys() {
+  std::vector<std::uint64_t> keys;
+  keys.reserve( ELEMENT_NUM );
+
+  std::uint64_t state = 88172645463325252ULL;
+  for ( std::size_t index = 0; index < ELEMENT_NUM; ++index ) { keys.emplace_back( Next( state ) % DISTINCT_NUM ); }
+
+  return keys;
+}
+
+// 成果物の置き場のように、長い共通の接頭辞を持つ名前
+Name MakeName( std::uint64_t const key ) {
+  std::string text( "build/output/artifact_" );
+  text.append( std::to_string( 1000000 + key ) );
+
+  Name name;
+  name.append( text.c_str() );
+  return name;
+}
+
+// 整列して、重複を除いた数を返す(std::uniqueは==演算子を使う)。
+template<typename T>
+std::size_t SortUnique( std::vector<T> values ) {
+  std::sort( values.begin(), values.end() );
+  return static_cast<std::size_t>( std::unique( values.begin(), values.end() ) - values.begin() );
+}
+
+// 最小ヒープに上位TOP_NUM件を保持する。先頭と同じものは入れない(複数の結果を併合するときの重複)。
+template<typename T>
+std::size_t HeapTop( std::vector<T> const & values ) {
+  auto const newer_first = []( T const & lhs, T const & rhs ){ return ( rhs < lhs ); };
+  std::vector<T> heap;
+  heap.reserve( TOP_NUM );
+
+  for ( auto const & itr : values ) {
+    if ( heap.size() < TOP_NUM ) {
+      heap.emplace_back( itr );
+      std::push_heap( heap.begin(), heap.end(), newer_first );
+    } else if ( !( itr == heap.front() ) && heap.front() < itr ) {
+      std::pop_heap( heap.begin(), heap.end(), newer_first );
+      heap.back() = itr;
+      std::push_heap( heap.begin(), heap.end(), newer_first );
+    }
+  }
+
+  return heap.size();
+}
+
+// 他の処理に割り込まれた回を除くため、REPEAT_NUM回のうち最も速かった回の時間を出す。
+template<typename Function>
+void Measure( char const * label, Function && function ) {
+  std::size_t result = 0;
+  double best = 0.0;
+
+  for ( int repeat = 0; repeat < REPEAT_NUM; ++repeat ) {
+    auto const begin = std::chrono::steady_clock::now();
+    result += function();
+    double const elapsed = std::chrono::duration<double, std::nano>( std::chrono::steady_clock::now() - begin ).count();
+    if ( repeat == 0 || elapsed < best ) { best = elapsed; }
+  }
+
+  // resultを出力して、処理が最適化で消されないようにする。
+  std::cout << label << ": " << ( best / static_cast<double>( ELEMENT_NUM ) ) << " ns/element ( " << ( result / REPEAT_NUM ) << " )\n";
+}
+
+} // namespace
+
+int main() {
+  std::vector<std::uint64_t> const keys = MakeKeys();
+
+  std::vector<LessTime> less_times;
+  std::vector<lfl::Time> times;
+  std::vector<LessName> less_names;
+  std::vector<Name> names;
+  for ( auto const itr : keys ) {
+    lfl::Time const time( static_cast<lfl::Time::rep>( itr ) * 1000 );
+    less_times.emplace_back( time );
+    times.emplace_back( time );
+    less_names.emplace_back( MakeName( itr ) );
+    names.emplace_back( MakeName( itr ) );
+  }
+
+  Measure( "Time sort+unique ( < only )", [ & ]{ return SortUnique( less_times ); } );
+  Measure( "Time sort+unique ( <=> )", [ & ]{ return SortUnique( times ); } );
+  Measure( "Time heap top-100 ( < only )", [ & ]{ return HeapTop( less_times ); } );
+  Measure( "Time heap top-100 ( <=> )", [ & ]{ return HeapTop( times ); } );
+
+  Measure( "Literal sort+unique ( < only )", [ & ]{ return SortUnique( less_names ); } );
+  Measure( "Literal sort+unique ( <=> )", [ & ]{ return SortUnique( names ); } );
+  Measure( "Literal heap top-100 ( < only )", [ & ]{ return HeapTop( less_names ); } );
+  Measure( "Literal heap top-100 ( <=> )", [ & ]{ return HeapTop( names ); } );
+
+  return 0;
+}
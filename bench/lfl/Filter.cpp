@@ -0,0 +1,96 @@
+/****************************************
+ * bench/lfl/Filter.cpp
+ *
+ * 絞り込みの、エントリ一つあたりの評価にかかる時間を測る。
+ * 走査ではエントリごとに評価するので、ディレクトリを読む時間(エントリあたり数十ナノ秒)に
+ * 比べて十分に小さいことを確かめる。
+ ****************************************/
+#include "lfl/Filter.hpp"
+#include "lfl/Value.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+namespace {
+
+using namespace lfl;
+
+STATIC_CONSTEXPR std::size_t ENTRY_NUM = 1 << 16;
+STATIC_CONSTEXPR int REPEAT_NUM = 64;
+
+char const * const EXTENSIONS[] = { ".txt", ".log", ".cpp", ".hpp", ".o", ".json", ".md", ".png" };
+
+struct Sample {
+  std::vector<std::string> names;
+  std::vector<FoundEntry> entries;
+};
+
+// 拡張子、サイズ、時刻がばらけたエントリを作る(乱数の代わりに線形合同法で再現できるようにする)。
+Sample MakeSample() {
+  Sample sample;
+  sample.names.reserve( ENTRY_NUM );
+  sample.entries.reserve( ENTRY_NUM );
+
+  std::uint64_t state = 88172645463325252ULL;
+  for ( std::size_t index = 0; index < ENTRY_NUM; ++index ) {
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    sample.names.emplace_back( "file_" + std::to_string( index ) + EXTENSIONS[( state >> 33 ) % jig::ArraySize( EXTENSIONS )] );
+  }
+  for ( std::size_t index = 0; index < ENTRY_NUM; ++index ) {
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    Time const time( static_cast<Time::rep>( ( state >> 20 ) % ( 1ULL << 40 ) ) * 1000 );
+    sample.entries.emplace_back( FoundEntry{ sample.names[index], time, ( state >> 8 ) % ( 1ULL << 24 ), ( state & 0xF ) ? EntryType::FILE : EntryType::DIRECTORY } );
+  }
+
+  return sample;
+}
+
+void Measure( char const * label, Filter const & filter, Sample const & sample ) {
+  std::size_t matched = 0;
+
+  auto const begin = std::chrono::steady_clock::now();
+  for ( int repeat = 0; repeat < REPEAT_NUM; ++repeat ) {
+    for ( auto const & itr : sample.entries ) {
+      // 走査と同じく、名前で外れたら情報は調べない。
+      if ( filter.matchName( itr.name ) && filter.matchInformation( itr, itr.time ) ) { ++matched; }
+    }
+  }
+  auto const elapsed = std::chrono::duration<double, std::nano>( std::chrono::steady_clock::now() - begin ).count();
+
+  // matchedを出力して、ループが最適化で消されないようにする。
+  std::cout << label << ": " << ( elapsed / ( static_cast<double>( ENTRY_NUM ) * REPEAT_NUM ) ) << " ns/entry ( matched " << ( matched / REPEAT_NUM ) << " )\n";
+}
+
+} // namespace
+
+int main() {
+  Sample const sample = MakeSample();
+
+  Measure( "no filter", Filter(), sample );
+
+  FilterSpec suffix;
+  suffix.names = { "*.log" };
+  Measure( "--name *.log", Filter( suffix ), sample );
+
+  FilterSpec patterns;
+  patterns.names = { "*.log", "*.json", "file_1*", "*_?0.t?t" };
+  Measure( "--name x4 ( suffix, prefix, glob )", Filter( patterns ), sample );
+
+  FilterSpec information;
+  information.min_size = 1 << 20;
+  information.type_mask = 1U << static_cast<unsigned>( EntryType::FILE );
+  std::tie( information.min_time, information.max_time ) = VALUE::ParseTimeRange( "mtime-range", "1970-01-01T00:05..1970-01-01T00:15" );
+  Measure( "--type --min-size --mtime-range", Filter( information ), sample );
+
+  FilterSpec combined = information;
+  combined.names = suffix.names;
+  Measure( "--name *.log --type --min-size --mtime-range", Filter( combined ), sample );
+
+  return 0;
+}
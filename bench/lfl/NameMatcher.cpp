@@ -0,0 +1,92 @@
+/****************************************
+ * bench/lfl/NameMatcher.cpp
+ *
+ * --nameの照合を、変換した名前に対するFilter::matchNameと、
+ * バッファの中のUTF-16のままのWideNameMatcherとで比べる。
+ * 名前はFILE_FULL_DIR_INFOと同じように、一つのバッファに詰めて並べる。
+ ****************************************/
+#include "lfl/NameMatcher.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+using namespace lfl;
+
+STATIC_CONSTEXPR std::size_t ENTRY_NUM = 1 << 16;
+STATIC_CONSTEXPR int REPEAT_NUM = 64;
+// FILE_FULL_DIR_INFOで名前の前にある部分の大きさ(UTF-16の文字数)
+STATIC_CONSTEXPR std::size_t HEADER_LENGTH = 34;
+
+char const * const EXTENSIONS[] = { ".txt", ".log", ".cpp", ".hpp", ".o", ".json", ".md", ".parquet" };
+
+struct Sample {
+  std::vector<std::string> names;
+  // ヘッダの分を空けて名前を詰めたバッファと、それぞれの名前の位置と長さ
+  std::u16string packed;
+  std::vector<std::size_t> offsets;
+  std::vector<std::size_t> lengths;
+};
+
+Sample MakeSample() {
+  Sample sample;
+  std::uint64_t state = 88172645463325252ULL;
+
+  for ( std::size_t index = 0; index < ENTRY_NUM; ++index ) {
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    std::string name = "part-" + std::to_string( index ) + EXTENSIONS[( state >> 33 ) % jig::ArraySize( EXTENSIONS )];
+
+    sample.packed.append( HEADER_LENGTH, u'\0' );
+    sample.offsets.emplace_back( sample.packed.size() );
+    sample.packed.append( name.begin(), name.end() );
+    sample.lengths.emplace_back( name.size() );
+    sample.names.emplace_back( std::move( name ) );
+  }
+  sample.packed.append( WIDE_LANES, u'\0' );
+
+  return sample;
+}
+
+template<typename Function>
+void Measure( char const * label, Function && function ) {
+  std::size_t matched = 0;
+
+  auto const begin = std::chrono::steady_clock::now();
+  for ( int repeat = 0; repeat < REPEAT_NUM; ++repeat ) {
+    for ( std::size_t index = 0; index < ENTRY_NUM; ++index ) {
+      if ( function( index ) ) { ++matched; }
+    }
+  }
+  auto const elapsed = std::chrono::duration<double, std::nano>( std::chrono::steady_clock::now() - begin ).count();
+
+  std::cout << label << ": " << ( elapsed / ( static_cast<double>( ENTRY_NUM ) * REPEAT_NUM ) ) << " ns/entry ( matched " << ( matched / REPEAT_NUM ) << " )\n";
+}
+
+void Compare( char const * label, std::vector<std::string_view> const & names, Sample const & sample ) {
+  FilterSpec spec;
+  spec.names = names;
+  Filter const filter( spec );
+  WideNameMatcher const matcher( filter.patterns() );
+
+  std::cout << label << '\n';
+  Measure( "  Filter::matchName", [ & ]( std::size_t const index ){ return filter.matchName( sample.names[index] ); } );
+  Measure( "  WideNameMatcher", [ & ]( std::size_t const index ){ return matcher.match( sample.packed.data() + sample.offsets[index], sample.lengths[index] ); } );
+}
+
+} // namespace
+
+int main() {
+  Sample const sample = MakeSample();
+
+  Compare( "--name *.parquet", { "*.parquet" }, sample );
+  Compare( "--name *.parquet --name *.log", { "*.parquet", "*.log" }, sample );
+  Compare( "--name *123*", { "*123*" }, sample );
+
+  return 0;
+}
@@ -0,0 +1,153 @@
+/****************************************
+ * bench/lfl/Spawn.cpp
+ *
+ * lflを何千回も起動して、起動から終了までの時間(壁時計)の中央値と99パーセンタイルを測る。
+ * シェルのプロンプトのフックのように毎回起動する使い方では、走査よりも起動の時間が支配的になる。
+ * 静的にリンクしたビルド(LFL_COLD_START)と比べたり、起動の時間が悪化していないかを確かめたりする。
+ *
+ * bench_spawn [--runs N] [--max-p99 MS] [--exe PATH] [-- lflの引数...]
+ *   --runs: 起動する回数(既定: 2000)
+ *   --max-p99: 99パーセンタイルがMSミリ秒を超えたら、終了コードを1にする(悪化の検出)
+ *   --exe: 起動する実行ファイル(既定: 同じビルドのlfl)
+ * lflの出力は捨てる(NULに書く)。
+ ****************************************/
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <windows.h>
+
+#if !defined( LFL_EXECUTABLE )
+#define LFL_EXECUTABLE "lfl.exe"
+#endif
+
+namespace {
+
+constexpr std::size_t DEFAULT_RUN_NUM = 2000;
+// 最初の数回はファイルキャッシュが温まっていないので、数えない。
+constexpr std::size_t WARMUP_NUM = 20;
+
+// CreateProcessに渡すコマンドライン。空白を含む引数は""で囲む。
+void AppendArgument( std::string & command_line, std::string_view const arg ) {
+  if ( !command_line.empty() ) { command_line.push_back( ' ' ); }
+
+  bool const needs_quote = arg.empty() || ( arg.find_first_of( " \t" ) != std::string_view::npos );
+  if ( needs_quote ) { command_line.push_back( '"' ); }
+  command_line.append( arg );
+  if ( needs_quote ) { command_line.push_back( '"' ); }
+}
+
+// 一度起動して、終了するまでの時間(ミリ秒)を返す。起動できなければ負の値を返す。
+double SpawnOnce( std::string const & command_line, HANDLE const null_device ) {
+  STARTUPINFO startup = {};
+  startup.cb = sizeof( startup );
+  startup.dwFlags = STARTF_USESTDHANDLES;
+  startup.hStdInput = null_device;
+  startup.hStdOutput = null_device;
+  startup.hStdError = null_device;
+
+  PROCESS_INFORMATION process = {};
+  // CreateProcessはコマンドラインを書き換えることがあるので、毎回コピーを渡す。
+  std::vector<char> buffer( command_line.begin(), command_line.end() );
+  buffer.push_back( '\0' );
+
+  auto const begin = std::chrono::steady_clock::now();
+  if ( CreateProcess( nullptr, buffer.data(), nullptr, nullptr, TRUE, CREATE_NO_WINDOW, nullptr, nullptr, &startup, &process ) == 0 ) { return -1.0; }
+  WaitForSingleObject( process.hProcess, INFINITE );
+  auto const end = std::chrono::steady_clock::now();
+
+  CloseHandle( process.hThread );
+  CloseHandle( process.hProcess );
+
+  return std::chrono::duration<double, std::milli>( end - begin ).count();
+}
+
+// 昇順に並んだtimesの、ratioの位置の値(最も近い順位)
+double Percentile( std::vector<double> const & times, double const ratio ) {
+  std::size_t const rank = static_cast<std::size_t>( ratio * static_cast<double>( times.size() - 1 ) + 0.5 );
+  return times[std::min( rank, times.size() - 1 )];
+}
+
+} // namespace
+
+int main( int argc, char const * argv[] ) {
+  std::size_t run_num = DEFAULT_RUN_NUM;
+  double max_p99 = 0.0;
+  std::string command_line;
+  std::string executable( LFL_EXECUTABLE );
+
+  int index = 1;
+  for ( ; index < argc; ++index ) {
+    std::string_view const arg( argv[index] );
+
+    if ( arg == "--" ) {
+      ++index;
+      break;
+    }
+    if ( index + 1 >= argc ) {
+      std::cerr << arg << ": needs a value\n";
+      return 2;
+    }
+
+    if ( arg == "--runs" ) {
+      run_num = static_cast<std::size_t>( std::strtoull( argv[++index], nullptr, 10 ) );
+    } else if ( arg == "--max-p99" ) {
+      max_p99 = std::strtod( argv[++index], nullptr );
+    } else if ( arg == "--exe" ) {
+      executable = argv[++index];
+    } else {
+      std::cerr << arg << ": unknown option\n";
+      return 2;
+    }
+  }
+
+  AppendArgument( command_line, executable );
+  for ( ; index < argc; ++index ) { AppendArgument( command_line, argv[index] ); }
+
+  // 子プロセスに引き継がせるので、継承できるハンドルとして開く。
+  SECURITY_ATTRIBUTES security = {};
+  security.nLength = sizeof( security );
+  security.bInheritHandle = TRUE;
+  HANDLE const null_device = CreateFile( "NUL", GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, &security, OPEN_EXISTING, 0, nullptr );
+  if ( null_device == INVALID_HANDLE_VALUE ) {
+    std::cerr << "cannot open NUL\n";
+    return 2;
+  }
+
+  std::vector<double> times;
+  times.reserve( run_num );
+  for ( std::size_t run = 0; run < WARMUP_NUM + run_num; ++run ) {
+    double const elapsed = SpawnOnce( command_line, null_device );
+    if ( elapsed < 0.0 ) {
+      std::cerr << command_line << ": cannot be started\n";
+      CloseHandle( null_device );
+      return 2;
+    }
+
+    if ( run >= WARMUP_NUM ) { times.emplace_back( elapsed ); }
+  }
+  CloseHandle( null_device );
+
+  if ( times.empty() ) { return 0; }
+  std::sort( times.begin(), times.end() );
+
+  double const p50 = Percentile( times, 0.50 );
+  double const p99 = Percentile( times, 0.99 );
+  std::cout << command_line << "\n"
+            << "runs: " << times.size() << "\n"
+            << "min: " << times.front() << " ms\n"
+            << "p50: " << p50 << " ms\n"
+            << "p99: " << p99 << " ms\n"
+            << "max: " << times.back() << " ms\n";
+
+  if ( max_p99 > 0.0 && p99 > max_p99 ) {
+    std::cout << "p99 exceeds " << max_p99 << " ms\n";
+    return 1;
+  }
+
+  return 0;
+}
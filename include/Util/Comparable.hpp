@@ -3,6 +3,7 @@
  ****************************************/
 #pragma once
 
+#include <compare>
 #include <utility>
 #include <type_traits>
 
@@ -23,6 +24,20 @@ struct is_lt_impl {
 template<class Left, class Right>
 struct has_less_than : public decltype( is_lt_impl::check<Left, Right>( nullptr, nullptr ) ){};
 
+/****************************************
+ * <=>演算子が定義されているかを判定するためのメタ関数
+ ****************************************/
+struct is_three_way_impl {
+  template<class Left, class Right>
+  static auto check( Left*, Right* ) -> decltype( std::declval<Left const &>() <=> std::declval<Right const &>(), std::true_type() );
+
+  template<class Left, class Right>
+  static auto check(...) -> std::false_type;
+};
+
+template<class Left, class Right>
+struct has_three_way : public decltype( is_three_way_impl::check<Left, Right>( nullptr, nullptr ) ){};
+
 /****************************************
  * CRTPパターン
  *
@@ -32,6 +47,11 @@ struct has_less_than : public decltype( is_lt_impl::check<Left, Right>( nullptr,
  *
  * <<演算子と<演算子をうっかり間違って定義していた場合などは
  * <演算子がbool以外の値を返す可能性があるので、警告を出す
+ *
+ * <=>演算子も定義されていれば、他の比較演算子は<=>演算子の一度の結果から求める。
+ * <演算子からでは==演算子に二度の比較が要るので、文字列のように比較が重い型では<=>演算子を定義するとよい。
+ * (<=>演算子だけでも、<演算子は<=>演算子から書き換えられるので定義されているとみなされる)
+ * <=>演算子はfriendとして定義すること(defaultにすると、基底のCompDefを比べられずに削除される)。
  ****************************************/
 template<class HasLT>
 class CompDef {
@@ -46,21 +66,38 @@ public:
     static_assert(std::is_same<decltype( std::declval<HasLT>() < std::declval<HasLT>() ), bool>::value, "operator < does NOT return bool value");
   }
 
-  friend constexpr bool operator > ( const_reference c1, const_reference c2 ) noexcept { return( c2 < c1 ); }
+  friend constexpr bool operator > ( const_reference c1, const_reference c2 ) noexcept {
+    if constexpr ( has_three_way<HasLT, HasLT>::value ) { return( ( c1 <=> c2 ) > 0 ); } else { return( c2 < c1 ); }
+  }
   template<typename T>
-  friend constexpr bool operator > ( const_reference c1, T c2 ) noexcept { return( c2 < c1 ); }
+  friend constexpr bool operator > ( const_reference c1, T const & c2 ) noexcept {
+    if constexpr ( has_three_way<HasLT, T>::value ) { return( ( c1 <=> c2 ) > 0 ); } else { return( c2 < c1 ); }
+  }
 
-  friend constexpr bool operator <= ( const_reference c1, const_reference c2 ) noexcept { return( !( c2 < c1 ) ); }
+  friend constexpr bool operator <= ( const_reference c1, const_reference c2 ) noexcept {
+    if constexpr ( has_three_way<HasLT, HasLT>::value ) { return( ( c1 <=> c2 ) <= 0 ); } else { return( !( c2 < c1 ) ); }
+  }
   template<typename T>
-  friend constexpr bool operator <= ( const_reference c1, T c2 ) noexcept { return( !( c2 < c1 ) ); }
+  friend constexpr bool operator <= ( const_reference c1, T const & c2 ) noexcept {
+    if constexpr ( has_three_way<HasLT, T>::value ) { return( ( c1 <=> c2 ) <= 0 ); } else { return( !( c2 < c1 ) ); }
+  }
 
-  friend constexpr bool operator >= ( const_reference c1, const_reference c2 ) noexcept { return( !( c1 < c2 ) ); }
+  friend constexpr bool operator >= ( const_reference c1, const_reference c2 ) noexcept {
+    if constexpr ( has_three_way<HasLT, HasLT>::value ) { return( ( c1 <=> c2 ) >= 0 ); } else { return( !( c1 < c2 ) ); }
+  }
   template<typename T>
-  friend constexpr bool operator >= ( const_reference c1, T c2 ) noexcept { return( !( c1 < c2 ) ); }
+  friend constexpr bool operator >= ( const_reference c1, T const & c2 ) noexcept {
+    if constexpr ( has_three_way<HasLT, T>::value ) { return( ( c1 <=> c2 ) >= 0 ); } else { return( !( c1 < c2 ) ); }
+  }
 
-  friend constexpr bool operator == ( const_reference c1, const_reference c2 ) noexcept { return( !( c1 < c2 ) && !( c2 < c1 ) ); }
+  // <演算子だけなら、二度比べる必要がある。
+  friend constexpr bool operator == ( const_reference c1, const_reference c2 ) noexcept {
+    if constexpr ( has_three_way<HasLT, HasLT>::value ) { return( ( c1 <=> c2 ) == 0 ); } else { return( !( c1 < c2 ) && !( c2 < c1 ) ); }
+  }
   template<typename T>
-  friend constexpr bool operator == ( const_reference c1, T c2 ) noexcept { return( !( c1 < c2 ) && !( c2 < c1 ) ); }
+  friend constexpr bool operator == ( const_reference c1, T const & c2 ) noexcept {
+    if constexpr ( has_three_way<HasLT, T>::value ) { return( ( c1 <=> c2 ) == 0 ); } else { return( !( c1 < c2 ) && !( c2 < c1 ) ); }
+  }
   // friend constexpr bool operator != ( const_reference c1, const_reference c2 ) noexcept { return( !( c1 == c2 ) ); }
 };
 
@@ -48,11 +48,13 @@
 #include "Util/Comparable.hpp"
 
 #include <string>
+#include <string_view>
 #include <stdexcept>
 #include <cstring>
 #include <utility>
 #include <type_traits>
 #include <algorithm>
+#include <compare>
 #include <ostream>
 
 #define STATIC_CONSTEXPR static constexpr
@@ -111,6 +113,18 @@ constexpr bool IsSameN( T const str1, T const str2, size_type const N ) {
   return true;
 }
 
+// 辞書順の比較。最初に異なる文字で決まり、一方が他方の先頭部分なら短い方が小さい。
+template<typename CharT>
+constexpr std::strong_ordering CompareN( CharT const * const str1, size_type const len1, CharT const * const str2, size_type const len2 ) noexcept {
+  size_type const len = std::min( len1, len2 );
+
+  for ( index_type index = 0; index < len; ++index ) {
+    if ( str1[index] != str2[index] ) { return ( str1[index] < str2[index] ) ? std::strong_ordering::less : std::strong_ordering::greater; }
+  }
+
+  return ( len1 <=> len2 );
+}
+
 // N is guaranteed greater than 0. It has no meanings str_chars_[0] when compiling.
 // Because this array can't be changed it size and value later.
 template<typename CharT, size_type N, UTIL::if_nullp_c<( N > 0 )>* = nullptr>
@@ -194,41 +208,36 @@ template<typename CharT, size_type N>
 ExcludeNULLLiteralImpl( CharT const ( & literal )[N], std::make_index_sequence<N>() ) -> ExcludeNULLLiteralImpl<CharT, N - 1>;
 
 ////////////////////
-// operator<
+// operator<=>
 ////////////////////
+// CompDefは<=>演算子があれば、==演算子などを一度の比較で求める。
+// 文字列リテラルの末尾の'\0'は比べない。
 template<typename CharT, size_type N1, size_type N2>
-constexpr bool operator< ( ExcludeNULLLiteralImpl<CharT, N1> const & literal1, ExcludeNULLLiteralImpl<CharT, N2> const & literal2 ) noexcept {
-  auto len1 = literal1.len_;
-  auto len2 = literal2.len_;
-
-  for ( size_type index = 0; index < std::min( len1, len2 ); ++index ) {
-    if ( literal1[index] < literal2[index] ) { return true; }
-  }
-
-  return ( len1 < len2 );
+constexpr std::strong_ordering operator<=> ( ExcludeNULLLiteralImpl<CharT, N1> const & literal1, ExcludeNULLLiteralImpl<CharT, N2> const & literal2 ) noexcept {
+  return CompareN( literal1.get(), literal1.len_, literal2.get(), literal2.len_ );
 }
 
 template<typename CharT, size_type N1, size_type N2>
-constexpr bool operator< ( ExcludeNULLLiteralImpl<CharT, N1> const & literal1, CharT const ( & literal2 )[N2] ) noexcept {
-  auto len1 = literal1.len_;
-
-  for ( size_t index = 0; index < std::min( len1, N2 ); ++index ) {
-    if ( literal1[index] < literal2[index] ) { return true; }
-  }
+constexpr std::strong_ordering operator<=> ( ExcludeNULLLiteralImpl<CharT, N1> const & literal1, CharT const ( & literal2 )[N2] ) noexcept {
+  return CompareN( literal1.get(), literal1.len_, literal2, N2 - 1 );
+}
 
-  return ( len1 < ( N2 - 1 ) );
+template<typename CharT, size_type N1, size_type N2>
+constexpr std::strong_ordering operator<=> ( CharT const ( & literal1 )[N1], ExcludeNULLLiteralImpl<CharT, N2> const & literal2 ) noexcept {
+  return CompareN( literal1, N1 - 1, literal2.get(), literal2.len_ );
 }
 
+////////////////////
+// operator<
+////////////////////
 template<typename CharT, size_type N1, size_type N2>
-constexpr bool operator< ( CharT const ( & literal1 )[N1], ExcludeNULLLiteralImpl<CharT, N2> const & literal2 ) noexcept {
-  auto len2 = literal2.len_;
+constexpr bool operator< ( ExcludeNULLLiteralImpl<CharT, N1> const & literal1, ExcludeNULLLiteralImpl<CharT, N2> const & literal2 ) noexcept { return ( ( literal1 <=> literal2 ) < 0 ); }
 
-  for ( size_t index = 0; index < std::min( N1, len2 ) ; ++index ) {
-    if ( literal1[index] <  literal2[index] ) { return true; }
-  }
+template<typename CharT, size_type N1, size_type N2>
+constexpr bool operator< ( ExcludeNULLLiteralImpl<CharT, N1> const & literal1, CharT const ( & literal2 )[N2] ) noexcept { return ( ( literal1 <=> literal2 ) < 0 ); }
 
-  return ( ( N1 - 1 ) < len2 );
-}
+template<typename CharT, size_type N1, size_type N2>
+constexpr bool operator< ( CharT const ( & literal1 )[N1], ExcludeNULLLiteralImpl<CharT, N2> const & literal2 ) noexcept { return ( ( literal1 <=> literal2 ) < 0 ); }
 
 ////////////////////
 // Literal
@@ -306,6 +315,12 @@ constexpr bool IsSame( char_cptr const str ) {
   return ( IsSameN( ptr, str, length ) == true ) ? true : false;
 }
 
+// std::string_viewとの比較は、長さも含めた完全一致で判定する。
+template<Literal LITERAL>
+constexpr bool IsSame( std::string_view const str ) {
+  return std::string_view( LITERAL.get(), LITERAL.length() ) == str;
+}
+
 // ポインタ型からStringLiteral型に変換する。
 template<typename CharT, CharT const * Ptr, size_type length = STRING::Length( Ptr )>
 consteval auto ToStringLiteral () {
@@ -1,6 +1,9 @@
+#pragma once
+
 #include "jig.hpp"
 
 #include <string>
+#include <string_view>
 #include <cstring>
 #include <utility>
 #include <type_traits>
@@ -54,6 +57,20 @@ struct OptionsImpl<INDEX, LITERAL_HEAD, LITERAL_TAIL...> : public OptionsImpl<IN
     }
   }
 
+  // std::string_viewを受け取る版は前方一致ではなく完全一致で判定する。
+  // "--count=3"のように値が連結されたオプションを切り出して渡すときに使う。
+  constexpr auto matchIndex( std::string_view const str ) const {
+    if constexpr ( sizeof...( LITERAL_TAIL ) == 0 ) {
+      return ( STRING::IsSame<LITERAL_HEAD>( str ) == true )
+        ? std::pair<bool, index_type>{ true, INDEX }
+        : std::pair<bool, index_type>{ false, INDEX + 1 };
+    } else {
+      return ( STRING::IsSame<LITERAL_HEAD>( str ) == true )
+        ? std::pair<bool, index_type>{ true, INDEX }
+        : OptionsImpl<INDEX + 1, LITERAL_TAIL...>::matchIndex( str );
+    }
+  }
+
   constexpr auto matchIndex( char const * str ) const {
     if constexpr ( sizeof...( LITERAL_TAIL ) == 0 ) {
       return ( STRING::IsSame<LITERAL_HEAD>( str ) == true )
@@ -70,6 +87,23 @@ struct OptionsImpl<INDEX, LITERAL_HEAD, LITERAL_TAIL...> : public OptionsImpl<IN
 template<STRING::Literal ... LITERALS>
 struct OptionList : public OptionsImpl<0, LITERALS...> {};
 
+// 文字列の配列からOptionListを組み立てる。
+//
+// STATIC_CONSTEXPR char const * options[] = { "directory", "help" };
+// STATIC_CONSTEXPR auto option_list = MakeOptionList<options>();
+//
+// 配列の要素ごとにLiteralを並べて書く必要が無くなるので、
+// オプション名の追加が配列への追加だけで済む。
+template<auto const & NAMES, index_type... INDICES>
+inline consteval auto MakeOptionListImpl( std::index_sequence<INDICES...> ) {
+  return OptionList<STRING::Literal<char const *, STRING::Length( NAMES[INDICES] )>( NAMES[INDICES] )...>();
+}
+
+template<auto const & NAMES>
+inline consteval auto MakeOptionList() {
+  return MakeOptionListImpl<NAMES>( std::make_index_sequence<ArraySize( NAMES )>() );
+}
+
 // 上記テンプレートクラスから文字列をコンパイル時に受け取るための即時関数
 template<index_type INDEX, STRING::Literal LITERAL_HEAD, STRING::Literal... LITERAL_TAIL>
 inline consteval decltype( LITERAL_HEAD ) const & GetStringLiteral( OptionsImpl<INDEX, LITERAL_HEAD, LITERAL_TAIL...> const & option ) { return option.literal(); }
@@ -0,0 +1,359 @@
+/****************************************
+ * lfl/Archive.hpp
+ *
+ * --archives: tarとzipのアーカイブを展開せずに、中のメンバーの情報を読む。
+ *
+ * 走査はアーカイブをメモリにマップし、そのバイト列をここに渡す。
+ * tarはヘッダ(512バイトのブロック)を、zipは末尾のセントラルディレクトリを、その場でたどるだけで、
+ * メンバーの中身は読まない(圧縮も解かない)。
+ * メンバーは"archive.tar:member/path"という名前のエントリとして、ふつうのファイルと同じSinkに渡す。
+ *
+ * 扱う形式
+ *   - tar: v7、ustar(prefix)、GNUの長い名前('L')、pax拡張ヘッダ('x'のpathとmtime)。base-256の数値。
+ *   - zip: ZIP64を含む。時刻はNTFS(0x000a)、拡張タイムスタンプ(0x5455)、DOSの時刻の順に使う。
+ *     DOSの時刻にはタイムゾーンが無いので、UTCとみなす。
+ * メンバーの名前は、アーカイブに記録されたバイト列のまま扱う(文字コードは変換しない)。
+ * 壊れたところに来たら、それより後のメンバーは読まない。
+ ****************************************/
+#pragma once
+
+#include "jig.hpp"
+#include "lfl/Entry.hpp"
+#include "lfl/Time.hpp"
+#include "lfl/Value.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+
+namespace lfl {
+
+enum class ArchiveKind : std::uint8_t {
+  // アーカイブとして読まない
+  NONE,
+  TAR,
+  ZIP
+};
+
+// アーカイブの中の一つのメンバー
+struct ArchiveMember {
+  // '/'で区切られたアーカイブの中のパス(ディレクトリの末尾の'/'は取り除く)
+  std::string_view path;
+  // 更新時刻(アーカイブはアクセス時刻や作成時刻を持たないことが多いので、常に更新時刻を使う)
+  Time time;
+  std::uint64_t size;
+  EntryType type;
+};
+
+namespace ARCHIVE {
+
+// アーカイブのパスとメンバーのパスの間に置く文字
+STATIC_CONSTEXPR char SEPARATOR = ':';
+
+STATIC_CONSTEXPR std::size_t TAR_BLOCK = 512;
+
+// 名前の拡張子(大文字と小文字は区別しない)で、アーカイブかどうかを決める。
+// ディレクトリを読んだバッファの名前(UTF-16)のままでも調べられるように、文字の型は問わない。
+template<typename Char>
+constexpr ArchiveKind KindOf( Char const * const name, std::size_t const length ) noexcept {
+  if ( length < 5 ) { return ArchiveKind::NONE; }
+
+  char extension[4] = {};
+  for ( std::size_t index = 0; index < 4; ++index ) {
+    auto const c = name[length - 4 + index];
+    extension[index] = ( static_cast<char32_t>( c ) < 0x80 ) ? static_cast<char>( ( 'A' <= c && c <= 'Z' ) ? c - 'A' + 'a' : c ) : '\0';
+  }
+
+  std::string_view const suffix( extension, 4 );
+  if ( suffix == ".tar" ) { return ArchiveKind::TAR; }
+  if ( suffix == ".zip" ) { return ArchiveKind::ZIP; }
+  return ArchiveKind::NONE;
+}
+
+constexpr ArchiveKind KindOf( std::string_view const name ) noexcept { return KindOf( name.data(), name.size() ); }
+
+// tarの数値の欄。8進数の文字列か、先頭のビットが立っていればbase-256(ビッグエンディアン)。
+// base-256の12バイトは64bitに収まらないことがあるので、収まらなければ最大値にする(大きさも時刻もそれで弾かれる)。
+constexpr std::uint64_t ReadTarNumber( std::string_view const field ) noexcept {
+  std::uint64_t value = 0;
+
+  if ( !field.empty() && ( static_cast<unsigned char>( field.front() ) & 0x80 ) ) {
+    value = static_cast<unsigned char>( field.front() ) & 0x7F;
+    for ( std::size_t index = 1; index < field.size(); ++index ) {
+      if ( ( value >> 56 ) != 0 ) { return static_cast<std::uint64_t>( -1 ); }
+      value = ( value << 8 ) | static_cast<unsigned char>( field[index] );
+    }
+    return value;
+  }
+
+  std::size_t index = 0;
+  while ( index < field.size() && field[index] == ' ' ) { ++index; }
+  for ( ; index < field.size() && '0' <= field[index] && field[index] <= '7'; ++index ) { value = ( value << 3 ) | static_cast<std::uint64_t>( field[index] - '0' ); }
+  return value;
+}
+
+// '\0'で終わる(かもしれない)固定長の欄
+constexpr std::string_view ReadTarString( std::string_view const field ) noexcept { return field.substr( 0, field.find( '\0' ) ); }
+
+// ヘッダの合計(チェックサムの欄は空白とみなす)が、チェックサムの欄と一致するか。
+constexpr bool IsValidTarHeader( std::string_view const header ) noexcept {
+  std::uint64_t sum = 0;
+  for ( std::size_t index = 0; index < TAR_BLOCK; ++index ) { sum += ( 148 <= index && index < 156 ) ? ' ' : static_cast<unsigned char>( header[index] ); }
+  return sum == ReadTarNumber( header.substr( 148, 8 ) );
+}
+
+// ナノ秒の時刻(Time)で表せる秒の上限(小数部を足しても溢れない)
+STATIC_CONSTEXPR Time::rep MAX_ARCHIVE_SECONDS = ( std::numeric_limits<Time::rep>::max() - 999999999 ) / 1000000000;
+
+// paxのmtime("1700000000.123456789"のような10進数の秒)。
+// 値はアーカイブを作った誰かが書いたものなので、Timeに収まらない秒や数字でない値はfalseを返し、そのレコードを使わない。
+// 小数部は9桁(ナノ秒)まで読み、それより下の桁は切り捨てる。
+constexpr bool ParsePaxTime( std::string_view const value, Time & time ) noexcept {
+  std::size_t index = 0;
+  bool const is_negative = !value.empty() && value.front() == '-';
+  if ( is_negative ) { ++index; }
+
+  std::size_t const digits_begin = index;
+  Time::rep seconds = 0, ns = 0;
+  for ( ; index < value.size() && '0' <= value[index] && value[index] <= '9'; ++index ) {
+    Time::rep const digit = value[index] - '0';
+    if ( ( MAX_ARCHIVE_SECONDS - digit ) / 10 < seconds ) { return false; }
+    seconds = seconds * 10 + digit;
+  }
+  if ( index == digits_begin ) { return false; }
+
+  if ( index < value.size() && value[index] == '.' ) {
+    Time::rep scale = 100000000;
+    for ( ++index; index < value.size() && '0' <= value[index] && value[index] <= '9'; ++index, scale /= 10 ) { ns += ( value[index] - '0' ) * scale; }
+  }
+  if ( index != value.size() ) { return false; }
+
+  Time::rep const total = seconds * 1000000000 + ns;
+  time = Time( is_negative ? -total : total );
+  return true;
+}
+
+// tarのメンバーを一つずつfunction(ArchiveMember const &)に渡す。
+// 最後まで(終わりを表す0のブロックか、データの終わりまで)読めればtrueを返す。
+template<typename Function>
+bool ForEachTarMember( std::string_view const data, Function && function ) {
+  std::string path;
+  // 次のメンバーに当てはめる、拡張ヘッダの値
+  std::string_view long_path;
+  Time pax_time;
+  bool has_pax_time = false;
+
+  for ( std::size_t offset = 0; offset < data.size(); ) {
+    if ( data.size() - offset < TAR_BLOCK ) { return false; }
+
+    std::string_view const header = data.substr( offset, TAR_BLOCK );
+    if ( header.find_first_not_of( '\0' ) == std::string_view::npos ) { return true; }
+    if ( !IsValidTarHeader( header ) ) { return false; }
+
+    // 残りより大きな大きさは、ブロックに切り上げる(溢れうる)前に弾く。
+    std::uint64_t const size = ReadTarNumber( header.substr( 124, 12 ) );
+    offset += TAR_BLOCK;
+    if ( data.size() - offset < size ) { return false; }
+    std::uint64_t const blocks = ( size + TAR_BLOCK - 1 ) / TAR_BLOCK;
+    if ( ( data.size() - offset ) / TAR_BLOCK < blocks ) { return false; }
+    std::string_view const contents = data.substr( offset, static_cast<std::size_t>( size ) );
+    offset += static_cast<std::size_t>( blocks * TAR_BLOCK );
+
+    char const type = header[156];
+    switch ( type ) {
+      case 'L':
+        long_path = ReadTarString( contents );
+        continue;
+      case 'x':
+        // "長さ key=value\n"の並び
+        for ( std::string_view records = contents; !records.empty(); ) {
+          std::size_t const space = records.find( ' ' );
+          // 長さは残りのレコードより長くなりえないので、そこを超えたら(溢れる前に)やめる。
+          std::size_t length = 0;
+          for ( std::size_t index = 0; index < space && index < records.size() && length <= records.size(); ++index ) {
+            if ( records[index] < '0' || '9' < records[index] ) {
+              length = 0;
+              break;
+            }
+            length = length * 10 + static_cast<std::size_t>( records[index] - '0' );
+          }
+          if ( space == std::string_view::npos || length <= space + 1 || records.size() < length ) { break; }
+
+          std::string_view const record = records.substr( space + 1, length - space - 2 );
+          std::size_t const equal = record.find( '=' );
+          std::string_view const key = record.substr( 0, equal );
+          std::string_view const value = ( equal == std::string_view::npos ) ? std::string_view() : record.substr( equal + 1 );
+          if ( key == "path" ) { long_path = value; }
+          if ( key == "mtime" && ParsePaxTime( value, pax_time ) ) { has_pax_time = true; }
+
+          records.remove_prefix( length );
+        }
+        continue;
+      case 'g':
+      case 'K':
+        continue;
+      default:
+        break;
+    }
+
+    if ( !long_path.empty() ) {
+      path.assign( long_path );
+    } else {
+      path.clear();
+      // prefixの欄があるのはPOSIXのustarだけ(GNUはそこに別の情報を置く)。
+      if ( header.substr( 257, 6 ) == std::string_view( "ustar\0", 6 ) ) {
+        std::string_view const prefix = ReadTarString( header.substr( 345, 155 ) );
+        if ( !prefix.empty() ) { path.assign( prefix ).append( 1, '/' ); }
+      }
+      path.append( ReadTarString( header.substr( 0, 100 ) ) );
+    }
+    while ( !path.empty() && path.back() == '/' ) { path.pop_back(); }
+
+    EntryType entry_type = EntryType::FILE;
+    if ( type == '5' ) {
+      entry_type = EntryType::DIRECTORY;
+    } else if ( type == '2' ) {
+      entry_type = EntryType::SYMLINK;
+    } else if ( type == '3' || type == '4' || type == '6' ) {
+      entry_type = EntryType::OTHER;
+    }
+
+    // base-256の時刻もTimeに収まらなければ、壊れたヘッダとみなす。
+    std::uint64_t const mtime = has_pax_time ? 0 : ReadTarNumber( header.substr( 136, 12 ) );
+    if ( static_cast<std::uint64_t>( MAX_ARCHIVE_SECONDS ) < mtime ) { return false; }
+    Time const time = has_pax_time ? pax_time : Time( static_cast<Time::rep>( mtime ) * 1000000000 );
+    if ( !path.empty() ) { function( ArchiveMember{ path, time, ( entry_type == EntryType::FILE ) ? size : 0, entry_type } ); }
+
+    long_path = std::string_view();
+    has_pax_time = false;
+  }
+
+  return true;
+}
+
+// リトルエンディアンの整数
+template<typename Integer>
+constexpr Integer ReadLittle( std::string_view const data, std::size_t const offset ) noexcept {
+  Integer value = 0;
+  for ( std::size_t index = sizeof( Integer ); index > 0; --index ) { value = static_cast<Integer>( ( value << 8 ) | static_cast<unsigned char>( data[offset + index - 1] ) ); }
+  return value;
+}
+
+// DOSの日付と時刻(2秒単位)。タイムゾーンが分からないので、UTCとみなす。
+constexpr Time FromDosTime( std::uint16_t const date, std::uint16_t const time ) noexcept {
+  std::int64_t const days = VALUE::DaysFromCivil( 1980 + ( date >> 9 ), ( date >> 5 ) & 0x0F, date & 0x1F );
+  std::int64_t const seconds = days * 86400 + ( time >> 11 ) * 3600 + ( ( time >> 5 ) & 0x3F ) * 60 + ( time & 0x1F ) * 2;
+  return Time( seconds * 1000000000 );
+}
+
+STATIC_CONSTEXPR std::uint32_t ZIP_END_SIGNATURE = 0x06054b50;
+STATIC_CONSTEXPR std::uint32_t ZIP64_LOCATOR_SIGNATURE = 0x07064b50;
+STATIC_CONSTEXPR std::uint32_t ZIP64_END_SIGNATURE = 0x06064b50;
+STATIC_CONSTEXPR std::uint32_t ZIP_CENTRAL_SIGNATURE = 0x02014b50;
+STATIC_CONSTEXPR std::size_t ZIP_END_SIZE = 22;
+STATIC_CONSTEXPR std::size_t ZIP64_LOCATOR_SIZE = 20;
+STATIC_CONSTEXPR std::size_t ZIP64_END_SIZE = 56;
+STATIC_CONSTEXPR std::size_t ZIP_CENTRAL_SIZE = 46;
+// 末尾のコメントの最大の長さ
+STATIC_CONSTEXPR std::size_t ZIP_MAX_COMMENT = 0xFFFF;
+
+// zipのメンバーを一つずつfunction(ArchiveMember const &)に渡す。
+// セントラルディレクトリを最後まで読めればtrueを返す。
+template<typename Function>
+bool ForEachZipMember( std::string_view const data, Function && function ) {
+  if ( data.size() < ZIP_END_SIZE ) { return false; }
+
+  // 終端レコードは末尾のコメントの前にあるので、後ろから探す。
+  std::size_t end = data.size() - ZIP_END_SIZE;
+  std::size_t const lowest = ( end > ZIP_MAX_COMMENT ) ? end - ZIP_MAX_COMMENT : 0;
+  while ( ReadLittle<std::uint32_t>( data, end ) != ZIP_END_SIGNATURE || end + ZIP_END_SIZE + ReadLittle<std::uint16_t>( data, end + 20 ) > data.size() ) {
+    if ( end == lowest ) { return false; }
+    --end;
+  }
+
+  std::uint64_t count = ReadLittle<std::uint16_t>( data, end + 10 );
+  std::uint64_t offset = ReadLittle<std::uint32_t>( data, end + 16 );
+
+  // ZIP64では、欄に収まらない値は直前のロケーターが指すZIP64の終端レコードにある。
+  if ( ( count == 0xFFFF || offset == 0xFFFFFFFF ) && end >= ZIP64_LOCATOR_SIZE && ReadLittle<std::uint32_t>( data, end - ZIP64_LOCATOR_SIZE ) == ZIP64_LOCATOR_SIGNATURE ) {
+    std::uint64_t const end64 = ReadLittle<std::uint64_t>( data, end - ZIP64_LOCATOR_SIZE + 8 );
+    if ( data.size() < ZIP64_END_SIZE || data.size() - ZIP64_END_SIZE < end64 || ReadLittle<std::uint32_t>( data, static_cast<std::size_t>( end64 ) ) != ZIP64_END_SIGNATURE ) { return false; }
+
+    count = ReadLittle<std::uint64_t>( data, static_cast<std::size_t>( end64 ) + 32 );
+    offset = ReadLittle<std::uint64_t>( data, static_cast<std::size_t>( end64 ) + 48 );
+  }
+
+  for ( ; count > 0; --count ) {
+    if ( data.size() < ZIP_CENTRAL_SIZE || data.size() - ZIP_CENTRAL_SIZE < offset ) { return false; }
+
+    std::size_t const header = static_cast<std::size_t>( offset );
+    if ( ReadLittle<std::uint32_t>( data, header ) != ZIP_CENTRAL_SIGNATURE ) { return false; }
+
+    std::size_t const name_length = ReadLittle<std::uint16_t>( data, header + 28 );
+    std::size_t const extra_length = ReadLittle<std::uint16_t>( data, header + 30 );
+    std::size_t const comment_length = ReadLittle<std::uint16_t>( data, header + 32 );
+    if ( data.size() - header - ZIP_CENTRAL_SIZE < name_length + extra_length ) { return false; }
+
+    std::string_view path = data.substr( header + ZIP_CENTRAL_SIZE, name_length );
+    std::string_view const extra = data.substr( header + ZIP_CENTRAL_SIZE + name_length, extra_length );
+
+    std::uint64_t size = ReadLittle<std::uint32_t>( data, header + 24 );
+    Time time = FromDosTime( ReadLittle<std::uint16_t>( data, header + 14 ), ReadLittle<std::uint16_t>( data, header + 12 ) );
+    bool has_ntfs_time = false;
+
+    // 拡張フィールドは"ID(2) 長さ(2) 値"の並び
+    for ( std::size_t field = 0; field + 4 <= extra.size(); ) {
+      std::uint16_t const id = ReadLittle<std::uint16_t>( extra, field );
+      std::size_t const length = ReadLittle<std::uint16_t>( extra, field + 2 );
+      if ( extra.size() - field - 4 < length ) { break; }
+      std::string_view const value = extra.substr( field + 4, length );
+
+      if ( id == 0x0001 && size == 0xFFFFFFFF && length >= 8 ) {
+        // ZIP64: 元の大きさは、欄が0xFFFFFFFFのときだけ先頭にある。
+        size = ReadLittle<std::uint64_t>( value, 0 );
+      } else if ( id == 0x000a && length >= 32 && ReadLittle<std::uint16_t>( value, 4 ) == 0x0001 && ReadLittle<std::uint16_t>( value, 6 ) >= 24 ) {
+        // NTFS: 予約(4)の後の属性1が、更新・アクセス・作成のFILETIME
+        time = Time::FromFileTime( ReadLittle<std::uint64_t>( value, 8 ) );
+        has_ntfs_time = true;
+      } else if ( id == 0x5455 && length >= 5 && ( value[0] & 0x01 ) && !has_ntfs_time ) {
+        // 拡張タイムスタンプ: フラグ(1)の後に、UNIXエポックからの秒の更新時刻
+        time = Time( static_cast<Time::rep>( static_cast<std::int32_t>( ReadLittle<std::uint32_t>( value, 1 ) ) ) * 1000000000 );
+      }
+
+      field += 4 + length;
+    }
+
+    // UNIXで作られたもの(上位バイトが3)は、外部属性の上位16bitがst_mode。
+    std::uint32_t const mode = ReadLittle<std::uint32_t>( data, header + 38 ) >> 16;
+    bool const is_unix = ( ReadLittle<std::uint16_t>( data, header + 4 ) >> 8 ) == 3;
+
+    EntryType type = EntryType::FILE;
+    if ( !path.empty() && path.back() == '/' ) {
+      type = EntryType::DIRECTORY;
+      while ( !path.empty() && path.back() == '/' ) { path.remove_suffix( 1 ); }
+    } else if ( is_unix && ( mode & 0170000 ) == 0120000 ) {
+      type = EntryType::SYMLINK;
+    }
+
+    if ( !path.empty() ) { function( ArchiveMember{ path, time, ( type == EntryType::FILE ) ? size : 0, type } ); }
+
+    offset += ZIP_CENTRAL_SIZE + name_length + extra_length + comment_length;
+  }
+
+  return true;
+}
+
+template<typename Function>
+bool ForEachMember( ArchiveKind const kind, std::string_view const data, Function && function ) {
+  switch ( kind ) {
+    case ArchiveKind::TAR: return ForEachTarMember( data, function );
+    case ArchiveKind::ZIP: return ForEachZipMember( data, function );
+    default: return false;
+  }
+}
+
+} // ARCHIVE
+
+} // lfl
@@ -0,0 +1,186 @@
+/****************************************
+ * lfl/Cache.hpp
+ *
+ * --cache TTL: 同じ問い合わせの結果を、プロセスをまたいで共有メモリに保存しておく。
+ *
+ * 端末ごとやCIの手順ごとに起動された複数のlflが、数秒のうちに同じディレクトリについて
+ * 同じことを問い合わせることがある。結果(標準出力に書いた内容そのもの)を、
+ * (正規化した起点, 引数)のハッシュをキーにして保存し、TTLの間は走査せずにそれを出力する。
+ * 保存するときの起点のディレクトリの更新時刻も覚えておき、一つでも変わっていたら使わない。
+ * (起点の更新時刻が変わるのは直下のエントリが増減したときだけなので、深いところの変化はTTLで抑える。)
+ *
+ * 共有メモリは名前付きのファイルマッピング(ページファイルの領域)で、SLOT_NUM個のスロットを持つ。
+ * キーで決まる一つのスロットだけを使う(衝突したら後から保存したものが勝つ)。
+ * 各スロットはseqlockで守る。書き込み中はsequenceが奇数になり、読み手はコピーの前後で
+ * sequenceが変わっていないことを確かめるだけで、ロックは取らない。
+ * 書き手どうしはsequenceの比較交換で排他し、他の書き手が書き込み中なら保存をあきらめる。
+ * 共有メモリの中身には、すべてstd::atomic_refを通して触る(プロセス間のデータ競合を避ける)。
+ *
+ * 起点の更新時刻は、起点がディレクトリかどうかを確かめる問い合わせ(起点ごとに一度のGetFileAttributesEx)で一緒に得る。
+ * 共有メモリを開く処理と、起点の正規化・更新時刻の問い合わせ(Windows API)はsrc/Cache.cppにある。
+ ****************************************/
+#pragma once
+
+#include "jig.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace lfl {
+
+namespace CACHE {
+
+STATIC_CONSTEXPR std::size_t SLOT_NUM = 16;
+// 一つのスロットに保存できる出力の大きさ。これより大きな出力は保存しない。
+STATIC_CONSTEXPR std::size_t SLOT_CAPACITY = ( std::size_t( 64 ) << 10 ) - 64;
+STATIC_CONSTEXPR std::size_t SLOT_WORDS = SLOT_CAPACITY / sizeof( std::uint64_t );
+// 書き込み中のスロットを読み直す回数。書き込みは一瞬で終わるので、数回で足りる。
+STATIC_CONSTEXPR int READ_RETRY_NUM = 8;
+
+// 共有メモリの中身。新しく作られた領域は0で埋まっているので、初期化は要らない(sizeが0なら空)。
+// 配置を変えたら、src/Cache.cppの共有メモリの名前の版も変えること。
+struct Slot {
+  std::uint64_t sequence;
+  std::uint64_t key;
+  // 起点のディレクトリの更新時刻をまとめたハッシュ
+  std::uint64_t stamp;
+  // 保存した時刻(1970-01-01からのns)
+  std::uint64_t stored_at;
+  std::uint64_t size;
+  std::uint64_t data[SLOT_WORDS];
+};
+
+struct Segment {
+  Slot slots[SLOT_NUM];
+};
+
+// FNV-1a(64bit)。キーと更新時刻のハッシュに使う。
+class Hasher {
+public:
+  constexpr Hasher & add( std::string_view const text ) noexcept {
+    for ( auto const itr : text ) {
+      value_ ^= static_cast<unsigned char>( itr );
+      value_ *= PRIME;
+    }
+    // "ab","c"と"a","bc"を区別するため、区切りも混ぜる。
+    value_ ^= 0xff;
+    value_ *= PRIME;
+    return *this;
+  }
+
+  constexpr Hasher & add( std::uint64_t number ) noexcept {
+    for ( int index = 0; index < 8; ++index, number >>= 8 ) {
+      value_ ^= ( number & 0xff );
+      value_ *= PRIME;
+    }
+    return *this;
+  }
+
+  constexpr std::uint64_t value() const noexcept { return value_; }
+private:
+  static constexpr std::uint64_t PRIME = 1099511628211ULL;
+  std::uint64_t value_ = 14695981039346656037ULL;
+};
+
+inline Slot & SlotOf( Segment & segment, std::uint64_t const key ) noexcept { return segment.slots[key % SLOT_NUM]; }
+
+inline std::uint64_t LoadRelaxed( std::uint64_t & word ) noexcept { return std::atomic_ref<std::uint64_t>( word ).load( std::memory_order_relaxed ); }
+inline void StoreRelaxed( std::uint64_t & word, std::uint64_t const value ) noexcept { std::atomic_ref<std::uint64_t>( word ).store( value, std::memory_order_relaxed ); }
+
+// キーと更新時刻が一致し、保存からttl_nsが経っていなければ、保存された出力をresultに入れてtrueを返す。
+inline bool Load( Segment & segment, std::uint64_t const key, std::uint64_t const stamp, std::uint64_t const now, std::uint64_t const ttl_ns, std::string & result ) {
+  Slot & slot = SlotOf( segment, key );
+  std::atomic_ref<std::uint64_t> sequence( slot.sequence );
+
+  for ( int retry = 0; retry < READ_RETRY_NUM; ++retry ) {
+    std::uint64_t const before = sequence.load( std::memory_order_acquire );
+    if ( before & 1 ) { continue; }
+
+    std::uint64_t const size = LoadRelaxed( slot.size );
+    std::uint64_t const stored_at = LoadRelaxed( slot.stored_at );
+    bool const is_match = ( size != 0 ) && ( size <= SLOT_CAPACITY ) && ( LoadRelaxed( slot.key ) == key ) && ( LoadRelaxed( slot.stamp ) == stamp )
+                       && ( stored_at <= now ) && ( now - stored_at < ttl_ns );
+
+    if ( is_match ) {
+      result.resize( static_cast<std::size_t>( size ) );
+      for ( std::size_t offset = 0; offset < size; offset += sizeof( std::uint64_t ) ) {
+        std::uint64_t const word = LoadRelaxed( slot.data[offset / sizeof( std::uint64_t )] );
+        std::memcpy( result.data() + offset, &word, std::min<std::size_t>( sizeof( word ), size - offset ) );
+      }
+    }
+
+    // コピーの間に書き手が入っていなければ、読んだ内容は一貫している。
+    std::atomic_thread_fence( std::memory_order_acquire );
+    if ( sequence.load( std::memory_order_relaxed ) == before ) { return is_match; }
+  }
+
+  return false;
+}
+
+// 出力dataを保存する。大きすぎるときと、他の書き手が書き込み中のときは保存せずにfalseを返す。
+inline bool Store( Segment & segment, std::uint64_t const key, std::uint64_t const stamp, std::uint64_t const now, std::string_view const data ) noexcept {
+  if ( data.empty() || SLOT_CAPACITY < data.size() ) { return false; }
+
+  Slot & slot = SlotOf( segment, key );
+  std::atomic_ref<std::uint64_t> sequence( slot.sequence );
+
+  std::uint64_t before = sequence.load( std::memory_order_relaxed );
+  if ( ( before & 1 ) || !sequence.compare_exchange_strong( before, before + 1, std::memory_order_acquire, std::memory_order_relaxed ) ) { return false; }
+  // 奇数にしたことが、以降の書き込みより先に見えるようにする。
+  std::atomic_thread_fence( std::memory_order_release );
+
+  StoreRelaxed( slot.key, key );
+  StoreRelaxed( slot.stamp, stamp );
+  StoreRelaxed( slot.stored_at, now );
+  StoreRelaxed( slot.size, data.size() );
+  for ( std::size_t offset = 0; offset < data.size(); offset += sizeof( std::uint64_t ) ) {
+    std::uint64_t word = 0;
+    std::memcpy( &word, data.data() + offset, std::min<std::size_t>( sizeof( word ), data.size() - offset ) );
+    StoreRelaxed( slot.data[offset / sizeof( std::uint64_t )], word );
+  }
+
+  sequence.store( before + 2, std::memory_order_release );
+  return true;
+}
+
+// 保存と照合に使う現在時刻(プロセスをまたいで比べられるように、1970-01-01からのns)
+inline std::uint64_t Now() noexcept {
+  return static_cast<std::uint64_t>( std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::system_clock::now().time_since_epoch() ).count() );
+}
+
+// 共有メモリの領域。開けなかったときはget()がnullptrを返す(キャッシュを使わずに走査する)。
+class SharedSegment {
+public:
+  SharedSegment() = default;
+  ~SharedSegment();
+
+  SharedSegment( SharedSegment const & ) = delete;
+  SharedSegment & operator=( SharedSegment const & ) = delete;
+
+  bool open();
+  Segment * get() const noexcept { return segment_; }
+private:
+  void * mapping_ = nullptr;
+  Segment * segment_ = nullptr;
+};
+
+// 起点(区切り文字で終わるディレクトリのパス)と引数からキーを作る。
+// 起点は絶対パスにして大文字と小文字をそろえる(カレントディレクトリが違えば".\\"は別のディレクトリ)。
+// 引数はそのまま混ぜるので、出力に現れる起点の書き方の違いも区別される。
+std::uint64_t MakeKey( std::vector<std::string> const & roots, int argc, char const * const argv[] );
+
+// pathがディレクトリなら、その更新時刻をstampに混ぜてtrueを返す(ディレクトリでなければfalse)。
+// 起点がディレクトリかどうかを確かめるのと同じ一度の問い合わせで済ませるので、
+// 起点を確かめるときにこれを呼べば、stampは起点の更新時刻をまとめたハッシュになる。
+bool StampDirectory( std::string const & path, Hasher & stamp );
+
+} // CACHE
+
+} // lfl
@@ -0,0 +1,214 @@
+/****************************************
+ * lfl/Checkpoint.hpp
+ *
+ * --checkpoint FILE、--resume FILE: 長い走査の途中の状態を保存し、そこから続ける。
+ *
+ * 走査は一定の間隔(INTERVAL)で、新しいディレクトリを取り出させずに、
+ * 読み込み中のディレクトリがすべて読み終わるのを待って止まる(lfl/Scanner.hppのCheckpointHooks)。
+ * そのときの「上位count件」と「読み込み待ちのディレクトリ」は食い違いが無く、
+ * 読み込み待ちのディレクトリの下だけを読めば、残りの結果が得られる。
+ * それまでに読めなかったディレクトリも保存して、続けたときの結果に含める。
+ * 止めている間は状態をメモリに写すだけにして、符号化とファイルへの書き込みは走査を再開してから行う。
+ * 止めている間は、ほかのスレッドは読み込み中のディレクトリを手伝うことしかできないので、
+ * MAX_PAUSEまでに読み終わらなければ、その回は保存せずに走査を続ける。
+ *
+ * ファイルは一時ファイルに書いてから名前を変えて置き換える(書きかけのファイルが残らない)。
+ * 形式(整数は可変長の符号なしLEB128、符号付きはzigzag):
+ *   MAGIC
+ *   起点の数, (長さ, バイト列)...
+ *   エントリの数, (時刻, 大きさ, 種類, 名前の位置, パスの長さ, パス)...
+ *   ディレクトリの数, (前のパスと共通の長さ, 残りの長さ, 残り, 起点の長さ, 深さ, ボリューム, 更新時刻, 起点の番号)...
+ *   読めなかったディレクトリの数, (長さ, バイト列)...
+ * 読み込み待ちのディレクトリは兄弟が並ぶので、前のパスとの共通部分を省けば、親のパスはほとんど書かずに済む。
+ * ファイルの書き込み(Windows API)はsrc/Checkpoint.cppにある。
+ ****************************************/
+#pragma once
+
+#include "jig.hpp"
+#include "lfl/Entry.hpp"
+#include "lfl/Frontier.hpp"
+#include "lfl/Time.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace lfl {
+
+namespace CHECKPOINT {
+
+STATIC_CONSTEXPR char MAGIC[8] = { 'L', 'F', 'L', 'C', 'K', 'P', 'T', '2' };
+// 保存する間隔。止めている時間は短いが、書き込むファイルは読み込み待ちのディレクトリの数に比例して大きくなる。
+STATIC_CONSTEXPR std::chrono::seconds INTERVAL{ 30 };
+// 読み込み中のディレクトリが読み終わるのを待つ時間の上限(lfl/Scanner.hppのCheckpointHooks::max_pause)
+STATIC_CONSTEXPR std::chrono::seconds MAX_PAUSE{ 1 };
+
+struct State {
+  // 区切り文字で終わる起点のパス(続けるときに、同じ起点であることを確かめる)
+  std::vector<std::string> roots;
+  // それまでに見つかった上位count件
+  std::vector<Entry> entries;
+  // 読み込み待ちのディレクトリ
+  std::vector<DirectoryJob> frontier;
+  // それまでに読めなかったディレクトリ
+  std::vector<std::string> errors;
+};
+
+inline void WriteNumber( std::string & out, std::uint64_t value ) {
+  for ( ; value >= 0x80; value >>= 7 ) { out.push_back( static_cast<char>( ( value & 0x7f ) | 0x80 ) ); }
+  out.push_back( static_cast<char>( value ) );
+}
+
+inline void WriteSigned( std::string & out, std::int64_t const value ) {
+  WriteNumber( out, ( static_cast<std::uint64_t>( value ) << 1 ) ^ static_cast<std::uint64_t>( value >> 63 ) );
+}
+
+inline void WriteString( std::string & out, std::string_view const str ) {
+  WriteNumber( out, str.size() );
+  out.append( str );
+}
+
+// dataの先頭から読み進める。足りなければfalseを返す。
+inline bool ReadNumber( std::string_view & data, std::uint64_t & value ) {
+  value = 0;
+  for ( unsigned shift = 0; shift < 64; shift += 7 ) {
+    if ( data.empty() ) { return false; }
+
+    unsigned char const byte = static_cast<unsigned char>( data.front() );
+    data.remove_prefix( 1 );
+    value |= static_cast<std::uint64_t>( byte & 0x7f ) << shift;
+    if ( !( byte & 0x80 ) ) { return true; }
+  }
+  return false;
+}
+
+inline bool ReadSigned( std::string_view & data, std::int64_t & value ) {
+  std::uint64_t encoded = 0;
+  if ( !ReadNumber( data, encoded ) ) { return false; }
+
+  value = static_cast<std::int64_t>( ( encoded >> 1 ) ^ ( ~( encoded & 1 ) + 1 ) );
+  return true;
+}
+
+inline bool ReadBytes( std::string_view & data, std::uint64_t const length, std::string_view & bytes ) {
+  if ( data.size() < length ) { return false; }
+
+  bytes = data.substr( 0, static_cast<std::size_t>( length ) );
+  data.remove_prefix( static_cast<std::size_t>( length ) );
+  return true;
+}
+
+template<typename Integer>
+bool ReadInteger( std::string_view & data, Integer & value ) {
+  std::uint64_t number = 0;
+  if ( !ReadNumber( data, number ) ) { return false; }
+
+  value = static_cast<Integer>( number );
+  return true;
+}
+
+inline void Encode( State const & state, std::string & out ) {
+  out.assign( MAGIC, sizeof( MAGIC ) );
+
+  WriteNumber( out, state.roots.size() );
+  for ( auto const & itr : state.roots ) { WriteString( out, itr ); }
+
+  WriteNumber( out, state.entries.size() );
+  for ( auto const & itr : state.entries ) {
+    WriteSigned( out, itr.time.ns() );
+    WriteNumber( out, itr.size );
+    WriteNumber( out, static_cast<std::uint64_t>( itr.type ) );
+    WriteNumber( out, itr.name_offset );
+    WriteString( out, itr.path );
+  }
+
+  WriteNumber( out, state.frontier.size() );
+  std::string_view previous;
+  for ( auto const & itr : state.frontier ) {
+    std::string_view const path( itr.path );
+    std::size_t const common = std::mismatch( previous.begin(), previous.begin() + std::min( previous.size(), path.size() ), path.begin() ).first - previous.begin();
+
+    WriteNumber( out, common );
+    WriteString( out, path.substr( common ) );
+    WriteNumber( out, itr.root_length );
+    WriteNumber( out, itr.depth );
+    WriteNumber( out, itr.volume );
+    WriteSigned( out, itr.priority.ns() );
+    WriteNumber( out, itr.root );
+
+    previous = path;
+  }
+
+  WriteNumber( out, state.errors.size() );
+  for ( auto const & itr : state.errors ) { WriteString( out, itr ); }
+}
+
+// 形式が壊れていたらfalseを返す。
+inline bool Decode( std::string_view data, State & state ) {
+  if ( data.size() < sizeof( MAGIC ) || std::memcmp( data.data(), MAGIC, sizeof( MAGIC ) ) != 0 ) { return false; }
+  data.remove_prefix( sizeof( MAGIC ) );
+
+  std::uint64_t size = 0, length = 0;
+  std::string_view bytes;
+
+  state.roots.clear();
+  if ( !ReadNumber( data, size ) || data.size() < size ) { return false; }
+  for ( std::uint64_t index = 0; index < size; ++index ) {
+    if ( !ReadNumber( data, length ) || !ReadBytes( data, length, bytes ) ) { return false; }
+    state.roots.emplace_back( bytes );
+  }
+
+  state.entries.clear();
+  if ( !ReadNumber( data, size ) || data.size() < size ) { return false; }
+  for ( std::uint64_t index = 0; index < size; ++index ) {
+    Entry & entry = state.entries.emplace_back();
+    std::int64_t time = 0;
+    std::uint64_t type = 0;
+    if ( !ReadSigned( data, time ) || !ReadNumber( data, entry.size ) || !ReadNumber( data, type ) || !ReadInteger( data, entry.name_offset ) ) { return false; }
+    if ( !ReadNumber( data, length ) || !ReadBytes( data, length, bytes ) ) { return false; }
+    if ( static_cast<std::uint64_t>( EntryType::NUM ) <= type || bytes.size() < entry.name_offset ) { return false; }
+
+    entry.time = Time( time );
+    entry.type = static_cast<EntryType>( type );
+    entry.path.assign( bytes );
+  }
+
+  state.frontier.clear();
+  if ( !ReadNumber( data, size ) || data.size() < size ) { return false; }
+  std::string previous;
+  for ( std::uint64_t index = 0; index < size; ++index ) {
+    std::uint64_t common = 0;
+    std::int64_t priority = 0;
+    if ( !ReadNumber( data, common ) || previous.size() < common || !ReadNumber( data, length ) || !ReadBytes( data, length, bytes ) ) { return false; }
+
+    DirectoryJob & job = state.frontier.emplace_back();
+    job.path.assign( previous, 0, static_cast<std::size_t>( common ) ).append( bytes );
+    if ( !ReadInteger( data, job.root_length ) || !ReadInteger( data, job.depth ) || !ReadNumber( data, job.volume ) || !ReadSigned( data, priority ) || !ReadInteger( data, job.root ) ) { return false; }
+    if ( job.path.size() < job.root_length || state.roots.size() <= job.root ) { return false; }
+
+    job.priority = Time( priority );
+    previous = job.path;
+  }
+
+  state.errors.clear();
+  if ( !ReadNumber( data, size ) || data.size() < size ) { return false; }
+  for ( std::uint64_t index = 0; index < size; ++index ) {
+    if ( !ReadNumber( data, length ) || !ReadBytes( data, length, bytes ) ) { return false; }
+    state.errors.emplace_back( bytes );
+  }
+
+  return data.empty();
+}
+
+// dataをpathのファイルに書く。一時ファイルに書き終えてから置き換えるので、
+// 途中で止められても、前に保存したファイルか新しいファイルのどちらかが残る。
+bool WriteAtomically( std::string const & path, std::string_view data );
+
+} // CHECKPOINT
+
+} // lfl
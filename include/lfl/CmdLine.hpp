@@ -0,0 +1,627 @@
+/****************************************
+ * lfl/CmdLine.hpp
+ *
+ * コマンドライン引数の解析。
+ * argvの文字列はプロセスが終了するまで生きているので、
+ * 解析中はコピーせずにstd::string_viewで参照するだけにとどめる。
+ ****************************************/
+#pragma once
+
+#include "jig.hpp"
+#include "jig/option.hpp"
+#include "lfl/Filter.hpp"
+#include "lfl/Format.hpp"
+#include "lfl/Group.hpp"
+#include "lfl/Shard.hpp"
+#include "lfl/Value.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace lfl {
+
+STATIC_CONSTEXPR char OPTION_SPECIFIER[] = "--";
+STATIC_CONSTEXPR int SPECIFIER_LENGTH = jig::ArraySize( OPTION_SPECIFIER ); // add the NULL character in the string tail.
+STATIC_CONSTEXPR int NULL_EXCLUDE_OS_LENGTH = SPECIFIER_LENGTH - 1;
+STATIC_CONSTEXPR char VALUE_SEPARATOR = '=';
+
+// OPTION_NAMESとOPTION_IS_BINOMIALの並びは、この列挙型の並びと一致させること。
+enum class OptionKey : jig::index_type {
+  HELP,
+  VERSION,
+  DIRECTORY,
+  COUNT,
+  TIME,
+  NULL_DATA,
+  JSON,
+  BINARY,
+  SORT,
+  RECURSIVE,
+  THREADS,
+  FOLLOW,
+  UNIQUE_INODES,
+  XDEV,
+  MAX_DEPTH,
+  ORDER,
+  DIRBUF,
+  DEADLINE,
+  MAX_OPEN,
+  MAX_FRONTIER,
+  SHARD,
+  SPLIT_DEPTH,
+  FROM_STDIN,
+  NAME,
+  MIN_SIZE,
+  MAX_SIZE,
+  TYPE,
+  MTIME_RANGE,
+  EXCLUDE,
+  EXCLUDE_FROM,
+  GITIGNORE,
+  GROUP_BY,
+  TREE,
+  PER_ROOT,
+  ARCHIVES,
+  CACHE,
+  MAX_IOPS,
+  MAX_DIRS_PER_SEC,
+  CHECKPOINT,
+  RESUME,
+  NUM
+};
+
+STATIC_CONSTEXPR char const * OPTION_NAMES[] = { "help", "version", "directory", "count", "time", "null", "json", "binary", "sort", "recursive", "threads", "follow", "unique-inodes", "xdev", "max-depth", "order", "dirbuf", "deadline", "max-open", "max-frontier", "shard", "split-depth", "from-stdin", "name", "min-size", "max-size", "type", "mtime-range", "exclude", "exclude-from", "gitignore", "group-by", "tree", "per-root", "archives", "cache", "max-iops", "max-dirs-per-sec", "checkpoint", "resume" };
+// 値を一つ取るオプション(二項オプション)かどうか
+STATIC_CONSTEXPR bool OPTION_IS_BINOMIAL[] = { false, false, true, true, true, false, false, false, false, false, true, false, false, false, true, true, true, true, true, true, true, true, false, true, true, true, true, true, true, true, false, true, false, false, false, true, true, true, true, true };
+
+static_assert( jig::ArraySize( OPTION_NAMES ) == static_cast<jig::size_type>( OptionKey::NUM ), "OPTION_NAMES and OptionKey are mismatched" );
+static_assert( jig::ArraySize( OPTION_IS_BINOMIAL ) == static_cast<jig::size_type>( OptionKey::NUM ), "OPTION_IS_BINOMIAL and OptionKey are mismatched" );
+
+STATIC_CONSTEXPR auto option_list = jig::OPTION::MakeOptionList<OPTION_NAMES>();
+
+constexpr std::string_view OptionName( OptionKey const key ) noexcept { return OPTION_NAMES[static_cast<jig::index_type>( key )]; }
+
+// "-0"のような一文字の別名
+struct ShortOption {
+  char name;
+  OptionKey key;
+};
+
+STATIC_CONSTEXPR char SHORT_OPTION_SPECIFIER = '-';
+STATIC_CONSTEXPR ShortOption SHORT_OPTIONS[] = {
+  { '0', OptionKey::NULL_DATA },
+  { 'r', OptionKey::RECURSIVE },
+  { 'L', OptionKey::FOLLOW },
+};
+
+// 一文字の別名を正式な名前に置き換える。別名でなければ空を返す。
+// 別名ではない"-x"は、これまでどおりディレクトリの名前として扱う。
+constexpr std::string_view ExpandShortOption( std::string_view const arg ) noexcept {
+  if ( !( arg.size() == 2 && arg[0] == SHORT_OPTION_SPECIFIER && arg[1] != SHORT_OPTION_SPECIFIER ) ) { return std::string_view(); }
+
+  for ( auto const & itr : SHORT_OPTIONS ) {
+    if ( itr.name == arg[1] ) { return OptionName( itr.key ); }
+  }
+
+  return std::string_view();
+}
+
+// 最初の引数がこれなら、走査せずに--binaryの部分結果をまとめる(lfl merge)。
+// "merge"という名前のディレクトリは、"lfl -- merge"か"lfl .\merge"と書けば走査する。
+STATIC_CONSTEXPR char MERGE_COMMAND[] = "merge";
+
+constexpr bool IsMergeCommand( int const arg_count, char const * const arg_chars[] ) noexcept {
+  return ( arg_count > 1 ) && ( std::string_view( arg_chars[1] ) == MERGE_COMMAND );
+}
+
+class CmdArg {
+public:
+  constexpr explicit CmdArg( std::string_view const, bool const );
+  constexpr CmdArg( CmdArg const & ) = default;
+  constexpr CmdArg & operator=( CmdArg const & ) = default;
+  constexpr CmdArg( CmdArg && ) noexcept = default;
+  constexpr CmdArg & operator=( CmdArg && ) noexcept = default;
+  constexpr ~CmdArg() = default;
+
+  constexpr inline std::string_view str() const noexcept { return arg_; }
+  // "--count=3"のように'='で連結された値
+  constexpr inline std::string_view value() const noexcept { return value_; }
+  constexpr inline bool hasValue() const noexcept { return has_value_; }
+  constexpr inline bool isOption() const noexcept { return is_option_; }
+  constexpr inline bool isBinomial() const noexcept { return is_binomial_; }
+private:
+  std::string_view arg_;
+  std::string_view value_;
+  bool is_option_;
+  bool is_binomial_;
+  bool has_value_;
+};
+
+constexpr CmdArg::CmdArg( std::string_view const arg, bool const has_option_specifier )
+: arg_( arg ), value_(), is_option_( false ), is_binomial_( false ), has_value_( false ) {
+  if ( !has_option_specifier ) { return; }
+
+  if ( auto const separator = arg.find( VALUE_SEPARATOR ); separator != std::string_view::npos ) {
+    arg_ = arg.substr( 0, separator );
+    value_ = arg.substr( separator + 1 );
+    has_value_ = true;
+  }
+
+  auto [ is_option, option_index ] = option_list.matchIndex( arg_ );
+  if ( !is_option ) { throw std::invalid_argument( std::string( "unknown option: --" ).append( arg_ ) ); }
+
+  is_option_ = true;
+  is_binomial_ = OPTION_IS_BINOMIAL[option_index];
+
+  if ( has_value_ && !is_binomial_ ) {
+    throw std::invalid_argument( std::string( "--" ).append( arg_ ).append( " does not take a value" ) );
+  }
+}
+
+class CmdParse {
+public:
+  using value_type = CmdArg;
+  using container_type = std::vector<value_type>;
+  using result_type = std::pair<std::string_view, std::string_view>;
+
+  constexpr CmdParse( int const, char const *[] );
+  constexpr CmdParse( CmdParse const & ) = default;
+  constexpr CmdParse & operator=( CmdParse const & rhs ) = default;
+  constexpr CmdParse( CmdParse && ) = default;
+  constexpr CmdParse & operator=( CmdParse && ) = default;
+  constexpr ~CmdParse() = default;
+
+  constexpr result_type get() const;
+
+  constexpr inline bool isThereHelp() const noexcept { return ( first_help_index_ != -1 ); }
+  constexpr inline bool next() noexcept {
+    CmdArg const & current = arg_list_[index_];
+    index_ += ( current.isBinomial() && !current.hasValue() ) ? 2 : 1;
+    return ( index_ >= arg_list_.size() );
+  }
+private:
+  std::size_t index_;
+  container_type arg_list_;
+  std::ptrdiff_t first_help_index_;
+};
+
+// 何個目が二項オプションか、単項オプションか、あるいは、それはオプションかどうか
+// といったような、指定されたオプションの構造を調べる。
+constexpr CmdParse::CmdParse( int const arg_count, char const * arg_chars[] )
+:index_( 0 ), first_help_index_( -1 ) {
+  arg_list_.reserve( arg_count );
+
+  // "--"単体が現れたら、それ以降はすべてオプションではなくディレクトリとして扱う。
+  bool is_options_end = false;
+  // 直前が'='で値を連結していない二項オプションなら、この引数はその値になる。
+  bool is_value = false;
+
+  // オプションの構造解析フェーズ
+  for ( int arg_index = 1; arg_index < arg_count; ++arg_index ) {
+    std::string_view const arg( arg_chars[arg_index] );
+
+    if ( is_value ) {
+      // "--count -r"のように値を書き忘れたのか、'-'で始まる値なのかは区別できないので、
+      // '-'で始まる値は"--name=-x"のように連結して書かせる。
+      if ( arg.starts_with( SHORT_OPTION_SPECIFIER ) ) {
+        std::string_view const option = arg_list_.back().str();
+        throw std::invalid_argument( std::string( "--" ).append( option ).append( " requires a value (write --" ).append( option ).append( 1, VALUE_SEPARATOR ).append( arg ).append( " for a value beginning with '-')" ) );
+      }
+
+      arg_list_.emplace_back( arg, false );
+      is_value = false;
+      continue;
+    }
+
+    if ( !is_options_end && arg == OPTION_SPECIFIER ) {
+      is_options_end = true;
+      continue;
+    }
+
+    if ( !is_options_end && arg.starts_with( OPTION_SPECIFIER ) ) {
+      arg_list_.emplace_back( arg.substr( NULL_EXCLUDE_OS_LENGTH ), true );
+    } else if ( std::string_view const expanded = ( is_options_end ? std::string_view() : ExpandShortOption( arg ) ); !expanded.empty() ) {
+      arg_list_.emplace_back( expanded, true );
+    } else {
+      arg_list_.emplace_back( arg, false );
+    }
+
+    is_value = arg_list_.back().isBinomial() && !arg_list_.back().hasValue();
+  }
+
+  // --helpがコマンドライン引数に含まれているかどうかを調べる。
+  auto it = std::find_if( arg_list_.begin(), arg_list_.end(), []( CmdArg const & arg ){ return arg.isOption() && arg.str() == OptionName( OptionKey::HELP ); } );
+  if ( !( it == arg_list_.end() ) ) { first_help_index_ = std::distance( arg_list_.begin(), it ); }
+}
+
+constexpr CmdParse::result_type CmdParse::get() const {
+  if ( index_ >= arg_list_.size() ) { return result_type( "", "" ); }
+
+  CmdArg const & current = arg_list_[index_];
+
+  // return in help mode
+  if ( first_help_index_ != -1 ) {
+    if ( current.isOption() && current.str() == OptionName( OptionKey::HELP ) ) {
+      if ( arg_list_.size() == 1 ) {
+        return result_type( OptionName( OptionKey::HELP ), "all" );
+      } else {
+        return result_type( OptionName( OptionKey::HELP ), ( static_cast<std::ptrdiff_t>( index_ ) == first_help_index_ ) ? "" : current.str() );
+      }
+    }
+
+    return result_type( OptionName( OptionKey::HELP ), current.str() );
+  }
+
+  // return in NOT help mode
+  if ( current.isOption() ) {
+    if ( !current.isBinomial() ) { return result_type( current.str(), "" ); }
+    if ( current.hasValue() ) { return result_type( current.str(), current.value() ); }
+
+    if ( ( index_ + 1 ) >= arg_list_.size() ) {
+      throw std::invalid_argument( std::string( "--" ).append( current.str() ).append( " requires a value" ) );
+    }
+
+    return result_type( current.str(), arg_list_[index_ + 1].str() );
+  }
+
+  return result_type( OptionName( OptionKey::DIRECTORY ), current.str() );
+}
+
+class CmdLine {
+public:
+  using value_type = CmdParse::result_type;
+  using container_type = std::vector<value_type>;
+  using const_iterator = container_type::const_iterator;
+
+  constexpr CmdLine( int const, char const * [] );
+  constexpr ~CmdLine() = default;
+
+  constexpr int argNum() const noexcept { return options_.size(); }
+  constexpr std::vector<std::string_view> optionList( std::string_view const ) const;
+
+  template<std::size_t N>
+  constexpr bool isThere( char const (&)[N] ) const noexcept;
+
+  constexpr const_iterator begin() const noexcept { return options_.cbegin(); }
+  constexpr const_iterator end() const noexcept { return options_.cend(); }
+private:
+  // このstd::pairの役割は基本的にはstd::mapと同じだが、
+  // ディレクトリが複数指定される可能性もある。
+  // そのため、キーの重複が許可されている必要があるので、
+  // std::mapは使えない。
+  container_type options_;
+};
+
+constexpr CmdLine::CmdLine( int const arg_count, char const * arg_chars [] ) {
+  // コマンドライン上で与えられたすべての文字列を読み込むと前提している。
+  // そのため、与えられた文字列が一つだけのときは、
+  // 実行パス以外には何も指定されていないということ(=オプションが指定されていない)。
+  if ( arg_count > 1 ) {
+    CmdParse parse( arg_count, arg_chars );
+    options_.reserve( arg_count - 1 );
+
+    // "--"だけが指定されていた場合は、解析すべき引数が一つも無い。
+    if ( parse.get().first.empty() ) { return; }
+
+    do { options_.emplace_back( parse.get() ); } while( !parse.next() );
+  }
+}
+
+constexpr std::vector<std::string_view> CmdLine::optionList( std::string_view const key ) const {
+  std::vector<std::string_view> option_list;
+
+  for ( auto const & itr : options_ ) {
+    if ( itr.first == key ) { option_list.emplace_back( itr.second ); }
+  }
+
+  return option_list;
+}
+
+template<std::size_t N>
+constexpr bool CmdLine::isThere( char const ( & option )[N] ) const noexcept {
+  std::string_view const key( option, N - 1 );
+
+  for ( auto const & itr : options_ ) {
+    if ( itr.first == key ) { return true; }
+  }
+
+  return false;
+}
+
+/****************************************
+ * 型付きのオプション
+ *
+ * 文字列から値への変換は起動時にここで一度だけ行う。
+ ****************************************/
+enum class TimeField : std::uint8_t {
+  WRITE,
+  ACCESS,
+  CREATION,
+  NUM
+};
+
+STATIC_CONSTEXPR char const * TIME_FIELD_NAMES[] = { "write", "access", "creation" };
+static_assert( jig::ArraySize( TIME_FIELD_NAMES ) == static_cast<jig::size_type>( TimeField::NUM ), "TIME_FIELD_NAMES and TimeField are mismatched" );
+
+// ディレクトリを読み込む順序
+enum class TraversalOrder : std::uint8_t {
+  // 深さ優先。読み込み待ちのディレクトリが少なく済む(横に広い木でもメモリを使わない)。
+  DFS,
+  // 幅優先。一つの階層を読み終えてから次の階層に進む。
+  BFS,
+  // 最良優先。ディレクトリ自身の更新時刻が新しいものから読む。
+  // 新しいファイルが作られたディレクトリは更新時刻も新しくなるので、最新のファイルに早く辿り着きやすい。
+  BEST,
+  NUM
+};
+
+STATIC_CONSTEXPR char const * TRAVERSAL_ORDER_NAMES[] = { "dfs", "bfs", "best" };
+static_assert( jig::ArraySize( TRAVERSAL_ORDER_NAMES ) == static_cast<jig::size_type>( TraversalOrder::NUM ), "TRAVERSAL_ORDER_NAMES and TraversalOrder are mismatched" );
+
+STATIC_CONSTEXPR std::size_t UNLIMITED_DEPTH = static_cast<std::size_t>( -1 );
+
+// --countの上限。スレッドやグループごとに上位count件を保持するので、それより多いときは--sortを使う。
+STATIC_CONSTEXPR std::size_t MAX_COUNT = std::size_t( 1 ) << 24;
+
+// ディレクトリを一度に読み込むバッファの大きさ。
+// 一度のシステムコールで多くのエントリを受け取れるように、libcのreaddir(32KiB)よりずっと大きくしておく。
+STATIC_CONSTEXPR std::size_t DEFAULT_DIRECTORY_BUFFER_SIZE = std::size_t( 1 ) << 20;
+// 最小でも、最も長い名前のエントリが一つ入る大きさが要る。
+STATIC_CONSTEXPR std::size_t MIN_DIRECTORY_BUFFER_SIZE = std::size_t( 4 ) << 10;
+STATIC_CONSTEXPR std::size_t MAX_DIRECTORY_BUFFER_SIZE = std::size_t( 64 ) << 20;
+
+// 走査中に一つのスレッドが同時に開くハンドルの数(ディレクトリと、-Lなどで問い合わせるエントリ)
+STATIC_CONSTEXPR std::size_t HANDLES_PER_WORKER = 2;
+// 読み込み待ちのディレクトリを展開したまま保持する量の上限(超えたら詰めて保持する)
+STATIC_CONSTEXPR std::size_t DEFAULT_FRONTIER_MEMORY = std::size_t( 64 ) << 20;
+
+struct Options {
+  bool help = false;
+  std::vector<std::string_view> help_topics;
+  bool version = false;
+
+  std::vector<std::string_view> directories;
+  // 出力するファイルの数(上位何件を出力するか)
+  std::size_t count = 1;
+  TimeField time_field = TimeField::WRITE;
+  Format format = Format::TEXT;
+
+  // 見つかったエントリをすべて、新しい順に出力する
+  bool sort = false;
+  bool recursive = false;
+  // 走査に使うスレッドの数(0なら自動で決める)
+  std::size_t threads = 0;
+  bool follow_links = false;
+  bool unique_inodes = false;
+  // 起点と別のボリュームには入らない
+  bool one_file_system = false;
+  // 起点の直下を1とした、走査する深さの上限
+  std::size_t max_depth = UNLIMITED_DEPTH;
+  TraversalOrder order = TraversalOrder::DFS;
+  std::size_t directory_buffer_size = DEFAULT_DIRECTORY_BUFFER_SIZE;
+  // 走査を打ち切るまでの時間(0なら打ち切らない)
+  std::chrono::milliseconds deadline{ 0 };
+  // 同時に開くハンドルの数の上限(0なら制限しない)
+  std::size_t max_open = 0;
+  std::size_t max_frontier = DEFAULT_FRONTIER_MEMORY;
+  // 複数のプロセスで分担するときの、自分の組
+  Shard shard;
+  std::size_t split_depth = DEFAULT_SPLIT_DEPTH;
+  // ディレクトリを走査する代わりに、標準入力からパスの一覧を読む
+  bool from_stdin = false;
+  // --name、--min-sizeなどの絞り込みの条件(lfl/Filter.hpp)
+  FilterSpec filter;
+  // 除外するパターン(.gitignoreの書式。lfl/Exclude.hpp)と、それを一行ずつ書いたファイル
+  std::vector<std::string_view> excludes;
+  std::vector<std::string_view> exclude_files;
+  // 走査中に見つかった.gitignoreと.ignoreにも従う
+  bool gitignore = false;
+  // グループごとに上位count件を出力する(lfl/Group.hpp)
+  GroupBy group_by = GroupBy::NONE;
+  // --max-depthまでの各ディレクトリについて、その下で最も新しいエントリを出力する(lfl/Tree.hpp)
+  bool tree = false;
+  // 起点ごとに上位count件を、起点の順に出力する
+  bool per_root = false;
+  // .tarと.zipの中のメンバーも報告する(lfl/Archive.hpp)
+  bool archives = false;
+  // 結果を共有メモリに保存して、この時間の間は同じ問い合わせに走査せずに答える(0なら使わない。lfl/Cache.hpp)
+  std::chrono::milliseconds cache_ttl{ 0 };
+  // すべてのスレッドを合わせた、一秒あたりのI/Oとディレクトリの数の上限(0なら制限しない。lfl/Throttle.hpp)
+  std::uint64_t max_iops = 0;
+  std::uint64_t max_directories_per_second = 0;
+  // 走査の途中の状態を保存するファイルと、続きから走査するときに読むファイル(lfl/Checkpoint.hpp)
+  std::string_view checkpoint_file;
+  std::string_view resume_file;
+};
+
+inline Options ParseOptions( CmdLine const & cmd_line ) {
+  Options options;
+  bool is_order_specified = false;
+
+  for ( auto const & [ key, value ] : cmd_line ) {
+    auto const [ is_option, option_index ] = option_list.matchIndex( key );
+    if ( !is_option ) { continue; }
+
+    switch ( static_cast<OptionKey>( option_index ) ) {
+      case OptionKey::HELP:
+        options.help = true;
+        options.help_topics.emplace_back( value );
+        break;
+      case OptionKey::VERSION:
+        options.version = true;
+        break;
+      case OptionKey::DIRECTORY:
+        options.directories.emplace_back( value );
+        break;
+      case OptionKey::COUNT:
+        options.count = VALUE::ParseInteger( key, value );
+        if ( options.count == 0 || MAX_COUNT < options.count ) { throw VALUE::MakeError( key, value, "a positive integer up to 16777216 (use --sort for more)" ); }
+        break;
+      case OptionKey::TIME:
+        options.time_field = VALUE::ParseEnum<TimeField, TIME_FIELD_NAMES>( key, value );
+        break;
+      // 出力形式は最後に指定されたものを採用する。
+      case OptionKey::NULL_DATA:
+        options.format = Format::NUL;
+        break;
+      case OptionKey::JSON:
+        options.format = Format::JSON;
+        break;
+      case OptionKey::BINARY:
+        options.format = Format::BINARY;
+        break;
+      case OptionKey::SORT:
+        options.sort = true;
+        break;
+      case OptionKey::RECURSIVE:
+        options.recursive = true;
+        break;
+      case OptionKey::THREADS:
+        options.threads = VALUE::ParseInteger( key, value );
+        break;
+      case OptionKey::FOLLOW:
+        options.follow_links = true;
+        break;
+      case OptionKey::UNIQUE_INODES:
+        options.unique_inodes = true;
+        break;
+      case OptionKey::XDEV:
+        options.one_file_system = true;
+        break;
+      // 深さを指定したら、サブディレクトリも走査するものとする。
+      case OptionKey::MAX_DEPTH:
+        options.max_depth = VALUE::ParseInteger( key, value );
+        if ( options.max_depth == 0 ) { throw VALUE::MakeError( key, value, "a positive integer" ); }
+        options.recursive = true;
+        break;
+      case OptionKey::ORDER:
+        options.order = VALUE::ParseEnum<TraversalOrder, TRAVERSAL_ORDER_NAMES>( key, value );
+        is_order_specified = true;
+        break;
+      case OptionKey::DIRBUF:
+        options.directory_buffer_size = VALUE::ParseSize( key, value );
+        if ( options.directory_buffer_size < MIN_DIRECTORY_BUFFER_SIZE || MAX_DIRECTORY_BUFFER_SIZE < options.directory_buffer_size ) {
+          throw VALUE::MakeError( key, value, "a size between 4K and 64M" );
+        }
+        break;
+      case OptionKey::DEADLINE:
+        options.deadline = VALUE::ParseDuration( key, value );
+        if ( options.deadline.count() == 0 ) { throw VALUE::MakeError( key, value, "a positive duration" ); }
+        break;
+      case OptionKey::MAX_OPEN:
+        options.max_open = VALUE::ParseInteger( key, value );
+        if ( options.max_open < HANDLES_PER_WORKER ) { throw VALUE::MakeError( key, value, "an integer of 2 or more" ); }
+        break;
+      case OptionKey::MAX_FRONTIER:
+        options.max_frontier = VALUE::ParseSize( key, value );
+        break;
+      case OptionKey::SHARD:
+        options.shard = VALUE::ParseShard( key, value );
+        break;
+      case OptionKey::SPLIT_DEPTH:
+        options.split_depth = VALUE::ParseInteger( key, value );
+        if ( options.split_depth == 0 ) { throw VALUE::MakeError( key, value, "a positive integer" ); }
+        break;
+      case OptionKey::FROM_STDIN:
+        options.from_stdin = true;
+        break;
+      // 名前と種類は、複数指定されたらどれかに一致すればよい。
+      case OptionKey::NAME:
+        options.filter.names.emplace_back( value );
+        break;
+      case OptionKey::MIN_SIZE:
+        options.filter.min_size = VALUE::ParseSize( key, value );
+        break;
+      case OptionKey::MAX_SIZE:
+        options.filter.max_size = VALUE::ParseSize( key, value );
+        break;
+      case OptionKey::TYPE:
+        options.filter.type_mask |= static_cast<std::uint8_t>( 1U << static_cast<unsigned>( VALUE::ParseEnum<EntryType, ENTRY_TYPE_NAMES>( key, value ) ) );
+        break;
+      case OptionKey::MTIME_RANGE:
+        std::tie( options.filter.min_time, options.filter.max_time ) = VALUE::ParseTimeRange( key, value );
+        break;
+      case OptionKey::EXCLUDE:
+        options.excludes.emplace_back( value );
+        break;
+      case OptionKey::EXCLUDE_FROM:
+        options.exclude_files.emplace_back( value );
+        break;
+      case OptionKey::GITIGNORE:
+        options.gitignore = true;
+        break;
+      case OptionKey::GROUP_BY:
+        options.group_by = VALUE::ParseEnum<GroupBy, GROUP_BY_NAMES>( key, value );
+        break;
+      // 一覧に出すのは--max-depthまでだが、その下もすべて読む。
+      case OptionKey::TREE:
+        options.tree = true;
+        options.recursive = true;
+        break;
+      case OptionKey::PER_ROOT:
+        options.per_root = true;
+        break;
+      case OptionKey::ARCHIVES:
+        options.archives = true;
+        break;
+      case OptionKey::CACHE:
+        options.cache_ttl = VALUE::ParseDuration( key, value );
+        if ( options.cache_ttl.count() == 0 ) { throw VALUE::MakeError( key, value, "a positive duration" ); }
+        break;
+      case OptionKey::MAX_IOPS:
+        options.max_iops = VALUE::ParseInteger( key, value );
+        if ( options.max_iops == 0 ) { throw VALUE::MakeError( key, value, "a positive integer" ); }
+        break;
+      case OptionKey::MAX_DIRS_PER_SEC:
+        options.max_directories_per_second = VALUE::ParseInteger( key, value );
+        if ( options.max_directories_per_second == 0 ) { throw VALUE::MakeError( key, value, "a positive integer" ); }
+        break;
+      case OptionKey::CHECKPOINT:
+        options.checkpoint_file = value;
+        break;
+      case OptionKey::RESUME:
+        options.resume_file = value;
+        break;
+      case OptionKey::NUM:
+        break;
+    }
+  }
+
+  if ( options.filter.max_size < options.filter.min_size ) { throw std::invalid_argument( "--min-size is larger than --max-size" ); }
+  // グループごとの出力は、lfl mergeで読み戻せる形式にも、すべてを並べる出力にもならない。
+  if ( options.group_by != GroupBy::NONE && options.format == Format::BINARY ) { throw std::invalid_argument( "--group-by cannot be used with --binary" ); }
+  if ( options.group_by != GroupBy::NONE && options.sort ) { throw std::invalid_argument( "--group-by cannot be used with --sort" ); }
+  if ( options.tree && ( options.format == Format::BINARY || options.sort || options.group_by != GroupBy::NONE ) ) { throw std::invalid_argument( "--tree cannot be used with --binary, --sort or --group-by" ); }
+  // ディレクトリを読まないので、数える先のディレクトリが無い。
+  if ( options.tree && options.from_stdin ) { throw std::invalid_argument( "--tree cannot be used with --from-stdin" ); }
+  // 一覧のパスを一つずつ調べるだけなので、ディレクトリの辿り方の指定は効かない。
+  if ( options.from_stdin && ( options.max_depth != UNLIMITED_DEPTH || options.one_file_system || is_order_specified || options.shard.isSharded() ) ) {
+    throw std::invalid_argument( "--from-stdin cannot be used with --max-depth, --xdev, --order or --shard" );
+  }
+  if ( options.per_root && ( options.format == Format::BINARY || options.sort || options.group_by != GroupBy::NONE || options.tree || options.from_stdin ) ) {
+    throw std::invalid_argument( "--per-root cannot be used with --binary, --sort, --group-by, --tree or --from-stdin" );
+  }
+
+  // 標準入力の一覧は起動ごとに違うので、引数だけでは同じ問い合わせか分からない。
+  if ( options.cache_ttl.count() != 0 && options.from_stdin ) { throw std::invalid_argument( "--cache cannot be used with --from-stdin" ); }
+
+  // 保存するのは上位count件と読み込み待ちのディレクトリだけなので、他の状態を持つ走査は続けられない。
+  if ( ( !options.checkpoint_file.empty() || !options.resume_file.empty() )
+    && ( options.sort || options.group_by != GroupBy::NONE || options.tree || options.per_root || options.from_stdin || options.follow_links || options.unique_inodes || options.gitignore ) ) {
+    throw std::invalid_argument( "--checkpoint and --resume cannot be used with --sort, --group-by, --tree, --per-root, --from-stdin, --follow, --unique-inodes or --gitignore" );
+  }
+
+  // 時間が限られているなら、順序の指定が無ければ最新のファイルに辿り着きやすい順に読む。
+  if ( options.deadline.count() != 0 && !is_order_specified ) { options.order = TraversalOrder::BEST; }
+
+  return options;
+}
+
+} // lfl
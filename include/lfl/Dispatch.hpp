@@ -0,0 +1,63 @@
+/****************************************
+ * lfl/Dispatch.hpp
+ *
+ * 実行時の値の組(オプション)から、コンパイル時に用意しておいた実体化を選ぶための表。
+ *
+ * 走査の内側のループで、オプションごとに分岐するのを避けたい。
+ * そこで、オプションの値を非型テンプレート引数にした関数をすべての組について実体化し、
+ * 関数ポインタの表(std::array)にしておく。オプションを解析した後に一度だけ表を引けば、
+ * それ以降はオプションの分岐が無い(if constexprで消えた)コードが動く。
+ *
+ * 値の組は、各次元の大きさがSIZES...の多次元の添字とみなし、一次元の添字に畳む。
+ ****************************************/
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <utility>
+
+namespace lfl {
+
+namespace DISPATCH {
+
+template<std::size_t... SIZES>
+struct Shape {
+  static constexpr std::size_t DIMENSION = sizeof...( SIZES );
+  // 表の大きさ(すべての組の数)
+  static constexpr std::size_t SIZE = ( SIZES * ... * 1 );
+
+  // 各次元の添字から、表の添字を求める。先頭の次元が最も大きく変わる。
+  template<typename... Indices>
+  static constexpr std::size_t index( Indices const... indices ) noexcept {
+    static_assert( sizeof...( Indices ) == DIMENSION, "the number of indices must match the shape" );
+
+    std::size_t result = 0;
+    std::size_t const values[] = { static_cast<std::size_t>( indices )... };
+    for ( std::size_t dimension = 0; dimension < DIMENSION; ++dimension ) { result = result * SIZE_LIST[dimension] + values[dimension]; }
+
+    return result;
+  }
+
+  // 表の添字から、DIMENSION_INDEX番目の次元の添字を取り出す(index()の逆)。
+  template<std::size_t DIMENSION_INDEX>
+  static constexpr std::size_t coordinate( std::size_t flat ) noexcept {
+    static_assert( DIMENSION_INDEX < DIMENSION, "DIMENSION_INDEX is out of the shape" );
+
+    for ( std::size_t dimension = DIMENSION - 1; dimension > DIMENSION_INDEX; --dimension ) { flat /= SIZE_LIST[dimension]; }
+    return flat % SIZE_LIST[DIMENSION_INDEX];
+  }
+private:
+  static constexpr std::size_t SIZE_LIST[] = { SIZES... };
+};
+
+// Generator<I>::valueを、Iが0からSIZE - 1まで並べた表を作る。
+template<std::size_t SIZE, template<std::size_t> class Generator>
+constexpr auto MakeTable() noexcept {
+  return []<std::size_t... INDICES>( std::index_sequence<INDICES...> ) {
+    return std::array{ Generator<INDICES>::value... };
+  }( std::make_index_sequence<SIZE>() );
+}
+
+} // DISPATCH
+
+} // lfl
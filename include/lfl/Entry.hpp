@@ -0,0 +1,52 @@
+/****************************************
+ * lfl/Entry.hpp
+ *
+ * 走査で見つかった一つのエントリ(ファイル、ディレクトリなど)。
+ * 出力に必要な情報(パス、時刻、サイズ、種類)をすべて持たせて、
+ * 後段のツールがファイルシステムを再び調べなくても済むようにする。
+ ****************************************/
+#pragma once
+
+#include "jig.hpp"
+#include "lfl/Time.hpp"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace lfl {
+
+// パスの区切り文字
+STATIC_CONSTEXPR char DELIMITER = '\\';
+
+enum class EntryType : std::uint8_t {
+  FILE,
+  DIRECTORY,
+  SYMLINK,
+  OTHER,
+  NUM
+};
+
+STATIC_CONSTEXPR char const * ENTRY_TYPE_NAMES[] = { "file", "directory", "symlink", "other" };
+static_assert( jig::ArraySize( ENTRY_TYPE_NAMES ) == static_cast<jig::size_type>( EntryType::NUM ), "ENTRY_TYPE_NAMES and EntryType are mismatched" );
+
+constexpr std::string_view EntryTypeName( EntryType const type ) noexcept { return ENTRY_TYPE_NAMES[static_cast<jig::index_type>( type )]; }
+
+struct Entry {
+  // 走査の起点ディレクトリを含めたパス
+  std::string path;
+  // path中でファイル名が始まる位置
+  std::uint32_t name_offset = 0;
+  EntryType type = EntryType::OTHER;
+  std::uint64_t size = 0;
+  Time time;
+
+  std::string_view name() const noexcept { return std::string_view( path ).substr( name_offset ); }
+};
+
+// ヒープの先頭に最も古いものが来るようにするための比較関数
+struct NewerFirst {
+  bool operator()( Entry const & lhs, Entry const & rhs ) const noexcept { return rhs.time < lhs.time; }
+};
+
+} // lfl
@@ -0,0 +1,220 @@
+/****************************************
+ * lfl/Exclude.hpp
+ *
+ * --exclude、--exclude-from、--gitignoreによる除外。
+ *
+ * 除外されたディレクトリは、開きもせずに走査から外す(読んでから捨てるのではない)。
+ * node_modulesや.gitのように、木の大部分を占めるディレクトリを丸ごと飛ばせる。
+ *
+ * 規則の書き方は.gitignoreに合わせる。
+ *   - 区切り文字を含まないパターン("node_modules"、"*.o")は、どの深さの名前にも一致する。
+ *   - 区切り文字を含むパターン("/build"、"src/gen")は、基準のディレクトリからの相対パスに一致する。
+ *     基準は、--excludeと--exclude-fromでは走査の起点、.gitignoreではそのファイルがあるディレクトリ。
+ *   - 末尾の'/'はディレクトリだけに一致する。"**"は0個以上のディレクトリに一致する。
+ *   - 先頭の'!'は、それより前の規則で除外されたものを除外しない。
+ * 区切り文字は'/'と'\'のどちらでもよい。Windowsに合わせて大文字と小文字は区別しない。
+ *
+ * 規則は追加するときに種類ごとに分けておく。
+ * 否定の規則が無ければ、ワイルドカードの無い名前(最もよく使う形)はハッシュ表を一度引くだけで済む。
+ ****************************************/
+#pragma once
+
+#include "jig.hpp"
+#include "lfl/Entry.hpp"
+#include "lfl/Filter.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace lfl {
+
+enum class ExcludeDecision : std::uint8_t {
+  // どの規則にも一致しない
+  NONE,
+  EXCLUDE,
+  // 否定の規則に一致した(除外しない)
+  INCLUDE
+};
+
+namespace EXCLUDE {
+
+// --from-stdinのパスには'/'で区切られたものもある。
+constexpr bool IsSeparator( char const c ) noexcept { return c == DELIMITER || c == '/'; }
+
+// 区切り文字をまたがないグロブ。"**"だけは区切り文字をまたぐ。patternは小文字にそろえてあること。
+// 規則は短いので、'*'のところで後戻りする素直な実装で足りる。
+inline bool MatchPath( std::string_view const text, std::string_view const pattern ) noexcept {
+  std::size_t text_index = 0, pattern_index = 0;
+
+  while ( pattern_index < pattern.size() ) {
+    char const c = pattern[pattern_index];
+
+    if ( c == '*' ) {
+      bool const is_double = ( pattern_index + 1 < pattern.size() ) && ( pattern[pattern_index + 1] == '*' );
+      pattern_index += is_double ? 2 : 1;
+
+      // "**\"は0個以上のディレクトリなので、ディレクトリの境目からだけ続きを調べる。
+      bool const is_directories = is_double && ( pattern_index < pattern.size() ) && ( pattern[pattern_index] == DELIMITER );
+      if ( is_directories ) { ++pattern_index; }
+
+      std::string_view const rest = pattern.substr( pattern_index );
+      for ( std::size_t next = text_index; next <= text.size(); ++next ) {
+        bool const is_boundary = !is_directories || ( next == text_index ) || IsSeparator( text[next - 1] );
+        if ( is_boundary && MatchPath( text.substr( next ), rest ) ) { return true; }
+        if ( !is_double && next < text.size() && IsSeparator( text[next] ) ) { break; }
+      }
+
+      return false;
+    }
+
+    if ( text_index == text.size() ) { return false; }
+    char const t = IsSeparator( text[text_index] ) ? DELIMITER : FILTER::FoldCase( text[text_index] );
+    if ( ( c == '?' ) ? ( t == DELIMITER ) : ( c != t ) ) { return false; }
+
+    ++text_index;
+    ++pattern_index;
+  }
+
+  return text_index == text.size();
+}
+
+} // EXCLUDE
+
+class ExcludeRules {
+public:
+  ExcludeRules() = default;
+  // ハッシュ表のキーがliterals_の中を指しているので、コピーはできない(ムーブはできる)。
+  ExcludeRules( ExcludeRules const & ) = delete;
+  ExcludeRules & operator=( ExcludeRules const & ) = delete;
+  ExcludeRules( ExcludeRules && ) noexcept = default;
+  ExcludeRules & operator=( ExcludeRules && ) noexcept = default;
+
+  // .gitignoreの一行を規則として追加する。空行と'#'で始まる行は無視する。
+  void add( std::string_view line ) {
+    while ( !line.empty() && line.back() == ' ' ) { line.remove_suffix( 1 ); }
+    if ( line.empty() || line.front() == '#' ) { return; }
+
+    Rule rule;
+    if ( line.front() == '!' ) {
+      rule.is_negated = true;
+      line.remove_prefix( 1 );
+    } else if ( line.size() > 1 && line.front() == '\\' && ( line[1] == '#' || line[1] == '!' ) ) {
+      line.remove_prefix( 1 );
+    }
+
+    std::string pattern( line );
+    for ( auto & itr : pattern ) {
+      if ( itr == '/' ) { itr = DELIMITER; }
+    }
+
+    if ( !pattern.empty() && pattern.back() == DELIMITER ) {
+      rule.is_directory_only = true;
+      pattern.pop_back();
+    }
+    if ( pattern.empty() ) { return; }
+
+    // 先頭の区切り文字は基準のディレクトリを表すだけなので取り除く。
+    std::size_t const separator = pattern.rfind( DELIMITER );
+    rule.is_anchored = ( separator != std::string::npos );
+    if ( rule.is_anchored && pattern.front() == DELIMITER ) { pattern.erase( 0, 1 ); }
+
+    if ( rule.is_anchored ) {
+      // 最後の構成要素は名前に、それより前はディレクトリの相対パスに対して調べる。
+      std::size_t const name_begin = pattern.rfind( DELIMITER ) + 1;
+      rule.directory.assign( pattern, 0, name_begin );
+      std::transform( rule.directory.begin(), rule.directory.end(), rule.directory.begin(), []( char const c ){ return FILTER::FoldCase( c ); } );
+      pattern.erase( 0, name_begin );
+    }
+
+    rule.name = FILTER::CompilePattern( pattern );
+    has_negation_ = has_negation_ || rule.is_negated;
+
+    // ワイルドカードの無い名前だけの規則は、ハッシュ表にも入れておく。
+    if ( !rule.is_anchored && !rule.is_negated && rule.name.kind == FILTER::PatternKind::EXACT ) {
+      auto & names = rule.is_directory_only ? directory_names_ : names_;
+      names.emplace( literals_.emplace_back( rule.name.literal ) );
+    } else {
+      is_all_literal_ = false;
+    }
+
+    rules_.emplace_back( std::move( rule ) );
+  }
+
+  bool empty() const noexcept { return rules_.empty(); }
+
+  // relative_directoryは、基準のディレクトリからのエントリの親の相対パス(空か、区切り文字で終わる)。
+  ExcludeDecision match( std::string_view const relative_directory, std::string_view const name, bool const is_directory ) const noexcept {
+    if ( rules_.empty() ) { return ExcludeDecision::NONE; }
+
+    // 否定が無ければ、どれか一つに一致すれば除外する。
+    if ( !has_negation_ ) {
+      if ( names_.contains( name ) || ( is_directory && directory_names_.contains( name ) ) ) { return ExcludeDecision::EXCLUDE; }
+      if ( is_all_literal_ ) { return ExcludeDecision::NONE; }
+    }
+
+    // 後の規則ほど優先するので、後ろから調べて最初に一致したものに従う。
+    for ( auto itr = rules_.rbegin(); itr != rules_.rend(); ++itr ) {
+      if ( itr->is_directory_only && !is_directory ) { continue; }
+      if ( itr->is_anchored && !EXCLUDE::MatchPath( relative_directory, itr->directory ) ) { continue; }
+      if ( !FILTER::MatchPattern( itr->name, name ) ) { continue; }
+
+      return itr->is_negated ? ExcludeDecision::INCLUDE : ExcludeDecision::EXCLUDE;
+    }
+
+    return ExcludeDecision::NONE;
+  }
+private:
+  struct Rule {
+    FILTER::NamePattern name;
+    // 区切り文字を含む規則の、最後の構成要素より前(区切り文字で終わる。小文字)
+    std::string directory;
+    bool is_anchored = false;
+    bool is_directory_only = false;
+    bool is_negated = false;
+  };
+
+  std::vector<Rule> rules_;
+  // ハッシュ表のキーの実体。dequeなので追加しても参照は無効にならない。
+  std::deque<std::string> literals_;
+  std::unordered_set<std::string_view, FILTER::FoldedHash, FILTER::FoldedEqual> names_;
+  std::unordered_set<std::string_view, FILTER::FoldedHash, FILTER::FoldedEqual> directory_names_;
+  bool has_negation_ = false;
+  bool is_all_literal_ = true;
+};
+
+// --gitignoreで読むファイル。同じディレクトリにあれば、後のものを優先する。
+STATIC_CONSTEXPR char const * IGNORE_FILE_NAMES[] = { ".gitignore", ".ignore" };
+
+/****************************************
+ * 走査中に見つかった.gitignore(と.ignore)の規則。
+ * ファイルがあったディレクトリより下にだけ適用するので、親をたどれるように連ねておき、
+ * 読み込み待ちのディレクトリ(DirectoryJob)ごとに、そこに適用する最も内側のものを持たせる。
+ ****************************************/
+struct IgnoreScope {
+  std::shared_ptr<IgnoreScope const> parent;
+  // 起点からの、規則の基準のディレクトリの相対パス(空か、区切り文字で終わる)
+  std::string base;
+  ExcludeRules rules;
+};
+
+// コマンドラインの規則で除外されれば、.gitignoreで否定されていても除外する。
+// .gitignoreどうしでは、内側のディレクトリのものを優先する(gitと同じ)。
+inline bool IsExcluded( ExcludeRules const & rules, IgnoreScope const * scope, std::string_view const relative_directory, std::string_view const name, bool const is_directory ) noexcept {
+  if ( rules.match( relative_directory, name, is_directory ) == ExcludeDecision::EXCLUDE ) { return true; }
+
+  for ( ; scope != nullptr; scope = scope->parent.get() ) {
+    ExcludeDecision const decision = scope->rules.match( relative_directory.substr( scope->base.size() ), name, is_directory );
+    if ( decision != ExcludeDecision::NONE ) { return decision == ExcludeDecision::EXCLUDE; }
+  }
+
+  return false;
+}
+
+} // lfl
@@ -0,0 +1,71 @@
+/****************************************
+ * lfl/FileSystem.hpp
+ *
+ * 走査がファイルシステムに発行する呼び出し(ディレクトリを開く、一回分を読む、実体の情報を問い合わせる、ファイルを読む)。
+ *
+ * 既定は実際のファイルシステム(NativeFileSystem)で、テストとベンチマークでは
+ * メモリ上の木(lfl/MemoryFileSystem.hpp)に差し替える(ScanConfig::file_system)。
+ * ディレクトリの一回分の読み込みは、どちらもGetFileInformationByHandleExと同じく
+ * FILE_FULL_DIR_INFOの並びをバッファに書くので、エントリごとの処理は差し替えても同じものが動く。
+ * 呼び出しはディレクトリの一回分ごと(エントリごとではない)なので、仮想関数の呼び出しは走査の速さに響かない。
+ *
+ * --archivesのアーカイブと、--group-by=ownerの所有者は、差し替えても実際のファイルシステムに問い合わせる。
+ * 実際のファイルシステムの呼び出し(Windows API)はsrc/FileSystem.cppにある。
+ ****************************************/
+#pragma once
+
+#include "jig.hpp"
+
+#include <cstdint>
+#include <string>
+
+namespace lfl {
+
+// 実体の情報(BY_HANDLE_FILE_INFORMATIONのうち、走査が使うもの)。
+// 時刻はFILETIME(1601-01-01からの100ナノ秒単位)のまま持つ。
+struct FileInformation {
+  // FILE_ATTRIBUTE_*
+  std::uint32_t attributes = 0;
+  std::uint64_t creation_time = 0;
+  std::uint64_t access_time = 0;
+  std::uint64_t write_time = 0;
+  std::uint64_t size = 0;
+  // 以下はハンドルを開いて問い合わせたときだけ入る(queryAttributesでは0のまま)。
+  // ボリュームのシリアル番号と、ボリュームの中でのファイルの番号
+  std::uint32_t volume = 0;
+  std::uint64_t index = 0;
+  std::uint32_t links = 0;
+};
+
+// ディレクトリの一回分の読み込みの結果
+enum class ReadStatus : std::uint8_t {
+  // バッファに一つ以上のエントリを書いた
+  READ,
+  // もう読むエントリが無い
+  END,
+  // 読めなかった(途中で消された、権限が無いなど)
+  FAILED
+};
+
+class FileSystem {
+public:
+  virtual ~FileSystem() = default;
+
+  // 区切り文字で終わるディレクトリのパスを開く。開けなければnullptrを返す。
+  virtual void * openDirectory( std::string const & path ) = 0;
+  // 開いたディレクトリの続きを、FILE_FULL_DIR_INFOの並びとしてbufferに読む(bufferは8バイト境界に置く)。
+  virtual ReadStatus readDirectory( void * directory, void * buffer, std::uint32_t size ) = 0;
+  virtual void closeDirectory( void * directory ) noexcept = 0;
+
+  // パスが指す実体の情報を問い合わせる。シンボリックリンクやジャンクションはたどった先の情報になる。
+  virtual bool queryInformation( std::string const & path, FileInformation & information ) = 0;
+  // ハンドルを開かずに分かる情報だけを問い合わせる(リンクはたどらない。volume、index、linksは0)。
+  virtual bool queryAttributes( std::string const & path, FileInformation & information ) = 0;
+  // ファイルの中身をすべて読む(.gitignoreなど)。
+  virtual bool readFile( std::string const & path, std::string & contents ) = 0;
+};
+
+// 実際のファイルシステム(Windows API)。状態を持たないので、すべてのスレッドで共有する。
+FileSystem & NativeFileSystem() noexcept;
+
+} // lfl
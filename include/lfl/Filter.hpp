@@ -0,0 +1,254 @@
+/****************************************
+ * lfl/Filter.hpp
+ *
+ * --name、--min-size、--max-size、--type、--mtime-rangeによる絞り込み。
+ *
+ * 条件は起動時に一度だけ、命令を平らに並べた配列(プログラム)に変換しておき、
+ * エントリごとには配列を先頭から順に評価するだけにする。
+ * 式の木をエントリごとにたどると、ディレクトリを速く読んでも絞り込みで時間を取られる。
+ *
+ * 評価は二段階に分ける。
+ *   1. 名前: ディレクトリを読んだ時点で分かる。-Lや--unique-inodesで
+ *      実体の情報を問い合わせる前に調べ、外れたエントリは問い合わせない。
+ *   2. 情報: 種類、サイズ、更新時刻。安い比較から順に並べる。
+ ****************************************/
+#pragma once
+
+#include "lfl/Entry.hpp"
+#include "lfl/Sink.hpp"
+#include "lfl/Time.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace lfl {
+
+// コマンドラインで指定された条件(文字列はargvを参照するだけ)
+struct FilterSpec {
+  // どれか一つに一致すればよい名前のパターン('*'と'?'を使える)
+  std::vector<std::string_view> names;
+  std::uint64_t min_size = 0;
+  std::uint64_t max_size = std::numeric_limits<std::uint64_t>::max();
+  // 1 << EntryTypeの和(0ならすべての種類)
+  std::uint8_t type_mask = 0;
+  // 更新時刻の範囲[min_time, max_time)
+  Time min_time = Time::Min();
+  Time max_time = Time::Max();
+};
+
+namespace FILTER {
+
+// Windowsのファイル名は大文字と小文字を区別しないので、ASCIIの範囲で小文字にそろえて比べる。
+constexpr char FoldCase( char const c ) noexcept { return ( 'A' <= c && c <= 'Z' ) ? static_cast<char>( c - 'A' + 'a' ) : c; }
+
+// literalは小文字にそろえてあること。
+constexpr bool EqualFolded( std::string_view const text, std::string_view const literal ) noexcept {
+  if ( text.size() != literal.size() ) { return false; }
+
+  for ( std::size_t index = 0; index < text.size(); ++index ) {
+    if ( FoldCase( text[index] ) != literal[index] ) { return false; }
+  }
+
+  return true;
+}
+
+constexpr bool ContainsFolded( std::string_view const text, std::string_view const literal ) noexcept {
+  if ( text.size() < literal.size() ) { return false; }
+
+  for ( std::size_t begin = 0; begin + literal.size() <= text.size(); ++begin ) {
+    if ( EqualFolded( text.substr( begin, literal.size() ), literal ) ) { return true; }
+  }
+
+  return false;
+}
+
+// 大文字と小文字を区別しないハッシュと比較(ハッシュ表のキー用)
+struct FoldedHash {
+  std::size_t operator()( std::string_view const text ) const noexcept {
+    std::uint64_t hash = 0xCBF29CE484222325ULL;
+    for ( char const c : text ) {
+      hash ^= static_cast<unsigned char>( FoldCase( c ) );
+      hash *= 0x100000001B3ULL;
+    }
+    return static_cast<std::size_t>( hash );
+  }
+};
+
+struct FoldedEqual {
+  bool operator()( std::string_view const lhs, std::string_view const rhs ) const noexcept {
+    if ( lhs.size() != rhs.size() ) { return false; }
+
+    for ( std::size_t index = 0; index < lhs.size(); ++index ) {
+      if ( FoldCase( lhs[index] ) != FoldCase( rhs[index] ) ) { return false; }
+    }
+
+    return true;
+  }
+};
+
+// '*'(0文字以上)と'?'(1文字)を使えるパターン。patternは小文字にそろえてあること。
+// 最後に現れた'*'の位置だけを覚えておけば、後戻りは線形で済む。
+constexpr bool MatchGlob( std::string_view const text, std::string_view const pattern ) noexcept {
+  std::size_t text_index = 0, pattern_index = 0;
+  std::size_t star = std::string_view::npos, star_text = 0;
+
+  while ( text_index < text.size() ) {
+    if ( pattern_index < pattern.size() && ( pattern[pattern_index] == '?' || pattern[pattern_index] == FoldCase( text[text_index] ) ) ) {
+      ++text_index;
+      ++pattern_index;
+    } else if ( pattern_index < pattern.size() && pattern[pattern_index] == '*' ) {
+      star = pattern_index++;
+      star_text = text_index;
+    } else if ( star != std::string_view::npos ) {
+      pattern_index = star + 1;
+      text_index = ++star_text;
+    } else {
+      return false;
+    }
+  }
+
+  while ( pattern_index < pattern.size() && pattern[pattern_index] == '*' ) { ++pattern_index; }
+  return pattern_index == pattern.size();
+}
+
+// パターンの形。安く調べられるものから並べてある。
+enum class PatternKind : std::uint8_t {
+  EXACT,
+  PREFIX,
+  SUFFIX,
+  CONTAINS,
+  GLOB
+};
+
+struct NamePattern {
+  PatternKind kind;
+  // GLOBではパターン全体、それ以外はワイルドカードを除いた部分(小文字)
+  std::string literal;
+};
+
+inline NamePattern CompilePattern( std::string_view const pattern ) {
+  std::string folded( pattern );
+  std::transform( folded.begin(), folded.end(), folded.begin(), FoldCase );
+
+  std::string_view const view( folded );
+  bool const has_head_star = view.starts_with( '*' );
+  bool const has_tail_star = view.size() > 1 && view.ends_with( '*' );
+  std::string_view const body = view.substr( has_head_star ? 1 : 0, view.size() - ( has_head_star ? 1 : 0 ) - ( has_tail_star ? 1 : 0 ) );
+
+  // 両端の'*'以外にワイルドカードがあれば、一般のパターンとして扱う。
+  if ( body.find_first_of( "*?" ) != std::string_view::npos ) { return NamePattern{ PatternKind::GLOB, std::move( folded ) }; }
+
+  PatternKind const kind = has_head_star
+    ? ( has_tail_star ? PatternKind::CONTAINS : PatternKind::SUFFIX )
+    : ( has_tail_star ? PatternKind::PREFIX : PatternKind::EXACT );
+
+  return NamePattern{ kind, std::string( body ) };
+}
+
+inline bool MatchPattern( NamePattern const & pattern, std::string_view const name ) noexcept {
+  std::string_view const literal( pattern.literal );
+
+  switch ( pattern.kind ) {
+    case PatternKind::EXACT: return EqualFolded( name, literal );
+    case PatternKind::PREFIX: return name.size() >= literal.size() && EqualFolded( name.substr( 0, literal.size() ), literal );
+    case PatternKind::SUFFIX: return name.size() >= literal.size() && EqualFolded( name.substr( name.size() - literal.size() ), literal );
+    case PatternKind::CONTAINS: return ContainsFolded( name, literal );
+    case PatternKind::GLOB: return MatchGlob( name, literal );
+  }
+
+  return false;
+}
+
+// 情報に対する命令。並びは評価する順(安い順)。
+enum class Opcode : std::uint8_t {
+  TYPE,
+  MIN_SIZE,
+  MAX_SIZE,
+  MIN_TIME,
+  MAX_TIME
+};
+
+struct Instruction {
+  Opcode opcode;
+  // TYPEは種類のビットの和、サイズはバイト数、時刻はナノ秒(Time::rep)をそのまま入れる。
+  std::uint64_t operand;
+};
+
+} // FILTER
+
+class Filter {
+public:
+  Filter() = default;
+
+  explicit Filter( FilterSpec const & spec ) {
+    bool is_any_name = false;
+    for ( auto const & itr : spec.names ) {
+      // "*"が一つでもあれば、名前では絞り込まない。
+      if ( itr == "*" ) { is_any_name = true; }
+      patterns_.emplace_back( FILTER::CompilePattern( itr ) );
+    }
+    if ( is_any_name ) { patterns_.clear(); }
+
+    std::stable_sort( patterns_.begin(), patterns_.end(), []( FILTER::NamePattern const & lhs, FILTER::NamePattern const & rhs ){ return lhs.kind < rhs.kind; } );
+
+    // 絞り込まない条件は命令にしない。
+    using FILTER::Opcode;
+    if ( spec.type_mask != 0 ) { program_.emplace_back( FILTER::Instruction{ Opcode::TYPE, spec.type_mask } ); }
+    if ( spec.min_size != 0 ) { program_.emplace_back( FILTER::Instruction{ Opcode::MIN_SIZE, spec.min_size } ); }
+    if ( spec.max_size != std::numeric_limits<std::uint64_t>::max() ) { program_.emplace_back( FILTER::Instruction{ Opcode::MAX_SIZE, spec.max_size } ); }
+    if ( Time::Min() < spec.min_time ) { program_.emplace_back( FILTER::Instruction{ Opcode::MIN_TIME, static_cast<std::uint64_t>( spec.min_time.ns() ) } ); }
+    if ( spec.max_time < Time::Max() ) { program_.emplace_back( FILTER::Instruction{ Opcode::MAX_TIME, static_cast<std::uint64_t>( spec.max_time.ns() ) } ); }
+  }
+
+  // 名前だけで判定できる部分。実体の情報を問い合わせる前に呼ぶ。
+  bool matchName( std::string_view const name ) const noexcept {
+    if ( patterns_.empty() ) { return true; }
+
+    for ( auto const & itr : patterns_ ) {
+      if ( FILTER::MatchPattern( itr, name ) ) { return true; }
+    }
+
+    return false;
+  }
+
+  // 名前以外の部分。write_timeは--timeの指定によらず更新時刻。
+  bool matchInformation( FoundEntry const & found, Time const write_time ) const noexcept {
+    using FILTER::Opcode;
+
+    for ( auto const & itr : program_ ) {
+      switch ( itr.opcode ) {
+        case Opcode::TYPE:
+          if ( !( itr.operand & ( 1U << static_cast<unsigned>( found.type ) ) ) ) { return false; }
+          break;
+        case Opcode::MIN_SIZE:
+          if ( found.size < itr.operand ) { return false; }
+          break;
+        case Opcode::MAX_SIZE:
+          if ( itr.operand < found.size ) { return false; }
+          break;
+        case Opcode::MIN_TIME:
+          if ( write_time.ns() < static_cast<Time::rep>( itr.operand ) ) { return false; }
+          break;
+        case Opcode::MAX_TIME:
+          if ( static_cast<Time::rep>( itr.operand ) <= write_time.ns() ) { return false; }
+          break;
+      }
+    }
+
+    return true;
+  }
+
+  bool empty() const noexcept { return patterns_.empty() && program_.empty(); }
+  std::vector<FILTER::NamePattern> const & patterns() const noexcept { return patterns_; }
+  std::vector<FILTER::Instruction> const & program() const noexcept { return program_; }
+private:
+  std::vector<FILTER::NamePattern> patterns_;
+  std::vector<FILTER::Instruction> program_;
+};
+
+} // lfl
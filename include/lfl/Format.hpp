@@ -0,0 +1,343 @@
+/****************************************
+ * lfl/Format.hpp
+ *
+ * エントリの出力形式
+ *
+ * TEXT   : ファイル名と改行(従来の出力)
+ * NUL    : パスと'\0'(改行を含むファイル名でも区切りが壊れない)
+ * JSON   : JSON Lines。一行に一つのオブジェクト
+ *          {"path":"...","time":<ns>,"size":<bytes>,"type":"file"}
+ * BINARY : 固定長のレコードヘッダとパスのバイト列。
+ *          lfl mergeで読み戻せるので、--shardの部分結果の受け渡しにも使う。
+ *
+ * --group-byでは、各エントリの前にグループのキーを付ける(BINARYには付けられない)。
+ * TEXTはキーとタブ、NULはキーと'\0'を前に置き、JSONは"group"を加える。
+ * --treeでは、ディレクトリごとに、その下で最も新しいエントリを付ける。
+ * TEXTはディレクトリ、時刻(UTCのYYYY-MM-DDTHH:MM:SSZ)、名前をタブで区切り、JSONは"directory"を加える。
+ ****************************************/
+#pragma once
+
+#include "jig.hpp"
+#include "lfl/Entry.hpp"
+#include "lfl/Time.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#if defined( __SSE2__ )
+#include <emmintrin.h>
+#endif
+
+namespace lfl {
+
+enum class Format : std::uint8_t {
+  TEXT,
+  NUL,
+  JSON,
+  BINARY,
+  NUM
+};
+
+namespace FORMAT {
+
+/****************************************
+ * JSON
+ ****************************************/
+// エスケープが必要なのは'"'と'\\'と制御文字(0x00-0x1F)だけ。
+// 0x80以上のバイトは、WriteJsonStringがUTF-8に変換した後のものなので、そのまま出力する。
+constexpr bool NeedsJsonEscape( unsigned char const one_char ) noexcept {
+  return ( one_char < 0x20 ) || ( one_char == '"' ) || ( one_char == '\\' );
+}
+
+// エスケープが必要な最初の文字の位置を返す。見つからなければsizeを返す。
+// ほとんどのパスにはエスケープすべき文字が無いので、
+// 16バイトずつまとめて調べて、何も無ければそのまま読み飛ばす。
+inline std::size_t FindJsonEscape( char const * const str, std::size_t const size ) noexcept {
+  std::size_t index = 0;
+
+#if defined( __SSE2__ )
+  __m128i const quote = _mm_set1_epi8( '"' );
+  __m128i const backslash = _mm_set1_epi8( '\\' );
+  __m128i const control_max = _mm_set1_epi8( 0x1F );
+
+  for ( ; ( index + 16 ) <= size; index += 16 ) {
+    __m128i const chunk = _mm_loadu_si128( reinterpret_cast<__m128i const *>( str + index ) );
+    // 符号なしで chunk <= 0x1F  <=>  min( chunk, 0x1F ) == chunk
+    __m128i const is_control = _mm_cmpeq_epi8( _mm_min_epu8( chunk, control_max ), chunk );
+    __m128i const is_special = _mm_or_si128( _mm_cmpeq_epi8( chunk, quote ), _mm_cmpeq_epi8( chunk, backslash ) );
+    int const mask = _mm_movemask_epi8( _mm_or_si128( is_control, is_special ) );
+
+    if ( mask != 0 ) { return index + __builtin_ctz( static_cast<unsigned int>( mask ) ); }
+  }
+#endif
+
+  for ( ; index < size; ++index ) {
+    if ( NeedsJsonEscape( static_cast<unsigned char>( str[index] ) ) ) { return index; }
+  }
+
+  return size;
+}
+
+// JSONの文字列はUTF-8で書く。パスはANSIコードページのバイト列なので、
+// ASCIIでない文字を含んでいれば、書き出し層で先にUTF-8に変換する(lfl/Output.hpp)。
+template<typename Writer>
+void WriteJsonString( Writer & writer, std::string_view str ) {
+  STATIC_CONSTEXPR char HEX[] = "0123456789abcdef";
+
+  if constexpr ( requires { writer.toUtf8( str ); } ) {
+    if ( std::any_of( str.begin(), str.end(), []( char const one_char ){ return static_cast<unsigned char>( one_char ) >= 0x80; } ) ) { str = writer.toUtf8( str ); }
+  }
+
+  writer.put( '"' );
+
+  while ( !str.empty() ) {
+    std::size_t const clean = FindJsonEscape( str.data(), str.size() );
+    writer.write( str.data(), clean );
+    if ( clean == str.size() ) { break; }
+
+    unsigned char const one_char = static_cast<unsigned char>( str[clean] );
+    switch ( one_char ) {
+      case '"': writer.write( "\\\"", 2 ); break;
+      case '\\': writer.write( "\\\\", 2 ); break;
+      case '\b': writer.write( "\\b", 2 ); break;
+      case '\f': writer.write( "\\f", 2 ); break;
+      case '\n': writer.write( "\\n", 2 ); break;
+      case '\r': writer.write( "\\r", 2 ); break;
+      case '\t': writer.write( "\\t", 2 ); break;
+      default: {
+        char const escaped[] = { '\\', 'u', '0', '0', HEX[one_char >> 4], HEX[one_char & 0x0F] };
+        writer.write( escaped, sizeof( escaped ) );
+        break;
+      }
+    }
+
+    str.remove_prefix( clean + 1 );
+  }
+
+  writer.put( '"' );
+}
+
+/****************************************
+ * BINARY
+ *
+ * ストリームの先頭にBinaryHeaderを一度だけ書き、
+ * その後にエントリごとにBinaryRecordとパスのバイト列(path_lengthバイト、'\0'なし)を並べる。
+ * 整数はすべてリトルエンディアン(x86_64のネイティブ)。
+ ****************************************/
+STATIC_CONSTEXPR char BINARY_MAGIC[4] = { 'L', 'F', 'L', 'B' };
+STATIC_CONSTEXPR std::uint32_t BINARY_VERSION = 1;
+
+struct BinaryHeader {
+  char magic[4];
+  std::uint32_t version;
+};
+
+struct BinaryRecord {
+  std::int64_t time;
+  std::uint64_t size;
+  std::uint32_t path_length;
+  std::uint8_t type;
+  std::uint8_t reserved[3];
+};
+
+static_assert( sizeof( BinaryHeader ) == 8, "BinaryHeader must be 8 bytes" );
+static_assert( sizeof( BinaryRecord ) == 24, "BinaryRecord must be 24 bytes" );
+
+template<typename Writer>
+void WriteBinaryHeader( Writer & writer ) {
+  BinaryHeader header{};
+  std::memcpy( header.magic, BINARY_MAGIC, sizeof( BINARY_MAGIC ) );
+  header.version = BINARY_VERSION;
+  writer.write( reinterpret_cast<char const *>( &header ), sizeof( header ) );
+}
+
+template<typename Writer>
+void WriteBinaryRecord( Writer & writer, Entry const & entry ) {
+  BinaryRecord record{};
+  record.time = entry.time.ns();
+  record.size = entry.size;
+  record.path_length = static_cast<std::uint32_t>( entry.path.size() );
+  record.type = static_cast<std::uint8_t>( entry.type );
+
+  writer.write( reinterpret_cast<char const *>( &record ), sizeof( record ) );
+  writer.write( entry.path.data(), entry.path.size() );
+}
+
+// バイナリ形式の出力を読み戻し、レコードごとにfunction( entry )を呼ぶ(lfl mergeで使う)。
+// entryの文字列の領域は使い回す。形式が壊れていたらfalseを返す。
+template<typename Function>
+bool ReadBinaryEntries( std::string_view data, Entry & entry, Function && function ) {
+  BinaryHeader header;
+  if ( data.size() < sizeof( header ) ) { return false; }
+
+  std::memcpy( &header, data.data(), sizeof( header ) );
+  if ( std::memcmp( header.magic, BINARY_MAGIC, sizeof( BINARY_MAGIC ) ) != 0 || header.version != BINARY_VERSION ) { return false; }
+  data.remove_prefix( sizeof( header ) );
+
+  while ( !data.empty() ) {
+    BinaryRecord record;
+    if ( data.size() < sizeof( record ) ) { return false; }
+
+    std::memcpy( &record, data.data(), sizeof( record ) );
+    data.remove_prefix( sizeof( record ) );
+
+    if ( data.size() < record.path_length || static_cast<std::uint8_t>( EntryType::NUM ) <= record.type ) { return false; }
+
+    entry.path.assign( data.data(), record.path_length );
+    entry.name_offset = 0;
+    entry.type = static_cast<EntryType>( record.type );
+    entry.size = record.size;
+    entry.time = Time( record.time );
+    data.remove_prefix( record.path_length );
+
+    function( entry );
+  }
+
+  return true;
+}
+
+/****************************************
+ * 時刻の文字列(--treeのTEXT)
+ ****************************************/
+struct CivilDate {
+  std::int64_t year;
+  unsigned month;
+  unsigned day;
+};
+
+// 1970-01-01からの日数から、年月日を求める(lfl/Value.hppのDaysFromCivilの逆)。
+constexpr CivilDate CivilFromDays( std::int64_t days ) noexcept {
+  days += 719468;
+  std::int64_t const era = ( ( days >= 0 ) ? days : days - 146096 ) / 146097;
+  unsigned const day_of_era = static_cast<unsigned>( days - era * 146097 );
+  unsigned const year_of_era = ( day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096 ) / 365;
+  unsigned const day_of_year = day_of_era - ( 365 * year_of_era + year_of_era / 4 - year_of_era / 100 );
+  unsigned const month_index = ( 5 * day_of_year + 2 ) / 153;
+  unsigned const month = ( month_index < 10 ) ? month_index + 3 : month_index - 9;
+
+  return CivilDate{ static_cast<std::int64_t>( year_of_era ) + era * 400 + ( ( month <= 2 ) ? 1 : 0 ), month, day_of_year - ( 153 * month_index + 2 ) / 5 + 1 };
+}
+
+STATIC_CONSTEXPR std::size_t ISO_TIME_LENGTH = 20;
+
+// "2024-05-01T12:30:15Z"(秒未満は切り捨て)。年は0から9999に収める。
+constexpr void FormatIsoTime( Time const time, char ( & text )[ISO_TIME_LENGTH] ) noexcept {
+  Time::rep const ns_per_second = 1000000000;
+  Time::rep seconds = time.ns() / ns_per_second;
+  if ( time.ns() % ns_per_second < 0 ) { --seconds; }
+
+  Time::rep days = seconds / 86400;
+  Time::rep second_of_day = seconds % 86400;
+  if ( second_of_day < 0 ) {
+    --days;
+    second_of_day += 86400;
+  }
+
+  CivilDate const date = CivilFromDays( days );
+  std::int64_t const year = std::clamp<std::int64_t>( date.year, 0, 9999 );
+
+  auto const digits = [ &text ]( std::size_t const position, std::int64_t value, std::size_t const width ) {
+    for ( std::size_t index = width; index > 0; --index ) {
+      text[position + index - 1] = static_cast<char>( '0' + value % 10 );
+      value /= 10;
+    }
+  };
+
+  digits( 0, year, 4 );
+  text[4] = '-';
+  digits( 5, date.month, 2 );
+  text[7] = '-';
+  digits( 8, date.day, 2 );
+  text[10] = 'T';
+  digits( 11, second_of_day / 3600, 2 );
+  text[13] = ':';
+  digits( 14, second_of_day / 60 % 60, 2 );
+  text[16] = ':';
+  digits( 17, second_of_day % 60, 2 );
+  text[19] = 'Z';
+}
+
+} // FORMAT
+
+// 出力の先頭で一度だけ呼び出す。
+template<typename Writer>
+void BeginEntries( Writer & writer, Format const format ) {
+  if ( format == Format::BINARY ) { FORMAT::WriteBinaryHeader( writer ); }
+}
+
+template<typename Writer>
+void WriteEntry( Writer & writer, Entry const & entry, Format const format ) {
+  switch ( format ) {
+    case Format::NUL:
+      writer << entry.path << '\0';
+      break;
+    case Format::JSON:
+      writer.write( "{\"path\":", 8 );
+      FORMAT::WriteJsonString( writer, entry.path );
+      writer << ",\"time\":" << entry.time.ns() << ",\"size\":" << entry.size << ",\"type\":\"" << EntryTypeName( entry.type ) << "\"}\n";
+      break;
+    case Format::BINARY:
+      FORMAT::WriteBinaryRecord( writer, entry );
+      break;
+    default:
+      writer << entry.name() << '\n';
+      break;
+  }
+}
+
+// --treeの出力。newestはdirectoryの下で最も新しいエントリ(一つも無ければnullptr)。
+template<typename Writer>
+void WriteTreeEntry( Writer & writer, std::string_view const directory, Entry const * const newest, Format const format ) {
+  switch ( format ) {
+    case Format::NUL:
+      writer << directory << '\0' << ( ( newest != nullptr ) ? std::string_view( newest->path ) : std::string_view() ) << '\0';
+      break;
+    case Format::JSON:
+      writer.write( "{\"directory\":", 13 );
+      FORMAT::WriteJsonString( writer, directory );
+      if ( newest != nullptr ) {
+        writer.write( ",\"path\":", 8 );
+        FORMAT::WriteJsonString( writer, newest->path );
+        writer << ",\"time\":" << newest->time.ns() << ",\"size\":" << newest->size << ",\"type\":\"" << EntryTypeName( newest->type ) << '"';
+      }
+      writer.write( "}\n", 2 );
+      break;
+    default:
+      writer << directory << '\t';
+      if ( newest != nullptr ) {
+        char text[FORMAT::ISO_TIME_LENGTH];
+        FORMAT::FormatIsoTime( newest->time, text );
+        writer.write( text, sizeof( text ) );
+        writer << '\t' << newest->name() << '\n';
+      } else {
+        // その下にエントリが一つも無い
+        writer.write( "-\t\n", 3 );
+      }
+      break;
+  }
+}
+
+// --group-byの出力。keyはエントリが属するグループ。
+template<typename Writer>
+void WriteGroupEntry( Writer & writer, std::string_view const key, Entry const & entry, Format const format ) {
+  switch ( format ) {
+    case Format::NUL:
+      writer << key << '\0' << entry.path << '\0';
+      break;
+    case Format::JSON:
+      writer.write( "{\"group\":", 9 );
+      FORMAT::WriteJsonString( writer, key );
+      writer.write( ",\"path\":", 8 );
+      FORMAT::WriteJsonString( writer, entry.path );
+      writer << ",\"time\":" << entry.time.ns() << ",\"size\":" << entry.size << ",\"type\":\"" << EntryTypeName( entry.type ) << "\"}\n";
+      break;
+    default:
+      writer << key << '\t' << entry.name() << '\n';
+      break;
+  }
+}
+
+} // lfl
@@ -0,0 +1,222 @@
+/****************************************
+ * lfl/Frontier.hpp
+ *
+ * 読み込み待ちのディレクトリ(走査の最前線)を保持する。
+ *
+ * 読み込み待ちのディレクトリは、横に広い木では際限なく増えていく。
+ * ディレクトリごとにstd::stringでパスを持つと、一つあたり
+ * sizeof( DirectoryJob ) + パスの長さ を使うので、
+ * 保持している量が上限(memory_cap)を超えたら、
+ * 同じディレクトリで見つかったサブディレクトリをまとめて
+ *   親ディレクトリのパス(一つだけ) + '\0'で区切った名前の並び
+ * に詰めて保持する(退避)。取り出すときに一つずつパスを組み立て直す。
+ ****************************************/
+#pragma once
+
+#include "lfl/Exclude.hpp"
+#include "lfl/Scanner.hpp"
+#include "lfl/Time.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace lfl {
+
+struct DirectoryJob {
+  // 区切り文字で終わるディレクトリのパス
+  std::string path;
+  std::uint32_t root_length;
+  // 起点を0とした深さ
+  std::uint32_t depth;
+  // 起点のボリュームのシリアル番号(--xdevのときだけ使う)
+  std::uint64_t volume;
+  // ディレクトリ自身の更新時刻(最良優先のときだけ使う)
+  Time priority;
+  // このディレクトリに適用する.gitignoreの規則(--gitignoreのときだけ使う)
+  std::shared_ptr<IgnoreScope const> ignore;
+  // 何番目の起点の下にあるか(--per-rootのときだけ使う)
+  std::uint32_t root = 0;
+};
+
+// 最良優先のヒープで、更新時刻が新しいものを先頭にする。
+struct OlderDirectory {
+  bool operator()( DirectoryJob const & lhs, DirectoryJob const & rhs ) const noexcept { return lhs.priority < rhs.priority; }
+};
+
+/****************************************
+ * 取り出す順序は、展開されているものが先で、
+ * 深さ優先・幅優先では後に積んだものから、最良優先では更新時刻の新しいものから。
+ * 退避したものは、展開されているものがなくなってから後に退避したものから取り出す。
+ * そのため最良優先でも、退避したディレクトリは展開されているものより後回しになる。
+ ****************************************/
+class Frontier {
+public:
+  Frontier( TraversalOrder const order, std::size_t const memory_cap ) : order_( order ), memory_cap_( memory_cap ) {}
+
+  // 上限に関わらず展開して積む(走査の起点用)。
+  void push( DirectoryJob && job ) {
+    expanded_bytes_ += jobBytes( job );
+    jobs_.emplace_back( std::move( job ) );
+    if ( order_ == TraversalOrder::BEST ) { std::push_heap( jobs_.begin(), jobs_.end(), OlderDirectory() ); }
+    ++size_;
+  }
+
+  // 同じディレクトリで見つかったサブディレクトリをまとめて積む。siblingsは空になる。
+  void push( std::vector<DirectoryJob> & siblings ) {
+    if ( siblings.empty() ) { return; }
+
+    std::size_t incoming = 0;
+    for ( auto const & itr : siblings ) { incoming += jobBytes( itr ); }
+
+    if ( memory_cap_ < memoryUsage() + incoming ) {
+      spill( siblings );
+    } else {
+      for ( auto & itr : siblings ) { push( std::move( itr ) ); }
+    }
+
+    siblings.clear();
+  }
+
+  bool pop( DirectoryJob & job ) {
+    if ( !jobs_.empty() ) {
+      if ( order_ == TraversalOrder::BEST ) { std::pop_heap( jobs_.begin(), jobs_.end(), OlderDirectory() ); }
+
+      job = std::move( jobs_.back() );
+      jobs_.pop_back();
+      expanded_bytes_ -= jobBytes( job );
+      --size_;
+      return true;
+    }
+
+    if ( groups_.empty() ) { return false; }
+
+    Group & group = groups_.back();
+    std::size_t const name_length = group.names.find( '\0', group.cursor ) - group.cursor;
+
+    job.path.reserve( group.parent.size() + name_length + 1 );
+    job.path.assign( group.parent ).append( group.names, group.cursor, name_length ).append( 1, DELIMITER );
+    job.root_length = group.root_length;
+    job.depth = group.depth;
+    job.volume = group.volume;
+    job.priority = group.priorities.empty() ? Time::Min() : group.priorities[group.index];
+    job.ignore = group.ignore;
+    job.root = group.root;
+
+    group.cursor += name_length + 1;
+    ++group.index;
+    --size_;
+
+    if ( group.cursor == group.names.size() ) {
+      spilled_bytes_ -= groupBytes( group );
+      groups_.pop_back();
+    }
+
+    return true;
+  }
+
+  // 保持しているディレクトリを一つずつfunction( DirectoryJob const & )に渡す(--checkpoint)。
+  // 展開されているものを先に、退避したものは同じ親の兄弟が続くように渡す。順序は取り出す順とは限らない。
+  template<typename Function>
+  void forEach( Function && function ) const {
+    for ( auto const & itr : jobs_ ) { function( itr ); }
+
+    DirectoryJob job;
+    for ( auto const & group : groups_ ) {
+      job.root_length = group.root_length;
+      job.depth = group.depth;
+      job.volume = group.volume;
+      job.ignore = group.ignore;
+      job.root = group.root;
+
+      std::size_t index = group.index;
+      for ( std::size_t cursor = group.cursor; cursor < group.names.size(); ++index ) {
+        std::size_t const name_length = group.names.find( '\0', cursor ) - cursor;
+        job.path.assign( group.parent ).append( group.names, cursor, name_length ).append( 1, DELIMITER );
+        job.priority = group.priorities.empty() ? Time::Min() : group.priorities[index];
+        function( job );
+
+        cursor += name_length + 1;
+      }
+    }
+  }
+
+  bool empty() const noexcept { return size_ == 0; }
+  std::size_t size() const noexcept { return size_; }
+  // 保持しているディレクトリが使っているおおよそのバイト数
+  std::size_t memoryUsage() const noexcept { return expanded_bytes_ + spilled_bytes_; }
+  // 退避しているディレクトリの数
+  std::size_t spilledSize() const noexcept { return size_ - jobs_.size(); }
+private:
+  struct Group {
+    // 区切り文字で終わる親ディレクトリのパス
+    std::string parent;
+    // '\0'で区切ったサブディレクトリの名前の並び(最後も'\0'で終わる)
+    std::string names;
+    // 最良優先のときだけ、名前の並びと同じ順に更新時刻を持つ。
+    std::vector<Time> priorities;
+    std::size_t cursor = 0;
+    std::size_t index = 0;
+    std::uint32_t root_length;
+    std::uint32_t depth;
+    std::uint64_t volume;
+    // 兄弟は同じ親の規則を持つので、一つだけ持てばよい。
+    std::shared_ptr<IgnoreScope const> ignore;
+    std::uint32_t root;
+  };
+
+  TraversalOrder order_;
+  std::size_t memory_cap_;
+  std::vector<DirectoryJob> jobs_;
+  std::vector<Group> groups_;
+  std::size_t size_ = 0;
+  std::size_t expanded_bytes_ = 0;
+  std::size_t spilled_bytes_ = 0;
+
+  static std::size_t jobBytes( DirectoryJob const & job ) noexcept {
+    // 短いパスはstd::stringの中に収まるので、capacityだけ数えれば足りる。
+    return sizeof( DirectoryJob ) + job.path.capacity();
+  }
+
+  static std::size_t groupBytes( Group const & group ) noexcept {
+    return sizeof( Group ) + group.parent.capacity() + group.names.capacity() + group.priorities.capacity() * sizeof( Time );
+  }
+
+  void spill( std::vector<DirectoryJob> & siblings ) {
+    // 兄弟のパスは「親のパス + 名前 + 区切り文字」なので、
+    // 最後から2番目の区切り文字までが共通の親のパスになる。
+    std::string const & first = siblings.front().path;
+    std::size_t const parent_length = first.rfind( DELIMITER, first.size() - 2 ) + 1;
+
+    Group group;
+    group.parent.assign( first, 0, parent_length );
+    group.root_length = siblings.front().root_length;
+    group.depth = siblings.front().depth;
+    group.volume = siblings.front().volume;
+    group.ignore = siblings.front().ignore;
+    group.root = siblings.front().root;
+
+    std::size_t names_length = 0;
+    for ( auto const & itr : siblings ) { names_length += itr.path.size() - parent_length; }
+    group.names.reserve( names_length );
+
+    for ( auto const & itr : siblings ) {
+      group.names.append( itr.path, parent_length, itr.path.size() - parent_length - 1 ).append( 1, '\0' );
+    }
+
+    if ( order_ == TraversalOrder::BEST ) {
+      group.priorities.reserve( siblings.size() );
+      for ( auto const & itr : siblings ) { group.priorities.emplace_back( itr.priority ); }
+    }
+
+    spilled_bytes_ += groupBytes( group );
+    size_ += siblings.size();
+    groups_.emplace_back( std::move( group ) );
+  }
+};
+
+} // lfl
@@ -0,0 +1,163 @@
+/****************************************
+ * lfl/Group.hpp
+ *
+ * --group-by: グループ(拡張子、所有者、起点の直下のディレクトリ)ごとの最新のファイルを、一度の走査で求める。
+ *
+ * スレッドごとに、グループのキーから上位count件(TopK)へのハッシュ表を持ち、
+ * 走査が終わってから併合する。ハッシュ表はオープンアドレス法(線形探索)で、
+ * エントリごとには、キーのハッシュ値を求めて配列を数か所見るだけで済む。
+ *
+ * 拡張子と直下のディレクトリは、名前とディレクトリのパスから切り出すだけで求まる。
+ * 所有者だけは問い合わせが必要なので、指定されたときだけ走査がFoundEntry::ownerに入れる。
+ * キーの大文字と小文字は区別しない(拡張子は小文字にそろえて出力する)。
+ ****************************************/
+#pragma once
+
+#include "jig.hpp"
+#include "lfl/Entry.hpp"
+#include "lfl/Filter.hpp"
+#include "lfl/Sink.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace lfl {
+
+enum class GroupBy : std::uint8_t {
+  // グループに分けない
+  NONE,
+  // 拡張子(最後の'.'より後。無ければ空)
+  EXT,
+  // 所有者
+  OWNER,
+  // 起点の直下のディレクトリ(起点の直下のエントリは".")
+  DIR1,
+  NUM
+};
+
+STATIC_CONSTEXPR char const * GROUP_BY_NAMES[] = { "none", "ext", "owner", "dir1" };
+static_assert( jig::ArraySize( GROUP_BY_NAMES ) == static_cast<jig::size_type>( GroupBy::NUM ), "GROUP_BY_NAMES and GroupBy are mismatched" );
+
+namespace GROUP {
+
+// ハッシュ表の最初の大きさ(2のべき乗)
+STATIC_CONSTEXPR std::size_t INITIAL_SLOTS = 64;
+
+// ".bashrc"のように先頭にしか'.'が無い名前は、拡張子が無いものとする。
+constexpr std::string_view ExtensionKey( std::string_view const name ) noexcept {
+  std::size_t const dot = name.rfind( '.' );
+  return ( dot == std::string_view::npos || dot == 0 ) ? std::string_view() : name.substr( dot + 1 );
+}
+
+// --from-stdinのパスは起点が空で、名前の中に区切り文字がある。
+constexpr std::string_view TopDirectoryKey( DirectoryContext const & directory, std::string_view const name ) noexcept {
+  std::string_view const relative = std::string_view( directory.path ).substr( directory.root_length );
+  std::string_view const path = relative.empty() ? name : relative;
+
+  std::size_t const separator = path.find_first_of( "\\/" );
+  return ( separator == std::string_view::npos ) ? std::string_view( "." ) : path.substr( 0, separator );
+}
+
+constexpr std::string_view GroupKey( GroupBy const group_by, DirectoryContext const & directory, FoundEntry const & found ) noexcept {
+  switch ( group_by ) {
+    case GroupBy::EXT: return ExtensionKey( found.name );
+    case GroupBy::OWNER: return found.owner;
+    case GroupBy::DIR1: return TopDirectoryKey( directory, found.name );
+    default: return std::string_view();
+  }
+}
+
+} // GROUP
+
+/****************************************
+ * グループごとに、新しいものから上位count件だけを保持する。
+ ****************************************/
+class GroupedTopK final : public Sink {
+public:
+  struct Group {
+    std::string key;
+    TopK top;
+  };
+
+  GroupedTopK( GroupBy const group_by, std::size_t const count ) : group_by_( group_by ), count_( count ), slots_( GROUP::INITIAL_SLOTS ) {}
+
+  void offer( DirectoryContext const & directory, FoundEntry const & found ) override {
+    std::string_view const key = GROUP::GroupKey( group_by_, directory, found );
+    TopK & top = find( key, FILTER::FoldedHash()( key ) ).top;
+
+    // 保持されない時刻なら、パスを組み立てない。
+    if ( top.accepts( found.time ) ) { top.offer( directory, found ); }
+  }
+
+  void merge( GroupedTopK && other ) {
+    for ( auto & itr : other.groups_ ) {
+      Group & group = find( itr.key, FILTER::FoldedHash()( itr.key ) );
+      group.top.merge( std::move( itr.top ) );
+    }
+    other.groups_.clear();
+    std::fill( other.slots_.begin(), other.slots_.end(), Slot{} );
+  }
+
+  // グループをキーの順に並べて取り出す。
+  std::vector<Group> take() {
+    std::sort( groups_.begin(), groups_.end(), []( Group const & lhs, Group const & rhs ){ return lhs.key < rhs.key; } );
+    std::fill( slots_.begin(), slots_.end(), Slot{} );
+    return std::move( groups_ );
+  }
+
+  std::size_t size() const noexcept { return groups_.size(); }
+private:
+  // groups_の添字 + 1(0は空き)と、キーのハッシュ値
+  struct Slot {
+    std::uint64_t hash = 0;
+    std::uint32_t index = 0;
+  };
+
+  GroupBy group_by_;
+  std::size_t count_;
+  std::vector<Slot> slots_;
+  std::vector<Group> groups_;
+
+  // キーのグループを探し、無ければ作る。
+  Group & find( std::string_view const key, std::uint64_t const hash ) {
+    std::size_t const mask = slots_.size() - 1;
+
+    for ( std::size_t position = hash & mask;; position = ( position + 1 ) & mask ) {
+      Slot & slot = slots_[position];
+
+      if ( slot.index == 0 ) {
+        slot = Slot{ hash, static_cast<std::uint32_t>( groups_.size() + 1 ) };
+        Group & group = groups_.emplace_back( Group{ std::string( key ), TopK( count_ ) } );
+        if ( group_by_ == GroupBy::EXT ) { std::transform( group.key.begin(), group.key.end(), group.key.begin(), []( char const c ){ return FILTER::FoldCase( c ); } ); }
+
+        // 使用率が1/2を超えたら広げる。groupはgroups_の中にあるので、広げても参照は変わらない。
+        if ( slots_.size() < groups_.size() * 2 ) { grow(); }
+        return group;
+      }
+
+      if ( slot.hash == hash && FILTER::FoldedEqual()( groups_[slot.index - 1].key, key ) ) { return groups_[slot.index - 1]; }
+    }
+  }
+
+  void grow() {
+    std::vector<Slot> slots( slots_.size() * 2 );
+    std::size_t const mask = slots.size() - 1;
+
+    for ( auto const & itr : slots_ ) {
+      if ( itr.index == 0 ) { continue; }
+
+      std::size_t position = itr.hash & mask;
+      while ( slots[position].index != 0 ) { position = ( position + 1 ) & mask; }
+      slots[position] = itr;
+    }
+
+    slots_ = std::move( slots );
+  }
+};
+
+} // lfl
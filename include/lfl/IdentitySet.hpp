@@ -0,0 +1,79 @@
+/****************************************
+ * lfl/IdentitySet.hpp
+ *
+ * ファイルの実体の識別子((dev, inode)に相当するもの)と、
+ * それを複数のスレッドから登録するための集合。
+ *
+ * Windowsでは、ボリュームのシリアル番号とファイルインデックスの組が
+ * POSIXの(st_dev, st_ino)に相当する。
+ ****************************************/
+#pragma once
+
+#include "jig.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <unordered_set>
+
+namespace lfl {
+
+struct FileIdentity {
+  std::uint64_t volume;
+  std::uint64_t index;
+
+  friend constexpr bool operator==( FileIdentity const & lhs, FileIdentity const & rhs ) noexcept {
+    return ( lhs.volume == rhs.volume ) && ( lhs.index == rhs.index );
+  }
+};
+
+struct FileIdentityHash {
+  std::size_t operator()( FileIdentity const & identity ) const noexcept {
+    // ファイルインデックスは連番に近いので、上位のビットにも散らばるように混ぜる。
+    std::uint64_t hash = ( identity.index ^ ( identity.volume * 0x9E3779B97F4A7C15ULL ) ) * 0xBF58476D1CE4E5B9ULL;
+    return static_cast<std::size_t>( hash ^ ( hash >> 31 ) );
+  }
+};
+
+/****************************************
+ * 複数のスレッドから同時に登録できる集合。
+ *
+ * ハッシュ値で分割した部分集合ごとにロックを持たせて、
+ * 異なる部分集合への登録どうしは待ち合わせないようにしている。
+ ****************************************/
+class ConcurrentIdentitySet {
+public:
+  STATIC_CONSTEXPR std::size_t SHARD_NUM = 64;
+
+  // 初めて登録されたときだけtrueを返す。
+  bool insert( FileIdentity const & identity ) {
+    std::size_t const hash = FileIdentityHash()( identity );
+    Shard & shard = shards_[( hash >> 7 ) % SHARD_NUM];
+
+    std::lock_guard<std::mutex> lock( shard.mutex );
+    return shard.set.insert( identity ).second;
+  }
+
+  std::size_t size() {
+    std::size_t total = 0;
+
+    for ( auto & itr : shards_ ) {
+      std::lock_guard<std::mutex> lock( itr.mutex );
+      total += itr.set.size();
+    }
+
+    return total;
+  }
+private:
+  // 隣り合う部分集合のロックが同じキャッシュラインに乗らないようにする。
+  struct alignas( 64 ) Shard {
+    std::mutex mutex;
+    std::unordered_set<FileIdentity, FileIdentityHash> set;
+  };
+
+  std::array<Shard, SHARD_NUM> shards_;
+};
+
+} // lfl
@@ -0,0 +1,38 @@
+/****************************************
+ * lfl/Input.hpp
+ *
+ * ファイルの読み込み(lfl mergeで部分結果を、--from-stdinでパスの一覧を読むため)。
+ ****************************************/
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace lfl {
+
+namespace INPUT {
+
+// pathのファイルの内容をすべてcontentsに読み込む。pathが"-"なら標準入力から読む。
+// 実際の読み込み(ReadFile)はsrc/Input.cppにある。
+bool ReadAll( std::string const & path, std::string & contents );
+
+// dataをdelimiterで区切り、空でない要素ごとにfunction( record )を呼ぶ。
+// 改行で区切るときは、CRLFの'\r'も取り除く。
+template<typename Function>
+void ForEachRecord( std::string_view data, char const delimiter, Function && function ) {
+  while ( !data.empty() ) {
+    std::size_t const end = data.find( delimiter );
+    std::string_view record = data.substr( 0, end );
+
+    if ( delimiter == '\n' && !record.empty() && record.back() == '\r' ) { record.remove_suffix( 1 ); }
+    if ( !record.empty() ) { function( record ); }
+
+    if ( end == std::string_view::npos ) { break; }
+    data.remove_prefix( end + 1 );
+  }
+}
+
+} // INPUT
+
+} // lfl
@@ -0,0 +1,218 @@
+/****************************************
+ * lfl/MemoryFileSystem.hpp
+ *
+ * メモリ上の木を、走査が読むファイルシステムとして見せる(lfl/FileSystem.hpp)。
+ * ディスクの揺らぎ無しに、並列の走査、打ち切り、速さの制限、再帰をテストし、ベンチマークで測るために使う。
+ *
+ * 走査の前にaddDirectory、addFileなどで木を作り、走査の間は木を変えないので、
+ * 複数のスレッドから同時に呼び出してよい(呼び出しの回数だけは走査の間も数える)。
+ * パスは起点を含めたもの("C:\\root\\a\\x.txt")で、ディレクトリのパスは区切り文字で終わってもよい。
+ * 親のディレクトリは、無ければ同じ時刻で作る。名前はASCIIだけを扱う(UTF-16に一文字ずつ広げる)。
+ * ディレクトリを読むと、実際のNTFSと同じく"."と".."から始まり、加えた順にエントリが並ぶ。
+ *
+ * 遅延(setLatency): すべての呼び出しに一定の時間をかけさせる(遠いディスクやネットワーク越しの遅さ)。
+ * 障害(inject): あるパスへの呼び出しを失敗させる。
+ *   ACCESS_DENIED: 開くことと中身を読むことはできないが、属性は親のディレクトリから見える。
+ *   NOT_FOUND: 親のディレクトリには載っているが、走査が辿り着く前に消されている。
+ *   afterを指定すると、ディレクトリはafter回の読み込みに成功してから失敗する(読んでいる途中で消された)。
+ *
+ * FILE_FULL_DIR_INFOの並びの書き込み(Windows APIの型)はsrc/MemoryFileSystem.cppにある。
+ ****************************************/
+#pragma once
+
+#include "jig.hpp"
+#include "lfl/Entry.hpp"
+#include "lfl/FileSystem.hpp"
+#include "lfl/Time.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace lfl {
+
+enum class Fault : std::uint8_t {
+  ACCESS_DENIED,
+  NOT_FOUND
+};
+
+class MemoryFileSystem final : public FileSystem {
+public:
+  // 呼び出しの回数(走査が発行したI/Oの数を確かめるため)
+  struct Counters {
+    std::uint64_t opens = 0;
+    std::uint64_t reads = 0;
+    std::uint64_t queries = 0;
+  };
+
+  MemoryFileSystem() = default;
+  MemoryFileSystem( MemoryFileSystem const & ) = delete;
+  MemoryFileSystem & operator=( MemoryFileSystem const & ) = delete;
+
+  void addDirectory( std::string_view const path, Time const time = Time( 0 ) ) { add( path, time, Node::DIRECTORY, 0 ); }
+  void addFile( std::string_view const path, Time const time, std::uint64_t const size = 0 ) { add( path, time, Node::NORMAL, size ); }
+  // 中身を読めるファイル(.gitignoreなど)
+  void addFile( std::string_view const path, Time const time, std::string_view const contents ) { nodes_[add( path, time, Node::NORMAL, contents.size() )].contents.assign( contents ); }
+
+  // targetを指すシンボリックリンク。targetがその時点でディレクトリなら、ディレクトリへのリンクになる。
+  void addSymlink( std::string_view const path, std::string_view const target, Time const time = Time( 0 ) ) {
+    Node const * const pointee = find( target );
+    std::size_t const index = add( path, time, ( ( pointee != nullptr ) && ( pointee->attributes & Node::DIRECTORY ) ) ? ( Node::DIRECTORY | Node::REPARSE_POINT ) : Node::REPARSE_POINT, 0 );
+    nodes_[index].target.assign( normalize( target ) );
+  }
+
+  // existingと同じ実体を指す、もう一つの名前
+  void addHardLink( std::string_view const path, std::string_view const existing ) {
+    std::size_t const index = paths_.at( std::string( normalize( existing ) ) );
+    ++nodes_[index].links;
+    link( path, index, Time( 0 ) );
+  }
+
+  void setLatency( std::chrono::nanoseconds const latency ) noexcept { latency_ = latency; }
+  void inject( std::string_view const path, Fault const fault, std::size_t const after = 0 ) { faults_[std::string( normalize( path ) )] = Injection{ fault, after }; }
+
+  Counters counters() const noexcept { return Counters{ opens_.load(), reads_.load(), queries_.load() }; }
+
+  void * openDirectory( std::string const & path ) override;
+  ReadStatus readDirectory( void * directory, void * buffer, std::uint32_t size ) override;
+  void closeDirectory( void * directory ) noexcept override;
+  bool queryInformation( std::string const & path, FileInformation & information ) override;
+  bool queryAttributes( std::string const & path, FileInformation & information ) override;
+  bool readFile( std::string const & path, std::string & contents ) override;
+private:
+  struct Node {
+    // FILE_ATTRIBUTE_*と同じ値
+    static constexpr std::uint32_t DIRECTORY = 0x10;
+    static constexpr std::uint32_t NORMAL = 0x80;
+    static constexpr std::uint32_t REPARSE_POINT = 0x400;
+
+    std::uint32_t attributes = NORMAL;
+    // 実体の番号(ハードリンクどうしは同じ)。nodes_の位置 + 1
+    std::uint64_t id = 0;
+    // FILETIME(1601-01-01からの100ナノ秒単位)
+    std::uint64_t time = 0;
+    std::uint64_t size = 0;
+    std::uint32_t links = 1;
+    std::string contents;
+    // シンボリックリンクの指す先
+    std::string target;
+    // ディレクトリのエントリ(名前、nodes_の位置)
+    std::vector<std::pair<std::string, std::size_t>> children;
+  };
+
+  struct Injection {
+    Fault fault;
+    std::size_t after;
+  };
+
+  // 開いているディレクトリ。openDirectoryが作り、closeDirectoryが消す。
+  struct Cursor {
+    Node const * directory;
+    Injection const * injection;
+    // 次に書くエントリ("."と".."を含めた位置)
+    std::size_t position = 0;
+    std::size_t reads = 0;
+  };
+
+  // すべてのノードが載っているボリュームのシリアル番号
+  static constexpr std::uint32_t VOLUME = 1;
+  // リンクをたどる回数の上限(循環するリンクで止まるため)
+  static constexpr int MAX_LINK_DEPTH = 32;
+  // sleep_forは短い時間を刻めない(Windowsでは十数ミリ秒)ので、これより短い遅延は待ち続ける。
+  static constexpr std::chrono::microseconds SPIN_LIMIT{ 1000 };
+
+  // ノードは消さないので、dequeの要素への参照は木を作り終えた後も有効。
+  std::deque<Node> nodes_;
+  std::unordered_map<std::string, std::size_t> paths_;
+  std::unordered_map<std::string, Injection> faults_;
+  std::chrono::nanoseconds latency_{ 0 };
+  std::atomic<std::uint64_t> opens_{ 0 };
+  std::atomic<std::uint64_t> reads_{ 0 };
+  std::atomic<std::uint64_t> queries_{ 0 };
+
+  // 末尾の区切り文字を除いたものをキーにする。
+  static std::string_view normalize( std::string_view path ) noexcept {
+    while ( !path.empty() && path.back() == DELIMITER ) { path.remove_suffix( 1 ); }
+    return path;
+  }
+
+  static std::uint64_t toFileTime( Time const time ) noexcept { return static_cast<std::uint64_t>( time.ns() / Time::TICK_NS ) + Time::FILETIME_UNIX_EPOCH; }
+
+  Node const * find( std::string_view const path ) const {
+    auto const itr = paths_.find( std::string( normalize( path ) ) );
+    return ( itr == paths_.end() ) ? nullptr : &nodes_[itr->second];
+  }
+
+  Injection const * faultOf( std::string_view const path ) const {
+    if ( faults_.empty() ) { return nullptr; }
+
+    auto const itr = faults_.find( std::string( normalize( path ) ) );
+    return ( itr == faults_.end() ) ? nullptr : &itr->second;
+  }
+
+  std::size_t add( std::string_view const path, Time const time, std::uint32_t const attributes, std::uint64_t const size ) {
+    std::string const key( normalize( path ) );
+    auto const itr = paths_.find( key );
+
+    std::size_t index = 0;
+    if ( itr != paths_.end() ) {
+      index = itr->second;
+    } else {
+      index = nodes_.size();
+      nodes_.emplace_back().id = index + 1;
+      link( key, index, time );
+    }
+
+    Node & node = nodes_[index];
+    node.attributes = attributes;
+    node.time = toFileTime( time );
+    node.size = size;
+    return index;
+  }
+
+  // pathの名前で、親のディレクトリからindexのノードを指す。
+  // 無い親はtimeの時刻で作る(ドライブの"C:"も一つのディレクトリとして扱う)。
+  void link( std::string_view const path, std::size_t const index, Time const time ) {
+    std::string const key( normalize( path ) );
+    paths_[key] = index;
+
+    std::size_t const separator = key.rfind( DELIMITER );
+    if ( separator == std::string::npos ) { return; }
+
+    std::string const parent_key = key.substr( 0, separator );
+    auto const parent = paths_.find( parent_key );
+    std::size_t const parent_index = ( parent != paths_.end() ) ? parent->second : add( parent_key, time, Node::DIRECTORY, 0 );
+    nodes_[parent_index].children.emplace_back( key.substr( separator + 1 ), index );
+  }
+
+  // pathがリンクならたどった先のノード。無ければnullptr
+  Node const * resolve( std::string_view const path ) const {
+    Node const * node = find( path );
+    for ( int depth = 0; node != nullptr && ( node->attributes & Node::REPARSE_POINT ); ++depth ) {
+      if ( MAX_LINK_DEPTH <= depth ) { return nullptr; }
+      node = find( node->target );
+    }
+    return node;
+  }
+
+  void delay() const {
+    if ( latency_.count() == 0 ) { return; }
+
+    auto const until = std::chrono::steady_clock::now() + latency_;
+    if ( latency_ < SPIN_LIMIT ) {
+      while ( std::chrono::steady_clock::now() < until ) { std::this_thread::yield(); }
+    } else {
+      std::this_thread::sleep_until( until );
+    }
+  }
+};
+
+} // lfl
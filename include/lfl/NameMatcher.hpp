@@ -0,0 +1,186 @@
+/****************************************
+ * lfl/NameMatcher.hpp
+ *
+ * --nameのパターンを、ディレクトリを読んだバッファの中の名前(UTF-16)のまま照合する。
+ *
+ * 「最新の*.logを探す」のように、ほとんどのエントリが名前だけで外れる使い方では、
+ * 外れるエントリの名前をANSIコードページに変換するのが無駄になる。
+ * そこで、よく使う形のパターン(ASCIIだけの、完全一致・前方一致・後方一致・部分一致)は、
+ * 変換する前にSSE2で8文字ずつまとめて比べる。
+ * すべてのパターンが照合できる形でなければ使わない(Filter::matchNameで照合する)。
+ *
+ * 後方一致は名前の末尾から8文字分を、前方一致と部分一致は名前の終わりを越えて8文字分を読む。
+ * FILE_FULL_DIR_INFOでは名前の前に構造体の先頭部分があり、
+ * バッファの最後にはWIDE_MATCH_PADDINGの余白を取るので、どちらもバッファの外には出ない。
+ ****************************************/
+#pragma once
+
+#include "jig.hpp"
+#include "lfl/Filter.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#if defined( __SSE2__ )
+#include <emmintrin.h>
+#endif
+
+namespace lfl {
+
+// 一度に比べるUTF-16の文字数
+STATIC_CONSTEXPR std::size_t WIDE_LANES = 8;
+// 名前の終わりを越えて読む可能性のあるバイト数
+STATIC_CONSTEXPR std::size_t WIDE_MATCH_PADDING = WIDE_LANES * sizeof( char16_t );
+
+namespace FILTER {
+
+constexpr char16_t FoldCase( char16_t const c ) noexcept { return ( u'A' <= c && c <= u'Z' ) ? static_cast<char16_t>( c - u'A' + u'a' ) : c; }
+
+#if defined( __SSE2__ )
+// 'A'から'Z'だけに0x20を足す。0x8000以上の文字は符号付きの比較で負になるので、変わらない。
+inline __m128i FoldCase( __m128i const chars ) noexcept {
+  __m128i const is_upper = _mm_and_si128( _mm_cmpgt_epi16( chars, _mm_set1_epi16( u'A' - 1 ) ), _mm_cmplt_epi16( chars, _mm_set1_epi16( u'Z' + 1 ) ) );
+  return _mm_add_epi16( chars, _mm_and_si128( is_upper, _mm_set1_epi16( 0x20 ) ) );
+}
+
+inline __m128i LoadWide( char16_t const * const chars ) noexcept { return _mm_loadu_si128( reinterpret_cast<__m128i const *>( chars ) ); }
+#endif
+
+} // FILTER
+
+class WideNameMatcher {
+public:
+  WideNameMatcher() = default;
+
+  explicit WideNameMatcher( std::vector<FILTER::NamePattern> const & patterns ) {
+    for ( auto const & itr : patterns ) {
+      if ( !isSupported( itr ) ) {
+        fixed_.clear();
+        contains_.clear();
+        return;
+      }
+
+      if ( itr.kind == FILTER::PatternKind::CONTAINS ) {
+        contains_.emplace_back( std::u16string( itr.literal.begin(), itr.literal.end() ) );
+        continue;
+      }
+
+      // パターンの文字を置くレーンと、比べるレーンのマスクを作っておく。
+      // 後方一致(と完全一致)は末尾のレーンに、前方一致は先頭のレーンに置く。
+      Fixed fixed{ itr.kind, static_cast<std::uint32_t>( itr.literal.size() ), {}, {} };
+      std::size_t const offset = ( itr.kind == FILTER::PatternKind::PREFIX ) ? 0 : WIDE_LANES - itr.literal.size();
+      for ( std::size_t index = 0; index < itr.literal.size(); ++index ) {
+        fixed.chars[offset + index] = static_cast<std::uint16_t>( itr.literal[index] );
+        fixed.mask[offset + index] = 0xFFFF;
+      }
+      fixed_.emplace_back( fixed );
+    }
+
+    is_enabled_ = !patterns.empty();
+  }
+
+  // パターンが無いか、照合できない形のパターンがあれば使えない。
+  bool isEnabled() const noexcept { return is_enabled_; }
+
+  bool match( char16_t const * const name, std::size_t const length ) const noexcept {
+#if defined( __SSE2__ )
+    if ( !fixed_.empty() ) {
+      // 先頭と末尾の8文字は、パターンの数によらず一度だけ読む。
+      __m128i const head = FILTER::FoldCase( FILTER::LoadWide( name ) );
+      __m128i const tail = FILTER::FoldCase( FILTER::LoadWide( name + length - WIDE_LANES ) );
+
+      for ( auto const & itr : fixed_ ) {
+        if ( length < itr.length || ( itr.kind == FILTER::PatternKind::EXACT && length != itr.length ) ) { continue; }
+
+        __m128i const chars = ( itr.kind == FILTER::PatternKind::PREFIX ) ? head : tail;
+        __m128i const masked = _mm_and_si128( chars, _mm_loadu_si128( reinterpret_cast<__m128i const *>( itr.mask ) ) );
+        if ( _mm_movemask_epi8( _mm_cmpeq_epi16( masked, _mm_loadu_si128( reinterpret_cast<__m128i const *>( itr.chars ) ) ) ) == 0xFFFF ) { return true; }
+      }
+    }
+#else
+    for ( auto const & itr : fixed_ ) {
+      if ( length < itr.length || ( itr.kind == FILTER::PatternKind::EXACT && length != itr.length ) ) { continue; }
+
+      std::size_t const begin = ( itr.kind == FILTER::PatternKind::PREFIX ) ? 0 : length - itr.length;
+      std::size_t const offset = ( itr.kind == FILTER::PatternKind::PREFIX ) ? 0 : WIDE_LANES - itr.length;
+      bool is_match = true;
+      for ( std::size_t index = 0; is_match && index < itr.length; ++index ) { is_match = ( FILTER::FoldCase( name[begin + index] ) == itr.chars[offset + index] ); }
+      if ( is_match ) { return true; }
+    }
+#endif
+
+    for ( auto const & itr : contains_ ) {
+      if ( contains( name, length, itr ) ) { return true; }
+    }
+
+    return false;
+  }
+private:
+  struct Fixed {
+    FILTER::PatternKind kind;
+    std::uint32_t length;
+    std::uint16_t chars[WIDE_LANES];
+    std::uint16_t mask[WIDE_LANES];
+  };
+
+  std::vector<Fixed> fixed_;
+  std::vector<std::u16string> contains_;
+  bool is_enabled_ = false;
+
+  static bool isSupported( FILTER::NamePattern const & pattern ) noexcept {
+    if ( pattern.kind == FILTER::PatternKind::GLOB ) { return false; }
+    if ( pattern.kind != FILTER::PatternKind::CONTAINS && WIDE_LANES < pattern.literal.size() ) { return false; }
+    if ( pattern.kind == FILTER::PatternKind::CONTAINS && pattern.literal.empty() ) { return false; }
+
+    // ANSIコードページの文字は、変換しないとUTF-16と比べられない。
+    for ( char const c : pattern.literal ) {
+      if ( static_cast<unsigned char>( c ) >= 0x80 ) { return false; }
+    }
+
+    return true;
+  }
+
+  // 最初と最後の文字が一致する位置を8か所ずつまとめて探し、見つかった位置だけ残りを比べる。
+  static bool contains( char16_t const * const name, std::size_t const length, std::u16string const & literal ) noexcept {
+    std::size_t const literal_length = literal.size();
+    if ( length < literal_length ) { return false; }
+
+    std::size_t const last_begin = length - literal_length;
+    auto const matchesAt = [ & ]( std::size_t const begin ) {
+      for ( std::size_t index = 1; index + 1 < literal_length; ++index ) {
+        if ( FILTER::FoldCase( name[begin + index] ) != literal[index] ) { return false; }
+      }
+      return true;
+    };
+
+#if defined( __SSE2__ )
+    __m128i const first = _mm_set1_epi16( static_cast<short>( literal.front() ) );
+    __m128i const last = _mm_set1_epi16( static_cast<short>( literal.back() ) );
+
+    for ( std::size_t begin = 0; begin <= last_begin; begin += WIDE_LANES ) {
+      __m128i const heads = FILTER::FoldCase( FILTER::LoadWide( name + begin ) );
+      __m128i const tails = FILTER::FoldCase( FILTER::LoadWide( name + begin + literal_length - 1 ) );
+      unsigned bits = static_cast<unsigned>( _mm_movemask_epi8( _mm_and_si128( _mm_cmpeq_epi16( heads, first ), _mm_cmpeq_epi16( tails, last ) ) ) );
+
+      // 1文字につき2ビット立つ。
+      while ( bits != 0 ) {
+        std::size_t const candidate = begin + static_cast<std::size_t>( __builtin_ctz( bits ) ) / 2;
+        if ( last_begin < candidate ) { break; }
+        if ( matchesAt( candidate ) ) { return true; }
+        bits &= bits - 1;
+        bits &= bits - 1;
+      }
+    }
+#else
+    for ( std::size_t begin = 0; begin <= last_begin; ++begin ) {
+      if ( FILTER::FoldCase( name[begin] ) == literal.front() && FILTER::FoldCase( name[begin + literal_length - 1] ) == literal.back() && matchesAt( begin ) ) { return true; }
+    }
+#endif
+
+    return false;
+  }
+};
+
+} // lfl
@@ -0,0 +1,185 @@
+/****************************************
+ * lfl/Output.hpp
+ *
+ * 標準出力・標準エラー出力のための、バッファ付きの書き出し層。
+ *
+ * std::endlは一行ごとにフラッシュ(=書き込みのシステムコール)を発生させる。
+ * 一覧表示のように大量の行を出力する場合はそれが支配的なコストになるので、
+ * 大きなバッファに溜めて、まとめて書き出すようにする。
+ * フラッシュするのは、バッファが一杯になったときと、明示的にflush()したときだけ。
+ * capture()しておくと、書き出した内容を文字列にも写す(--cacheで結果を保存するため)。
+ ****************************************/
+#pragma once
+
+#include "jig.hpp"
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace lfl {
+
+namespace OUTPUT {
+
+// ハンドル(HANDLE)にsizeバイトをすべて書き終えるまで繰り返す。失敗したらfalseを返す。
+// 標準出力のほか、--checkpointのファイルにも使う。実際の書き込み(WriteFile)はsrc/Output.cppにある。
+bool WriteAll( void * handle, char const * data, std::size_t size ) noexcept;
+
+// 書き出し先。実際の書き込み(WriteFile)はsrc/Output.cppにある。
+class StdDevice {
+public:
+  enum class Channel {
+    OUT,
+    ERR
+  };
+
+  explicit constexpr StdDevice( Channel const channel ) noexcept : channel_( channel ) {}
+
+  // sizeバイトをすべて書き終えるまで繰り返す。失敗したらfalseを返す。
+  bool write( char const *, std::size_t ) const noexcept;
+  // ANSIコードページの文字列(パス)をUTF-8にしてbufferに置き、それを返す(--json)。変換できなければそのまま返す。
+  static std::string_view toUtf8( std::string_view, std::string & buffer );
+private:
+  Channel channel_;
+};
+
+// テスト用に、書き出した内容を文字列に溜める書き出し先
+class StringDevice {
+public:
+  bool write( char const * data, std::size_t size ) { str_.append( data, size ); ++write_count_; return true; }
+
+  std::string const & str() const noexcept { return str_; }
+  std::size_t writeCount() const noexcept { return write_count_; }
+private:
+  std::string str_;
+  std::size_t write_count_ = 0;
+};
+
+template<class Device, std::size_t BUFFER_SIZE>
+class BasicWriter {
+public:
+  static_assert( BUFFER_SIZE > 0, "BUFFER_SIZE must be greater than 0" );
+
+  template<typename... Args>
+  explicit constexpr BasicWriter( Args&& ... args ) : device_( std::forward<Args>( args )... ), used_( 0 ), good_( true ), capture_( nullptr ), capture_limit_( 0 ) {}
+  ~BasicWriter() { flush(); }
+
+  BasicWriter( BasicWriter const & ) = delete;
+  BasicWriter & operator=( BasicWriter const & ) = delete;
+
+  void write( char const * data, std::size_t size ) {
+    if ( size <= ( BUFFER_SIZE - used_ ) ) {
+      std::memcpy( buffer_ + used_, data, size );
+      used_ += size;
+      return;
+    }
+
+    flush();
+
+    // バッファより大きな塊は、コピーせずにそのまま書き出す。
+    if ( size >= BUFFER_SIZE ) {
+      copyToCapture( data, size );
+      good_ = device_.write( data, size ) && good_;
+    } else {
+      std::memcpy( buffer_, data, size );
+      used_ = size;
+    }
+  }
+
+  void put( char const one_char ) {
+    if ( used_ == BUFFER_SIZE ) { flush(); }
+    buffer_[used_++] = one_char;
+  }
+
+  void flush() {
+    if ( used_ == 0 ) { return; }
+
+    copyToCapture( buffer_, used_ );
+    good_ = device_.write( buffer_, used_ ) && good_;
+    used_ = 0;
+  }
+
+  // これから書き出す内容をtargetにも追記する。写すのはフラッシュのときだけなので、一行ごとの手間は増えない。
+  // 合わせてlimitバイトを超えたら、写すのをやめてtargetを空にする(isCapturing()がfalseになる)。
+  void capture( std::string * const target, std::size_t const limit ) noexcept {
+    capture_ = target;
+    capture_limit_ = limit;
+  }
+  bool isCapturing() const noexcept { return capture_ != nullptr; }
+
+  // 書き込みが一度でも失敗していたらfalse(パイプが閉じられた場合など)
+  bool good() const noexcept { return good_; }
+  Device const & device() const noexcept { return device_; }
+
+  // パス(ANSIコードページ)をUTF-8にする。書き出し先が変換を持たなければ(StringDevice)、そのまま返す。
+  // 返す文字列は、次にtoUtf8()を呼ぶまで使える。
+  std::string_view toUtf8( std::string_view const str ) {
+    if constexpr ( requires { Device::toUtf8( str, utf8_ ); } ) {
+      return Device::toUtf8( str, utf8_ );
+    } else {
+      return str;
+    }
+  }
+
+  BasicWriter & operator<<( std::string_view const str ) { write( str.data(), str.size() ); return *this; }
+  BasicWriter & operator<<( char const * str ) { write( str, std::strlen( str ) ); return *this; }
+  BasicWriter & operator<<( char const one_char ) { put( one_char ); return *this; }
+
+  template<typename Integer, UTIL::if_nullp_c<std::is_integral_v<Integer> && !std::is_same_v<Integer, char> && !std::is_same_v<Integer, bool>>* = nullptr>
+  BasicWriter & operator<<( Integer const value ) {
+    char digits[24];
+    auto const result = std::to_chars( digits, digits + sizeof( digits ), value );
+    write( digits, result.ptr - digits );
+    return *this;
+  }
+
+  template<typename CharT, jig::size_type N>
+  BasicWriter & operator<<( jig::STRING::Literal<CharT, N> const & literal ) { write( literal.get(), literal.length() ); return *this; }
+private:
+  Device device_;
+  std::size_t used_;
+  bool good_;
+  std::string * capture_;
+  std::size_t capture_limit_;
+  std::string utf8_;
+  char buffer_[BUFFER_SIZE];
+
+  void copyToCapture( char const * data, std::size_t const size ) {
+    if ( capture_ == nullptr ) { return; }
+
+    if ( capture_limit_ - capture_->size() < size ) {
+      capture_->clear();
+      capture_ = nullptr;
+      return;
+    }
+    capture_->append( data, size );
+  }
+};
+
+// 100万行の一覧でも数十回の書き込みで済む大きさ
+STATIC_CONSTEXPR std::size_t STDOUT_BUFFER_SIZE = std::size_t( 1 ) << 20;
+STATIC_CONSTEXPR std::size_t STDERR_BUFFER_SIZE = std::size_t( 1 ) << 12;
+
+using Writer = BasicWriter<StdDevice, STDOUT_BUFFER_SIZE>;
+using ErrorWriter = BasicWriter<StdDevice, STDERR_BUFFER_SIZE>;
+
+// バッファは静的領域に置く(ヒープもスタックも使わない)。
+// プロセス終了時のデストラクタで残りがフラッシュされる。
+inline Writer & Out() {
+  static Writer writer( StdDevice::Channel::OUT );
+  return writer;
+}
+
+inline ErrorWriter & Err() {
+  static ErrorWriter writer( StdDevice::Channel::ERR );
+  return writer;
+}
+
+} // OUTPUT
+
+} // lfl
@@ -0,0 +1,43 @@
+/****************************************
+ * lfl/Parallel.hpp
+ *
+ * スレッドを使った簡単な並列実行の補助
+ ****************************************/
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace lfl {
+
+// 既定のスレッド数。取得できなければ1とする。
+inline std::size_t DefaultThreadNum() noexcept {
+  unsigned int const hardware = std::thread::hardware_concurrency();
+  return ( hardware == 0 ) ? 1 : hardware;
+}
+
+// function( thread_index )をthread_num個のスレッドで一度ずつ実行し、すべて終わるまで待つ。
+// thread_indexが0のものは呼び出し元のスレッドで実行するので、
+// thread_numが1ならスレッドは一つも作らない。
+template<typename Function>
+void ParallelFor( std::size_t const thread_num, Function && function ) {
+  std::vector<std::thread> threads;
+  threads.reserve( ( thread_num > 0 ) ? ( thread_num - 1 ) : 0 );
+
+  for ( std::size_t index = 1; index < thread_num; ++index ) {
+    threads.emplace_back( [ &function, index ](){ function( index ); } );
+  }
+
+  function( std::size_t( 0 ) );
+
+  for ( auto & itr : threads ) { itr.join(); }
+}
+
+// [0, size)をthread_num個にほぼ均等に分けたときの、thread_index番目の範囲の先頭
+constexpr std::size_t PartitionBegin( std::size_t const size, std::size_t const thread_num, std::size_t const thread_index ) noexcept {
+  return ( size / thread_num ) * thread_index + std::min( thread_index, size % thread_num );
+}
+
+} // lfl
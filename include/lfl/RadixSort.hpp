@@ -0,0 +1,114 @@
+/****************************************
+ * lfl/RadixSort.hpp
+ *
+ * (64bitのキー, 添字)の組を並べ替えるための、並列のLSD基数ソート。
+ *
+ * 時刻は固定長の整数なので、比較ソートではなく基数ソートで並べ替えられる。
+ * 8bitずつ8回に分けて、下位の桁から安定に振り分けていく。
+ * 各回では、配列をスレッド数に分割して
+ *   1. 分割ごとに桁の出現数を数える
+ *   2. (桁, 分割)の順に累積和を取って、書き込み先の先頭を決める
+ *   3. 分割ごとに書き込み先へ振り分ける
+ * の順に処理するので、振り分けは安定になる。
+ * すべてのキーで同じ値になる桁(時刻の上位の桁など)の回は飛ばす。
+ ****************************************/
+#pragma once
+
+#include "jig.hpp"
+#include "lfl/Parallel.hpp"
+#include "lfl/Time.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace lfl {
+
+struct SortKey {
+  std::uint64_t key;
+  std::uint64_t index;
+};
+
+// 新しいものが先頭に来るようなキーに変換する。
+// 符号ビットを反転させると符号なしの大小が符号付きの大小と一致し、
+// さらに全ビットを反転させると昇順が降順になる。
+constexpr std::uint64_t NewerFirstKey( Time const & time ) noexcept {
+  return ~( static_cast<std::uint64_t>( time.ns() ) ^ ( std::uint64_t( 1 ) << 63 ) );
+}
+
+namespace RADIX {
+
+STATIC_CONSTEXPR std::size_t DIGIT_BITS = 8;
+STATIC_CONSTEXPR std::size_t BUCKET_NUM = std::size_t( 1 ) << DIGIT_BITS;
+STATIC_CONSTEXPR std::size_t PASS_NUM = 64 / DIGIT_BITS;
+// これより少なければスレッドを作るほうが高くつく
+STATIC_CONSTEXPR std::size_t PARALLEL_THRESHOLD = std::size_t( 1 ) << 16;
+
+using histogram_type = std::array<std::size_t, BUCKET_NUM>;
+
+constexpr std::size_t Digit( std::uint64_t const key, std::size_t const pass ) noexcept {
+  return static_cast<std::size_t>( ( key >> ( pass * DIGIT_BITS ) ) & ( BUCKET_NUM - 1 ) );
+}
+
+} // RADIX
+
+// keyの昇順に安定に並べ替える。
+inline void RadixSort( std::vector<SortKey> & keys, std::size_t thread_num ) {
+  using namespace RADIX;
+
+  std::size_t const size = keys.size();
+  if ( size < 2 ) { return; }
+
+  if ( size < PARALLEL_THRESHOLD || thread_num == 0 ) { thread_num = 1; }
+
+  std::vector<SortKey> buffer( size );
+  std::vector<histogram_type> histograms( thread_num );
+
+  SortKey * source = keys.data();
+  SortKey * destination = buffer.data();
+
+  for ( std::size_t pass = 0; pass < PASS_NUM; ++pass ) {
+    ParallelFor( thread_num, [ & ]( std::size_t const thread_index ) {
+      histogram_type & histogram = histograms[thread_index];
+      histogram.fill( 0 );
+
+      std::size_t const end = PartitionBegin( size, thread_num, thread_index + 1 );
+      for ( std::size_t index = PartitionBegin( size, thread_num, thread_index ); index < end; ++index ) {
+        ++histogram[Digit( source[index].key, pass )];
+      }
+    } );
+
+    // すべてのキーが同じ桁なら、この回は振り分けても並びが変わらない。
+    std::size_t const first_digit = Digit( source[0].key, pass );
+    std::size_t same_digit = 0;
+    for ( auto const & histogram : histograms ) { same_digit += histogram[first_digit]; }
+    if ( same_digit == size ) { continue; }
+
+    // (桁, 分割)の順に累積和を取り、各分割の書き込み先の先頭にする。
+    std::size_t offset = 0;
+    for ( std::size_t digit = 0; digit < BUCKET_NUM; ++digit ) {
+      for ( auto & histogram : histograms ) {
+        std::size_t const count = histogram[digit];
+        histogram[digit] = offset;
+        offset += count;
+      }
+    }
+
+    ParallelFor( thread_num, [ & ]( std::size_t const thread_index ) {
+      histogram_type & position = histograms[thread_index];
+
+      std::size_t const end = PartitionBegin( size, thread_num, thread_index + 1 );
+      for ( std::size_t index = PartitionBegin( size, thread_num, thread_index ); index < end; ++index ) {
+        destination[position[Digit( source[index].key, pass )]++] = source[index];
+      }
+    } );
+
+    std::swap( source, destination );
+  }
+
+  if ( source != keys.data() ) { keys.swap( buffer ); }
+}
+
+} // lfl
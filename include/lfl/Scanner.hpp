@@ -0,0 +1,137 @@
+/****************************************
+ * lfl/Scanner.hpp
+ *
+ * ディレクトリの走査。
+ *
+ * 読み込むべきディレクトリを共有のスタックに積み、
+ * 複数のスレッドがそこから一つずつ取り出して読み込む。
+ * 幅優先のときは、次の階層のディレクトリを別に積んでおき、
+ * 今の階層をすべて読み終えてから入れ替える。
+ * 見つかったエントリはスレッドごとのSinkに渡す。
+ *
+ * ディレクトリはバッファ単位(バッチ)で読み込む。
+ * 一つのバッチに収まらない大きなディレクトリでは、
+ * 読み込んだスレッドが2つ目以降のバッチを共有のキューに積み、
+ * 手の空いているスレッドがエントリの処理を分担する。
+ *
+ * 最良優先のときは、スタックの代わりにディレクトリの更新時刻をキーにしたヒープを使う。
+ * 読み込み待ちのディレクトリの保持のしかたはlfl/Frontier.hppを参照。
+ *
+ * --checkpointのときは、一定の間隔で新しいディレクトリを取り出させずに、
+ * 読み込み中のディレクトリがなくなるまで待ってから、その時点の状態を写す(lfl/Checkpoint.hpp)。
+ * 大きなディレクトリが読み終わらずに待ちきれなければ、その回は写さない。
+ *
+ * ファイルシステムへの呼び出しはlfl/FileSystem.hppを通すので、テストではメモリ上の木を走査できる。
+ ****************************************/
+#pragma once
+
+#include "lfl/CmdLine.hpp"
+#include "lfl/Exclude.hpp"
+#include "lfl/Filter.hpp"
+#include "lfl/Sink.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace lfl {
+
+// 読み込み待ちのディレクトリ(lfl/Frontier.hpp)
+struct DirectoryJob;
+// 走査が読むファイルシステム(lfl/FileSystem.hpp)
+class FileSystem;
+
+// 走査の途中の状態を保存するための呼び出し(--checkpoint)。どちらもintervalごとに、走査とは別のスレッドから呼ばれる。
+struct CheckpointHooks {
+  // 保存する間隔(0なら保存しない)
+  std::chrono::milliseconds interval{ 0 };
+  // 読み込み中のディレクトリが読み終わるのを待つ時間の上限(0なら読み終わるまで待つ)。
+  // 待っている間、ほかのスレッドは読み込み中のディレクトリのバッチしか処理できない。
+  // 上限までに読み終わらなければ、その回は保存しない。
+  std::chrono::milliseconds max_pause{ 0 };
+  // どのスレッドもディレクトリを読んでいない間に呼ばれるので、Sinkを読んでよい。
+  // この間は走査が止まっているので、状態を写すだけにする。
+  std::function<void()> capture;
+  // 走査を再開してから、captureのときの読み込み待ちのディレクトリと、それまでに読めなかったディレクトリを渡して呼ばれる。
+  std::function<void( std::vector<DirectoryJob> &&, std::vector<std::string> && )> save;
+};
+
+struct ScanConfig {
+  TimeField time_field = TimeField::WRITE;
+  // サブディレクトリの中まで走査するかどうか
+  bool recursive = false;
+  // シンボリックリンクやジャンクションをたどるかどうか。
+  // たどる場合は、ディレクトリの実体ごとに一度だけ読み込む(循環してもそこで止まる)。
+  bool follow_links = false;
+  // 複数のハードリンクを持つファイルを、一度だけ報告するかどうか
+  bool unique_inodes = false;
+  // 起点と別のボリュームには入らない。
+  // リンクをたどらなければマウントポイント(ジャンクション)に入ることは無いので、
+  // 判定が必要になるのは-Lでリンクをたどるときだけ。
+  bool one_file_system = false;
+  // 起点の直下を1とした、走査する深さの上限(recursiveのときだけ使う)
+  std::size_t max_depth = UNLIMITED_DEPTH;
+  TraversalOrder order = TraversalOrder::DFS;
+  // ディレクトリを一度に読み込むバッファの大きさ
+  std::size_t directory_buffer_size = DEFAULT_DIRECTORY_BUFFER_SIZE;
+  // 走査を打ち切るまでの時間(0なら打ち切らない)。
+  // 打ち切ったときは、それまでに見つかったエントリで結果を作る。
+  std::chrono::milliseconds deadline{ 0 };
+  // 同時に開くハンドルの数の上限(0なら制限しない)。
+  // 一つのスレッドが同時に開くのはHANDLES_PER_WORKER個までなので、スレッドの数を制限して守る。
+  std::size_t max_open = 0;
+  // 読み込み待ちのディレクトリを展開したまま保持する量の上限(lfl/Frontier.hpp)
+  std::size_t max_frontier = DEFAULT_FRONTIER_MEMORY;
+  // 複数のプロセスで分担するときの、自分の組と分ける深さ(lfl/Shard.hpp)
+  Shard shard;
+  std::size_t split_depth = DEFAULT_SPLIT_DEPTH;
+  // 報告するエントリの絞り込み。サブディレクトリに入るかどうかには影響しない。
+  Filter filter;
+  // 除外の規則(基準は走査の起点)。除外されたディレクトリには入らない。
+  ExcludeRules exclude;
+  // 各ディレクトリの.gitignoreと.ignoreを読んで、その下に適用する。
+  bool gitignore = false;
+  // 報告するエントリの所有者を問い合わせて、FoundEntry::ownerに入れる(--group-by=owner)。
+  bool query_owner = false;
+  // .tarと.zipのアーカイブの中のメンバーも報告する(lfl/Archive.hpp)。
+  bool archives = false;
+  // すべてのスレッドを合わせた、一秒あたりのI/Oとディレクトリの数の上限(0なら制限しない。lfl/Throttle.hpp)
+  std::uint64_t max_iops = 0;
+  std::uint64_t max_directories_per_second = 0;
+  // 起点を一つ読み終えるたびに、その添字(rootsの中の位置)で呼ばれる(--per-root)。
+  // 走査しているスレッドのどれかから呼ばれるので、呼び出しの間の排他は呼ばれる側で行う。
+  // 時間切れで読み残した起点は、走査の最後にまとめて呼ばれる。
+  std::function<void( std::size_t )> on_root_done;
+  CheckpointHooks checkpoint;
+  // 読むファイルシステム(nullptrなら実際のファイルシステム)。テストとベンチマークでメモリ上の木に差し替える。
+  FileSystem * file_system = nullptr;
+};
+
+struct ScanResult {
+  // 読み込めなかったディレクトリ
+  std::vector<std::string> errors;
+  // 時間切れで読み残したディレクトリがある(結果は近似)
+  bool is_approximate = false;
+};
+
+// rootsは区切り文字で終わるディレクトリのパス。
+// sinksの数だけスレッドを使う(sinks[i]はi番目のスレッドだけが触る)。
+ScanResult Scan( ScanConfig const &, std::vector<std::string> const & roots, std::vector<Sink *> const & sinks );
+
+// 保存しておいた読み込み待ちのディレクトリ(frontier)から走査を続ける(--resume)。
+// frontierのパスは、Scanが積むものと同じく起点を含めたもの。
+ScanResult Resume( ScanConfig const &, std::vector<DirectoryJob> && frontier, std::vector<Sink *> const & sinks );
+
+// ディレクトリを読まずに、pathsの一つ一つの情報を調べてsinksに渡す(--from-stdin)。
+// pathsをsinksの数に分けて、それぞれのスレッドが担当する。
+// エントリのパスはpathsの要素そのまま(name()もパス全体)になる。ScanResult::errorsは調べられなかったパス。
+// それぞれのSinkには、最初に空のパスのディレクトリを一度だけ知らせる(enterDirectory)。
+// configのうち、ディレクトリを辿るための設定(recursive、max_depth、one_file_system、order、shardなど)は使わない。
+// deadlineを過ぎたら残りのパスは調べず、ScanResult::is_approximateを立てる。
+ScanResult ScanPaths( ScanConfig const &, std::vector<std::string_view> const & paths, std::vector<Sink *> const & sinks );
+
+} // lfl
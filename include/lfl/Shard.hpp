@@ -0,0 +1,69 @@
+/****************************************
+ * lfl/Shard.hpp
+ *
+ * 一つの走査を複数のプロセス(や計算機)に分担させるための分割(--shard I/N)。
+ *
+ * 起点からsplit_depthの深さにあるディレクトリを、
+ * 起点からの相対パスのハッシュ値でN個の組に分け、I番目の組だけを走査する。
+ * それより浅いディレクトリはすべての組が読むが、
+ * その中のエントリを報告するのは0番目の組だけにして、
+ * どのエントリもちょうど一つの組から報告されるようにする。
+ *
+ * ハッシュ値は起点の書き方やプロセス、計算機によらず同じになるように、
+ * 相対パスのバイト列だけから計算する(FNV-1a)。
+ ****************************************/
+#pragma once
+
+#include "jig.hpp"
+#include "lfl/Value.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace lfl {
+
+STATIC_CONSTEXPR std::size_t DEFAULT_SPLIT_DEPTH = 1;
+
+struct Shard {
+  std::uint64_t index = 0;
+  std::uint64_t count = 1;
+
+  constexpr bool isSharded() const noexcept { return count > 1; }
+};
+
+constexpr std::uint64_t ShardHash( std::string_view const relative_path ) noexcept {
+  std::uint64_t hash = 0xCBF29CE484222325ULL;
+
+  for ( auto const itr : relative_path ) {
+    hash ^= static_cast<unsigned char>( itr );
+    hash *= 0x100000001B3ULL;
+  }
+
+  return hash;
+}
+
+// relative_pathは、split_depthの深さにあるディレクトリの、起点からの相対パス(末尾の区切り文字を除く)。
+constexpr bool IsShardOwner( Shard const & shard, std::string_view const relative_path ) noexcept {
+  return ( ShardHash( relative_path ) % shard.count ) == shard.index;
+}
+
+namespace VALUE {
+
+// "I/N"の形式。0 <= I < N
+inline Shard ParseShard( std::string_view const option, std::string_view const value ) {
+  std::size_t const separator = value.find( '/' );
+  if ( separator == std::string_view::npos ) { throw MakeError( option, value, "in the form I/N" ); }
+
+  Shard shard;
+  shard.index = ParseInteger( option, value.substr( 0, separator ) );
+  shard.count = ParseInteger( option, value.substr( separator + 1 ) );
+
+  if ( shard.count == 0 || shard.count <= shard.index ) { throw MakeError( option, value, "in the form I/N with 0 <= I < N" ); }
+
+  return shard;
+}
+
+} // VALUE
+
+} // lfl
@@ -0,0 +1,242 @@
+/****************************************
+ * lfl/Sink.hpp
+ *
+ * 走査で見つかったエントリの受け取り側。
+ *
+ * 走査はスレッドごとに別々のSinkへエントリを渡し、
+ * 走査が終わってからSinkどうしを併合(merge)する。
+ * そのため、Sinkの中では排他制御をしない。
+ ****************************************/
+#pragma once
+
+#include "lfl/Entry.hpp"
+#include "lfl/Time.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace lfl {
+
+// 読み込み中のディレクトリ
+struct DirectoryContext {
+  // 区切り文字で終わるディレクトリのパス
+  std::string const & path;
+  // path中で、走査の起点(コマンドラインで指定されたディレクトリ)が占める長さ
+  std::uint32_t root_length;
+  // 何番目の起点の下にあるか
+  std::uint32_t root = 0;
+};
+
+// ディレクトリの中で見つかったエントリ。nameはディレクトリを読んでいる間だけ有効。
+struct FoundEntry {
+  std::string_view name;
+  Time time;
+  std::uint64_t size;
+  EntryType type;
+  // --group-by=ownerのときだけ入る、所有者の名前
+  std::string_view owner = std::string_view();
+};
+
+inline void AssignEntry( Entry & entry, DirectoryContext const & directory, FoundEntry const & found ) {
+  entry.path.assign( directory.path ).append( found.name );
+  entry.name_offset = directory.root_length;
+  entry.type = found.type;
+  entry.size = found.size;
+  entry.time = found.time;
+}
+
+// Sinkの具体的な型。走査はこれを見て、仮想関数を介さずに呼ぶ実体化を選ぶ(lfl/Dispatch.hpp)。
+enum class SinkKind : std::uint8_t {
+  GENERIC,
+  TOP_K,
+  TABLE,
+  NUM
+};
+
+class Sink {
+public:
+  Sink() = default;
+  explicit Sink( SinkKind const kind ) noexcept : kind_( kind ) {}
+  virtual ~Sink() = default;
+
+  SinkKind kind() const noexcept { return kind_; }
+
+  // ディレクトリのエントリを渡し始める前に一度だけ呼ばれる。
+  virtual void enterDirectory( DirectoryContext const & ) {}
+  virtual void offer( DirectoryContext const &, FoundEntry const & ) = 0;
+private:
+  SinkKind kind_ = SinkKind::GENERIC;
+};
+
+/****************************************
+ * 新しいものから上位count件だけを保持する。
+ *
+ * 最も古いものが先頭に来るヒープで保持しているので、
+ * 先頭より古いエントリはパスの文字列を組み立てる前に捨てられる。
+ ****************************************/
+class TopK final : public Sink {
+public:
+  // 最初に確保するのはRESERVED件まで。グループや木のノードごとにも作るので、それ以上は見つかった分だけ伸ばす。
+  STATIC_CONSTEXPR std::size_t RESERVED = 64;
+
+  explicit TopK( std::size_t const count ) : Sink( SinkKind::TOP_K ), count_( count ) { heap_.reserve( std::min( count, RESERVED ) ); }
+
+  // timeのエントリを渡したら保持されるかどうか。保持されないものは、名前を用意する前に捨てられる。
+  bool accepts( Time const time ) const noexcept { return ( heap_.size() < count_ ) || ( heap_.front().time < time ); }
+
+  // count == 1のときだけ使える。ヒープを介さずに、保持している一件と比べて置き換える。
+  void offerSingle( DirectoryContext const & directory, FoundEntry const & found ) {
+    if ( heap_.empty() ) {
+      AssignEntry( heap_.emplace_back(), directory, found );
+    } else if ( heap_.front().time < found.time ) {
+      AssignEntry( heap_.front(), directory, found );
+    }
+  }
+
+  void offer( DirectoryContext const & directory, FoundEntry const & found ) override {
+    if ( heap_.size() < count_ ) {
+      AssignEntry( heap_.emplace_back(), directory, found );
+      std::push_heap( heap_.begin(), heap_.end(), NewerFirst() );
+    } else if ( heap_.front().time < found.time ) {
+      // ヒープの先頭(保持している中で最も古いもの)を入れ替える。
+      std::pop_heap( heap_.begin(), heap_.end(), NewerFirst() );
+      AssignEntry( heap_.back(), directory, found );
+      std::push_heap( heap_.begin(), heap_.end(), NewerFirst() );
+    }
+  }
+
+  void offer( Entry && entry ) {
+    if ( heap_.size() < count_ ) {
+      heap_.emplace_back( std::move( entry ) );
+      std::push_heap( heap_.begin(), heap_.end(), NewerFirst() );
+    } else if ( heap_.front().time < entry.time ) {
+      std::pop_heap( heap_.begin(), heap_.end(), NewerFirst() );
+      heap_.back() = std::move( entry );
+      std::push_heap( heap_.begin(), heap_.end(), NewerFirst() );
+    }
+  }
+
+  void merge( TopK && other ) {
+    for ( auto & itr : other.heap_ ) { offer( std::move( itr ) ); }
+    other.heap_.clear();
+  }
+
+  // otherはそのまま残す(--treeで、子の結果を親にも伝えるとき)。
+  void merge( TopK const & other ) {
+    for ( auto const & itr : other.heap_ ) { offer( Entry( itr ) ); }
+  }
+
+  // 保持しているエントリを新しい順に並べて取り出す。
+  std::vector<Entry> take() {
+    std::sort_heap( heap_.begin(), heap_.end(), NewerFirst() );
+    return std::move( heap_ );
+  }
+
+  std::size_t count() const noexcept { return count_; }
+  std::size_t size() const noexcept { return heap_.size(); }
+private:
+  std::size_t count_;
+  std::vector<Entry> heap_;
+};
+
+/****************************************
+ * 走査の起点ごとに、新しいものから上位count件を保持する(--per-root)。
+ *
+ * 起点を読み終えたら、その起点のTopKだけを他のスレッドから読み出してよい。
+ * 起点ごとのTopKは別々のオブジェクトなので、読み出している間も他の起点への受け渡しは続けられる。
+ ****************************************/
+class RootTopK final : public Sink {
+public:
+  RootTopK( std::size_t const root_num, std::size_t const count ) : tops_( root_num, TopK( count ) ) {}
+
+  void enterDirectory( DirectoryContext const & directory ) override { current_ = &tops_[directory.root]; }
+
+  void offer( DirectoryContext const & directory, FoundEntry const & found ) override {
+    if ( current_->accepts( found.time ) ) { current_->offer( directory, found ); }
+  }
+
+  TopK & root( std::size_t const index ) noexcept { return tops_[index]; }
+private:
+  std::vector<TopK> tops_;
+  TopK * current_ = nullptr;
+};
+
+/****************************************
+ * 見つかったエントリをすべて保持する(一覧表示用)。
+ *
+ * エントリごとにstd::stringを作らないように、
+ * ディレクトリのパスはディレクトリごとに一つだけ、
+ * ファイル名は一つの大きな文字列に詰めて保持する。
+ * パスを組み立てるのは出力するときだけ。
+ ****************************************/
+class EntryTable final : public Sink {
+public:
+  EntryTable() : Sink( SinkKind::TABLE ) {}
+
+  struct Directory {
+    std::string path;
+    std::uint32_t root_length;
+  };
+
+  struct Row {
+    std::uint64_t name_offset;
+    std::uint32_t directory;
+    std::uint32_t name_length;
+    std::uint64_t size;
+    Time time;
+    EntryType type;
+  };
+
+  void enterDirectory( DirectoryContext const & directory ) override {
+    directories_.emplace_back( Directory{ directory.path, directory.root_length } );
+  }
+
+  void offer( DirectoryContext const &, FoundEntry const & found ) override {
+    rows_.emplace_back( Row{ names_.size(), static_cast<std::uint32_t>( directories_.size() - 1 ), static_cast<std::uint32_t>( found.name.size() ), found.size, found.time, found.type } );
+    names_.append( found.name );
+  }
+
+  void merge( EntryTable && other ) {
+    std::uint64_t const name_base = names_.size();
+    std::uint32_t const directory_base = static_cast<std::uint32_t>( directories_.size() );
+
+    names_.append( other.names_ );
+    std::move( other.directories_.begin(), other.directories_.end(), std::back_inserter( directories_ ) );
+
+    rows_.reserve( rows_.size() + other.rows_.size() );
+    for ( auto row : other.rows_ ) {
+      row.name_offset += name_base;
+      row.directory += directory_base;
+      rows_.emplace_back( row );
+    }
+
+    other = EntryTable();
+  }
+
+  std::size_t size() const noexcept { return rows_.size(); }
+  Row const & row( std::size_t const index ) const noexcept { return rows_[index]; }
+
+  // index番目のエントリの内容をentryに書き込む(entryの文字列の領域は使い回す)。
+  void assign( Entry & entry, std::size_t const index ) const {
+    Row const & row = rows_[index];
+    Directory const & directory = directories_[row.directory];
+
+    entry.path.assign( directory.path ).append( names_, row.name_offset, row.name_length );
+    entry.name_offset = directory.root_length;
+    entry.type = row.type;
+    entry.size = row.size;
+    entry.time = row.time;
+  }
+private:
+  std::vector<Directory> directories_;
+  std::string names_;
+  std::vector<Row> rows_;
+};
+
+} // lfl
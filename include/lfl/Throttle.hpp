@@ -0,0 +1,96 @@
+/****************************************
+ * lfl/Throttle.hpp
+ *
+ * --max-iops、--max-dirs-per-sec: 走査が発行するI/Oの速さを抑える。
+ *
+ * 忙しいサーバーで木全体を走査すると、カーネルが許す限りの速さでメタデータを問い合わせるので、
+ * 遅延に敏感な他の処理を乱す。すべてのスレッドで一つのトークンバケツを共有し、
+ * I/O(ディレクトリを開く、一回分を読む、エントリの実体を問い合わせるなど)ごとにトークンを一つ使う。
+ *
+ * バケツからは一秒の1/REFILLS_PER_SECONDの分を一塊として受け取り、スレッドの手元で使う。
+ * バケツを守るロックはREFILLS_PER_SECOND回に一度しか取られず、待つのも塊ごとになる。
+ * ディレクトリは一回のI/Oで大きなバッファに読むので、抑えていても読み方は変わらない。
+ * 使わずにいた時間の分はバケツに溜めない(しばらく休んだ後でも、一度に溢れ出さない)。
+ ****************************************/
+#pragma once
+
+#include "jig.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+namespace lfl {
+
+namespace THROTTLE {
+
+STATIC_CONSTEXPR std::uint64_t REFILLS_PER_SECOND = 20;
+
+} // THROTTLE
+
+class TokenBucket {
+public:
+  using clock_type = std::chrono::steady_clock;
+
+  // rate: 一秒あたりのトークンの数(0なら制限しない)
+  explicit TokenBucket( std::uint64_t const rate ) noexcept
+  : rate_( rate ), chunk_( std::max<std::uint64_t>( rate / THROTTLE::REFILLS_PER_SECOND, 1 ) ),
+    chunk_cost_( ( rate == 0 ) ? 0 : static_cast<clock_type::rep>( std::chrono::duration_cast<clock_type::duration>( std::chrono::seconds( 1 ) ).count() * chunk_ / rate ) ), next_( clock_type::time_point::min() ) {}
+
+  TokenBucket( TokenBucket const & ) = delete;
+  TokenBucket & operator=( TokenBucket const & ) = delete;
+
+  bool isEnabled() const noexcept { return rate_ != 0; }
+  // 一度に受け取るトークンの数
+  std::uint64_t chunk() const noexcept { return chunk_; }
+
+  // 一塊のトークンを予約して、それを使ってよくなる時刻を返す。
+  // 予約は順番に並ぶので、待っているスレッドどうしで取り合うことは無い。
+  clock_type::time_point reserve( clock_type::time_point const now ) {
+    std::lock_guard<std::mutex> lock( mutex_ );
+
+    clock_type::time_point const granted = std::max( next_, now );
+    next_ = granted + clock_type::duration( chunk_cost_ );
+    return granted;
+  }
+private:
+  std::uint64_t const rate_;
+  std::uint64_t const chunk_;
+  // 一塊のトークンが溜まるまでの時間
+  clock_type::rep const chunk_cost_;
+  std::mutex mutex_;
+  clock_type::time_point next_;
+};
+
+// スレッドごとの手持ちのトークン
+class TokenAllowance {
+public:
+  using clock_type = TokenBucket::clock_type;
+
+  explicit TokenAllowance( TokenBucket & bucket ) noexcept : bucket_( bucket ) {}
+
+  // トークンを一つ使う。手持ちが無ければバケツから一塊を受け取り、使ってよくなるまで待つ。
+  // limit(--deadlineの期限)までに使えるようにならなければ、limitまで待ってfalseを返す。
+  bool take( clock_type::time_point const limit = clock_type::time_point::max() ) {
+    if ( tokens_ == 0 && bucket_.isEnabled() ) {
+      clock_type::time_point const granted = bucket_.reserve( clock_type::now() );
+      if ( limit < granted ) {
+        std::this_thread::sleep_until( limit );
+        return false;
+      }
+
+      std::this_thread::sleep_until( granted );
+      tokens_ = bucket_.chunk();
+    }
+
+    if ( tokens_ != 0 ) { --tokens_; }
+    return true;
+  }
+private:
+  TokenBucket & bucket_;
+  std::uint64_t tokens_ = 0;
+};
+
+} // lfl
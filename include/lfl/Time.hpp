@@ -0,0 +1,58 @@
+/****************************************
+ * lfl/Time.hpp
+ *
+ * ファイルの時刻。UNIXエポックからのナノ秒を符号付き64bit整数で保持する。
+ * 比較も出力も整数のまま行えるので、FILETIMEの上位・下位を
+ * 分けて比較する必要が無い。
+ ****************************************/
+#pragma once
+
+#include "Util/Comparable.hpp"
+
+#include <compare>
+#include <cstdint>
+#include <limits>
+
+namespace lfl {
+
+class Time : public UTIL::COMPARABLE::CompDef<Time> {
+public:
+  using rep = std::int64_t;
+
+  // 1601-01-01(FILETIMEの起点)から1970-01-01までの100ナノ秒単位の差
+  static constexpr std::uint64_t FILETIME_UNIX_EPOCH = 116444736000000000ULL;
+  static constexpr rep TICK_NS = 100;
+
+  Time() = default;
+  explicit constexpr Time( rep const ns ) noexcept : ns_( ns ) {}
+
+  Time( Time const & ) = default;
+  Time & operator = ( Time const & ) = default;
+  Time( Time && ) noexcept = default;
+  Time & operator = ( Time && ) noexcept = default;
+
+  // FILETIME(1601年からの100ナノ秒単位)から変換する。
+  // ナノ秒の符号付き64bitで表せない範囲(1678年以前・2262年以降)は飽和させる。
+  static constexpr Time FromFileTime( std::uint64_t const ticks ) noexcept {
+    constexpr rep MAX_TICKS = std::numeric_limits<rep>::max() / TICK_NS;
+
+    rep const unix_ticks = ( ticks >= FILETIME_UNIX_EPOCH )
+      ? static_cast<rep>( ( ( ticks - FILETIME_UNIX_EPOCH ) < static_cast<std::uint64_t>( MAX_TICKS ) ) ? ( ticks - FILETIME_UNIX_EPOCH ) : MAX_TICKS )
+      : -static_cast<rep>( ( ( FILETIME_UNIX_EPOCH - ticks ) < static_cast<std::uint64_t>( MAX_TICKS ) ) ? ( FILETIME_UNIX_EPOCH - ticks ) : MAX_TICKS );
+
+    return Time( unix_ticks * TICK_NS );
+  }
+
+  static constexpr Time Min() noexcept { return Time( std::numeric_limits<rep>::min() ); }
+  static constexpr Time Max() noexcept { return Time( std::numeric_limits<rep>::max() ); }
+
+  constexpr rep ns() const noexcept { return ns_; }
+
+  friend constexpr bool operator < ( Time const & time1, Time const & time2 ) noexcept { return ( time1.ns_ < time2.ns_ ); }
+  friend constexpr std::strong_ordering operator <=> ( Time const & time1, Time const & time2 ) noexcept { return ( time1.ns_ <=> time2.ns_ ); }
+private:
+  // 何も見つかっていない状態は、どの時刻よりも古いものとして扱う。
+  rep ns_ = std::numeric_limits<rep>::min();
+};
+
+} // lfl
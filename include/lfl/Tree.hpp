@@ -0,0 +1,141 @@
+/****************************************
+ * lfl/Tree.hpp
+ *
+ * --tree: 一覧に出す深さまでの各ディレクトリについて、その下のどこかにある最も新しいエントリを求める。
+ * (du --max-depthの、大きさではなく新しさの版)
+ *
+ * 走査は一度だけ、木全体を読む。スレッドごとのTreeRollupは、ディレクトリを読み始めるときに
+ * そのディレクトリが数えられる一覧のディレクトリ(一覧に出す深さの祖先)を一度だけ引いておき、
+ * エントリごとには、そのディレクトリの上位count件と時刻を比べるだけにする。
+ * 走査が終わってから併合し、深いディレクトリから順に親へ上位count件を伝える。
+ ****************************************/
+#pragma once
+
+#include "lfl/Entry.hpp"
+#include "lfl/Sink.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace lfl {
+
+namespace TREE {
+
+// ディレクトリのパスから、それが数えられる一覧のディレクトリのパスを切り出す。
+// 起点をdepth 1として、max_depthより深いディレクトリは、深さmax_depthの祖先になる。
+constexpr std::string_view ListedDirectory( DirectoryContext const & directory, std::size_t const max_depth ) noexcept {
+  std::string_view const path( directory.path );
+
+  std::size_t end = directory.root_length;
+  for ( std::size_t depth = 1; depth < max_depth && end < path.size(); ++depth ) { end = path.find( DELIMITER, end ) + 1; }
+
+  return path.substr( 0, end );
+}
+
+// 一つ上のディレクトリのパス(区切り文字で終わる)
+constexpr std::string_view ParentDirectory( std::string_view const path ) noexcept {
+  std::size_t const separator = path.rfind( DELIMITER, path.size() - 2 );
+  return ( separator == std::string_view::npos ) ? std::string_view() : path.substr( 0, separator + 1 );
+}
+
+// std::stringのキーを、std::string_viewのまま引くためのハッシュと比較
+struct StringHash {
+  using is_transparent = void;
+  std::size_t operator()( std::string_view const text ) const noexcept { return std::hash<std::string_view>()( text ); }
+};
+
+} // TREE
+
+class TreeRollup final : public Sink {
+public:
+  struct Node {
+    // 区切り文字で終わるディレクトリのパス
+    std::string directory;
+    // 走査の起点(コマンドラインで指定されたディレクトリ)が占める長さ
+    std::uint32_t root_length;
+    TopK top;
+  };
+
+  TreeRollup( std::size_t const max_depth, std::size_t const count ) : max_depth_( max_depth ), count_( count ) {}
+
+  TreeRollup( TreeRollup const & ) = delete;
+  TreeRollup & operator=( TreeRollup const & ) = delete;
+  TreeRollup( TreeRollup && ) = default;
+  TreeRollup & operator=( TreeRollup && ) = default;
+
+  void enterDirectory( DirectoryContext const & directory ) override { current_ = &find( TREE::ListedDirectory( directory, max_depth_ ), directory.root_length ); }
+
+  void offer( DirectoryContext const & directory, FoundEntry const & found ) override {
+    TopK & top = current_->top;
+    if ( top.accepts( found.time ) ) { top.offer( directory, found ); }
+  }
+
+  void merge( TreeRollup && other ) {
+    for ( auto & itr : other.nodes_ ) { find( itr.directory, itr.root_length ).top.merge( std::move( itr.top ) ); }
+
+    other.nodes_.clear();
+    other.index_.clear();
+    other.current_ = nullptr;
+  }
+
+  // 子の上位count件を親に伝え、ディレクトリのパスの順に並べて取り出す。
+  std::vector<Node> take() {
+    std::vector<Node *> order;
+    order.reserve( nodes_.size() );
+    for ( auto & itr : nodes_ ) { order.emplace_back( &itr ); }
+
+    // 子のパスは親のパスより長いので、長いものから伝えれば、子はそれより前に伝え終わっている。
+    std::sort( order.begin(), order.end(), []( Node const * const lhs, Node const * const rhs ){ return rhs->directory.size() < lhs->directory.size(); } );
+    for ( Node const * const child : order ) {
+      // 読めなかったディレクトリは一覧に無いので、さらに上の祖先に伝える。
+      for ( std::string_view parent = child->directory; parent.size() > child->root_length; ) {
+        parent = TREE::ParentDirectory( parent );
+
+        auto const itr = index_.find( parent );
+        if ( itr != index_.end() ) {
+          itr->second->top.merge( child->top );
+          break;
+        }
+      }
+    }
+
+    std::vector<Node> result;
+    result.reserve( nodes_.size() );
+    for ( auto & itr : nodes_ ) { result.emplace_back( std::move( itr ) ); }
+    std::sort( result.begin(), result.end(), []( Node const & lhs, Node const & rhs ){ return lhs.directory < rhs.directory; } );
+
+    nodes_.clear();
+    index_.clear();
+    current_ = nullptr;
+
+    return result;
+  }
+
+  std::size_t size() const noexcept { return nodes_.size(); }
+private:
+  std::size_t max_depth_;
+  std::size_t count_;
+  // dequeなので、追加してもindex_とcurrent_が指す先は無効にならない。
+  std::deque<Node> nodes_;
+  std::unordered_map<std::string, Node *, TREE::StringHash, std::equal_to<>> index_;
+  Node * current_ = nullptr;
+
+  Node & find( std::string_view const directory, std::uint32_t const root_length ) {
+    auto const itr = index_.find( directory );
+    if ( itr != index_.end() ) { return *itr->second; }
+
+    Node & node = nodes_.emplace_back( Node{ std::string( directory ), root_length, TopK( count_ ) } );
+    index_.emplace( node.directory, &node );
+    return node;
+  }
+};
+
+} // lfl
@@ -0,0 +1,200 @@
+/****************************************
+ * lfl/Value.hpp
+ *
+ * オプションの値(文字列)を型付きの値に変換する関数群。
+ * 起動時に一度だけ呼び出して、走査中には文字列を触らないようにする。
+ ****************************************/
+#pragma once
+
+#include "jig.hpp"
+#include "jig/option.hpp"
+#include "lfl/Time.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+namespace lfl {
+
+namespace VALUE {
+
+inline std::invalid_argument MakeError( std::string_view const option, std::string_view const value, char const * expected ) {
+  std::string message( "--" );
+  message.append( option ).append( ": '" ).append( value ).append( "' is not " ).append( expected );
+  return std::invalid_argument( message );
+}
+
+// 10進の符号なし整数。末尾に余計な文字があればエラーにする。
+inline std::uint64_t ParseInteger( std::string_view const option, std::string_view const value ) {
+  std::uint64_t result = 0;
+  auto [ ptr, ec ] = std::from_chars( value.data(), value.data() + value.size(), result );
+
+  if ( value.empty() || ec != std::errc() || ptr != ( value.data() + value.size() ) ) {
+    throw MakeError( option, value, "an integer" );
+  }
+
+  return result;
+}
+
+// "64K", "1M", "2G"のように2進接頭辞(1024倍)を付けられる整数。
+inline std::uint64_t ParseSize( std::string_view const option, std::string_view const value ) {
+  if ( value.empty() ) { throw MakeError( option, value, "a size" ); }
+
+  std::uint64_t unit = 1;
+  std::string_view digits = value;
+
+  switch ( value.back() ) {
+    case 'k': case 'K': unit = std::uint64_t( 1 ) << 10; break;
+    case 'm': case 'M': unit = std::uint64_t( 1 ) << 20; break;
+    case 'g': case 'G': unit = std::uint64_t( 1 ) << 30; break;
+    case 't': case 'T': unit = std::uint64_t( 1 ) << 40; break;
+    default: break;
+  }
+  if ( unit != 1 ) { digits.remove_suffix( 1 ); }
+
+  // from_charsは桁の多すぎる数をresult_out_of_rangeにするので、溢れうるのは単位を掛けるところだけ。
+  std::uint64_t result = 0;
+  auto [ ptr, ec ] = std::from_chars( digits.data(), digits.data() + digits.size(), result );
+
+  if ( digits.empty() || ec != std::errc() || ptr != ( digits.data() + digits.size() ) ) {
+    throw MakeError( option, value, "a size" );
+  }
+  if ( std::numeric_limits<std::uint64_t>::max() / unit < result ) { throw MakeError( option, value, "a size that fits in 64 bits" ); }
+
+  return result * unit;
+}
+
+// 時間指定の上限。期限は時計の今の時刻に足して使うので、足してもナノ秒の時刻が溢れないように、
+// ナノ秒で表せる長さ(約292年)の半分までにする。
+STATIC_CONSTEXPR std::chrono::milliseconds MAX_DURATION = std::chrono::duration_cast<std::chrono::milliseconds>( std::chrono::nanoseconds::max() ) / 2;
+
+// "250ms", "3s", "5m", "1h"のような時間指定。単位が無ければミリ秒とみなす。
+inline std::chrono::milliseconds ParseDuration( std::string_view const option, std::string_view const value ) {
+  std::uint64_t count = 0;
+  auto [ ptr, ec ] = std::from_chars( value.data(), value.data() + value.size(), count );
+
+  if ( value.empty() || ec != std::errc() ) { throw MakeError( option, value, "a duration" ); }
+
+  std::string_view const unit( ptr, ( value.data() + value.size() ) - ptr );
+
+  // 1単位あたりのミリ秒
+  std::uint64_t unit_ms = 0;
+  if ( unit.empty() || unit == "ms" ) {
+    unit_ms = 1;
+  } else if ( unit == "s" ) {
+    unit_ms = 1000;
+  } else if ( unit == "m" ) {
+    unit_ms = 60 * 1000;
+  } else if ( unit == "h" ) {
+    unit_ms = 60 * 60 * 1000;
+  } else {
+    throw MakeError( option, value, "a duration" );
+  }
+
+  if ( static_cast<std::uint64_t>( MAX_DURATION.count() ) / unit_ms < count ) { throw MakeError( option, value, "a duration of at most 146 years" ); }
+
+  return std::chrono::milliseconds( static_cast<std::chrono::milliseconds::rep>( count * unit_ms ) );
+}
+
+// 1970-01-01からの日数(先発グレゴリオ暦)。
+constexpr std::int64_t DaysFromCivil( std::int64_t year, unsigned const month, unsigned const day ) noexcept {
+  year -= ( month <= 2 ) ? 1 : 0;
+  std::int64_t const era = ( ( year >= 0 ) ? year : year - 399 ) / 400;
+  unsigned const year_of_era = static_cast<unsigned>( year - era * 400 );
+  unsigned const day_of_year = ( 153 * ( ( month > 2 ) ? month - 3 : month + 9 ) + 2 ) / 5 + day - 1;
+  unsigned const day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+  return era * 146097 + static_cast<std::int64_t>( day_of_era ) - 719468;
+}
+
+// その月の日数(先発グレゴリオ暦。閏年の2月は29日)。
+constexpr unsigned DaysInMonth( unsigned const year, unsigned const month ) noexcept {
+  if ( month == 2 ) { return ( ( year % 4 == 0 && year % 100 != 0 ) || year % 400 == 0 ) ? 29 : 28; }
+  return ( month == 4 || month == 6 || month == 9 || month == 11 ) ? 30 : 31;
+}
+
+// "2024-05-01"、"2024-05-01T12:30"、"2024-05-01T12:30:15"のような時刻(UTC)。
+// 無い日付("2024-02-30"など)は、翌月に繰り越さずにエラーにする。
+// 出力の時刻もUNIXエポックからの値なので、タイムゾーンには依らない。
+inline Time ParseTimePoint( std::string_view const option, std::string_view const value ) {
+  std::string_view rest = value;
+
+  // 桁数が決まった数字を読み、続く区切り文字を読み飛ばす。
+  auto const field = [ & ]( std::size_t const digit_num, unsigned const min, unsigned const max ) {
+    unsigned result = 0;
+    auto [ ptr, ec ] = std::from_chars( rest.data(), rest.data() + std::min( digit_num, rest.size() ), result );
+
+    if ( ec != std::errc() || ptr != rest.data() + digit_num || result < min || max < result ) { throw MakeError( option, value, "a time" ); }
+
+    rest.remove_prefix( digit_num );
+    return result;
+  };
+  auto const separator = [ & ]( char const expected ) {
+    if ( rest.empty() || rest.front() != expected ) { throw MakeError( option, value, "a time" ); }
+    rest.remove_prefix( 1 );
+  };
+
+  unsigned const year = field( 4, 1678, 2261 );
+  separator( '-' );
+  unsigned const month = field( 2, 1, 12 );
+  separator( '-' );
+  unsigned const day = field( 2, 1, DaysInMonth( year, month ) );
+
+  std::int64_t seconds = DaysFromCivil( year, month, day ) * 86400;
+
+  if ( !rest.empty() ) {
+    if ( rest.front() != 'T' && rest.front() != ' ' ) { throw MakeError( option, value, "a time" ); }
+    rest.remove_prefix( 1 );
+
+    seconds += field( 2, 0, 23 ) * 3600;
+    separator( ':' );
+    seconds += field( 2, 0, 59 ) * 60;
+
+    if ( !rest.empty() ) {
+      separator( ':' );
+      seconds += field( 2, 0, 59 );
+    }
+  }
+
+  if ( !rest.empty() ) { throw MakeError( option, value, "a time" ); }
+
+  return Time( seconds * 1000000000 );
+}
+
+// "A..B"の形の時刻の範囲[A, B)。どちらかを省くと、その側には制限が無い。
+inline std::pair<Time, Time> ParseTimeRange( std::string_view const option, std::string_view const value ) {
+  std::size_t const separator = value.find( ".." );
+  if ( separator == std::string_view::npos ) { throw MakeError( option, value, "a time range (A..B)" ); }
+
+  std::string_view const begin = value.substr( 0, separator );
+  std::string_view const end = value.substr( separator + 2 );
+
+  std::pair<Time, Time> range( Time::Min(), Time::Max() );
+  if ( !begin.empty() ) { range.first = ParseTimePoint( option, begin ); }
+  if ( !end.empty() ) { range.second = ParseTimePoint( option, end ); }
+
+  if ( !( range.first < range.second ) ) { throw MakeError( option, value, "a non-empty time range" ); }
+
+  return range;
+}
+
+// NAMESに並べた名前のどれかに完全一致すれば、その添字を列挙型として返す。
+template<typename Enum, auto const & NAMES>
+inline Enum ParseEnum( std::string_view const option, std::string_view const value ) {
+  STATIC_CONSTEXPR auto name_list = jig::OPTION::MakeOptionList<NAMES>();
+
+  auto [ is_match, index ] = name_list.matchIndex( value );
+  if ( !is_match ) { throw MakeError( option, value, "a valid choice" ); }
+
+  return static_cast<Enum>( index );
+}
+
+} // VALUE
+
+} // lfl
@@ -0,0 +1,79 @@
+/****************************************
+ * Cache.cpp
+ *
+ * lfl/Cache.hppの共有メモリと、起点の問い合わせ(Windows API)
+ *****************************************/
+
+#include "lfl/Cache.hpp"
+
+// std
+#include <cstddef>
+#include <windows.h>
+
+namespace lfl {
+
+namespace CACHE {
+
+namespace {
+
+// 同じログオンセッションのプロセスだけで共有する。末尾はSegmentの配置の版。
+STATIC_CONSTEXPR char SEGMENT_NAME[] = "Local\\lfl-cache-1";
+
+// 大文字と小文字の区別はASCIIの範囲だけそろえる(CharLowerはuser32.dllを読み込むので使わない)。
+constexpr char ToLower( char const one_char ) noexcept { return ( 'A' <= one_char && one_char <= 'Z' ) ? static_cast<char>( one_char - 'A' + 'a' ) : one_char; }
+
+} // namespace
+
+SharedSegment::~SharedSegment() {
+  if ( segment_ != nullptr ) { UnmapViewOfFile( segment_ ); }
+  if ( mapping_ != nullptr ) { CloseHandle( static_cast<HANDLE>( mapping_ ) ); }
+}
+
+bool SharedSegment::open() {
+  // 最初に作ったプロセスの領域を、後から起動したプロセスが開く。最後のプロセスが閉じると消える。
+  STATIC_CONSTEXPR std::uint64_t SIZE = sizeof( Segment );
+  HANDLE const mapping = CreateFileMapping( INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, static_cast<DWORD>( SIZE >> 32 ), static_cast<DWORD>( SIZE ), SEGMENT_NAME );
+  if ( mapping == nullptr ) { return false; }
+
+  void * const view = MapViewOfFile( mapping, FILE_MAP_ALL_ACCESS, 0, 0, sizeof( Segment ) );
+  if ( view == nullptr ) {
+    CloseHandle( mapping );
+    return false;
+  }
+
+  mapping_ = mapping;
+  segment_ = static_cast<Segment *>( view );
+  return true;
+}
+
+std::uint64_t MakeKey( std::vector<std::string> const & roots, int const argc, char const * const argv[] ) {
+  Hasher hasher;
+
+  char full_path[MAX_PATH];
+  for ( auto const & itr : roots ) {
+    DWORD const length = GetFullPathName( itr.c_str(), MAX_PATH, full_path, nullptr );
+    // 長すぎて絶対パスにできなければ、書かれたまま混ぜる。
+    std::string path = ( length == 0 || MAX_PATH <= length ) ? itr : std::string( full_path, length );
+    for ( auto & one_char : path ) { one_char = ToLower( one_char ); }
+
+    hasher.add( path );
+  }
+
+  hasher.add( static_cast<std::uint64_t>( argc ) );
+  for ( int index = 1; index < argc; ++index ) { hasher.add( std::string_view( argv[index] ) ); }
+
+  return hasher.value();
+}
+
+bool StampDirectory( std::string const & path, Hasher & stamp ) {
+  // 属性と更新時刻を一度に問い合わせる(ディレクトリは開かない)。
+  WIN32_FILE_ATTRIBUTE_DATA data;
+  if ( GetFileAttributesEx( path.c_str(), GetFileExInfoStandard, &data ) == 0 || !( data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY ) ) { return false; }
+
+  stamp.add( ( static_cast<std::uint64_t>( data.ftLastWriteTime.dwHighDateTime ) << 32 ) | data.ftLastWriteTime.dwLowDateTime );
+  return true;
+}
+
+} // CACHE
+
+} // lfl
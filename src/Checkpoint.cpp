@@ -0,0 +1,37 @@
+/****************************************
+ * Checkpoint.cpp
+ *
+ * lfl/Checkpoint.hppのファイルの書き込み(Windows API)
+ *****************************************/
+
+#include "lfl/Checkpoint.hpp"
+#include "lfl/Output.hpp"
+
+// std
+#include <windows.h>
+
+namespace lfl {
+
+namespace CHECKPOINT {
+
+bool WriteAtomically( std::string const & path, std::string_view data ) {
+  std::string const temporary = path + ".tmp";
+
+  HANDLE const handle = CreateFile( temporary.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr );
+  if ( handle == INVALID_HANDLE_VALUE ) { return false; }
+
+  // 名前を変えた後で中身が欠けていないように、置き換える前にディスクまで書き出す。
+  bool const is_success = OUTPUT::WriteAll( handle, data.data(), data.size() ) && ( FlushFileBuffers( handle ) != 0 );
+  CloseHandle( handle );
+
+  if ( !is_success || MoveFileEx( temporary.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH ) == 0 ) {
+    DeleteFile( temporary.c_str() );
+    return false;
+  }
+
+  return true;
+}
+
+} // CHECKPOINT
+
+} // lfl
@@ -0,0 +1,80 @@
+/****************************************
+ * FileSystem.cpp
+ *
+ * lfl/FileSystem.hppの実際のファイルシステム(Windows API)
+ *****************************************/
+
+#include "lfl/FileSystem.hpp"
+#include "lfl/Input.hpp"
+
+// std
+#include <windows.h>
+
+namespace lfl {
+
+namespace {
+
+std::uint64_t toTicks( FILETIME const & file_time ) noexcept { return ( static_cast<std::uint64_t>( file_time.dwHighDateTime ) << 32 ) | file_time.dwLowDateTime; }
+
+// BY_HANDLE_FILE_INFORMATIONとWIN32_FILE_ATTRIBUTE_DATAは同じ名前のメンバを持っているので、どちらにも使える。
+template<typename Information>
+void assignCommon( FileInformation & information, Information const & source ) noexcept {
+  information.attributes = source.dwFileAttributes;
+  information.creation_time = toTicks( source.ftCreationTime );
+  information.access_time = toTicks( source.ftLastAccessTime );
+  information.write_time = toTicks( source.ftLastWriteTime );
+  information.size = ( static_cast<std::uint64_t>( source.nFileSizeHigh ) << 32 ) | source.nFileSizeLow;
+}
+
+class Native final : public FileSystem {
+public:
+  void * openDirectory( std::string const & path ) override {
+    HANDLE const handle = CreateFile( path.c_str(), FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, nullptr );
+    return ( handle == INVALID_HANDLE_VALUE ) ? nullptr : handle;
+  }
+
+  ReadStatus readDirectory( void * const directory, void * const buffer, std::uint32_t const size ) override {
+    if ( GetFileInformationByHandleEx( static_cast<HANDLE>( directory ), FileFullDirectoryInfo, buffer, size ) != 0 ) { return ReadStatus::READ; }
+
+    return ( GetLastError() == ERROR_NO_MORE_FILES ) ? ReadStatus::END : ReadStatus::FAILED;
+  }
+
+  void closeDirectory( void * const directory ) noexcept override { CloseHandle( static_cast<HANDLE>( directory ) ); }
+
+  // ディレクトリを開くにはFILE_FLAG_BACKUP_SEMANTICSが必要。
+  bool queryInformation( std::string const & path, FileInformation & information ) override {
+    HANDLE const handle = CreateFile( path.c_str(), FILE_READ_ATTRIBUTES, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, nullptr );
+    if ( handle == INVALID_HANDLE_VALUE ) { return false; }
+
+    BY_HANDLE_FILE_INFORMATION source;
+    bool const is_success = ( GetFileInformationByHandle( handle, &source ) != 0 );
+    CloseHandle( handle );
+    if ( !is_success ) { return false; }
+
+    assignCommon( information, source );
+    information.volume = source.dwVolumeSerialNumber;
+    information.index = ( static_cast<std::uint64_t>( source.nFileIndexHigh ) << 32 ) | source.nFileIndexLow;
+    information.links = source.nNumberOfLinks;
+    return true;
+  }
+
+  bool queryAttributes( std::string const & path, FileInformation & information ) override {
+    WIN32_FILE_ATTRIBUTE_DATA source;
+    if ( GetFileAttributesEx( path.c_str(), GetFileExInfoStandard, &source ) == 0 ) { return false; }
+
+    information = FileInformation();
+    assignCommon( information, source );
+    return true;
+  }
+
+  bool readFile( std::string const & path, std::string & contents ) override { return INPUT::ReadAll( path, contents ); }
+};
+
+} // namespace
+
+FileSystem & NativeFileSystem() noexcept {
+  static Native native;
+  return native;
+}
+
+} // lfl
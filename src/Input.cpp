@@ -0,0 +1,54 @@
+/****************************************
+ * Input.cpp
+ *
+ * lfl/Input.hppの読み込み(Windows API)
+ *****************************************/
+
+#include "lfl/Input.hpp"
+#include "jig.hpp"
+
+// std
+#include <cstddef>
+#include <windows.h>
+
+namespace lfl {
+
+namespace INPUT {
+
+bool ReadAll( std::string const & path, std::string & contents ) {
+  bool const is_stdin = ( path == "-" );
+  HANDLE const handle = is_stdin
+    ? GetStdHandle( STD_INPUT_HANDLE )
+    : CreateFile( path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr );
+  if ( handle == INVALID_HANDLE_VALUE || handle == nullptr ) { return false; }
+
+  // 大きさの分からない標準入力(パイプ)もあるので、塊ごとに読み足していく。
+  STATIC_CONSTEXPR std::size_t CHUNK = std::size_t( 1 ) << 20;
+
+  contents.clear();
+  bool is_success = true;
+
+  for ( ;; ) {
+    std::size_t const offset = contents.size();
+    contents.resize( offset + CHUNK );
+
+    DWORD read = 0;
+    if ( ReadFile( handle, contents.data() + offset, static_cast<DWORD>( CHUNK ), &read, nullptr ) == 0 ) {
+      // パイプの書き込み側が閉じられたのは、終端に達したということ。
+      is_success = ( GetLastError() == ERROR_BROKEN_PIPE );
+      contents.resize( offset );
+      break;
+    }
+
+    contents.resize( offset + read );
+    if ( read == 0 ) { break; }
+  }
+
+  if ( !is_stdin ) { CloseHandle( handle ); }
+
+  return is_success;
+}
+
+} // INPUT
+
+} // lfl
@@ -7,54 +7,96 @@
 #include "version.h"
 #include "Util/Comparable.hpp"
 #include "jig/option.hpp"
+#include "lfl/Cache.hpp"
+#include "lfl/Checkpoint.hpp"
+#include "lfl/CmdLine.hpp"
+#include "lfl/Entry.hpp"
+#include "lfl/Format.hpp"
+#include "lfl/Group.hpp"
+#include "lfl/Input.hpp"
+#include "lfl/Parallel.hpp"
+#include "lfl/RadixSort.hpp"
+#include "lfl/Scanner.hpp"
+#include "lfl/Sink.hpp"
+#include "lfl/Tree.hpp"
+#include "lfl/Output.hpp"
 
 // std
 #include <algorithm>
-#include <cstring>
-#include <fileapi.h>
-#include <iostream>
-#include <minwindef.h>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
 #include <string>
-#include <shlwapi.h>
+#include <string_view>
+#include <utility>
 #include <vector>
 #include <windows.h>
 
-STATIC_CONSTEXPR char DELIMITER = '\\';
-STATIC_CONSTEXPR char OPTION_SPECIFIER[] = "--";
-STATIC_CONSTEXPR int SPECIFIER_LENGTH = jig::ArraySize( OPTION_SPECIFIER ); // add the NULL character in the string tail.
-STATIC_CONSTEXPR int NULL_EXCLUDE_OS_LENGTH = SPECIFIER_LENGTH - 1;
-STATIC_CONSTEXPR char const * options[] = { "help", "version", "directory" };
-STATIC_CONSTEXPR jig::OPTION::OptionList<
-jig::STRING::Literal<char const *, jig::STRING::Length(options[0])>( options[0] ),
-jig::STRING::Literal<char const *, jig::STRING::Length(options[1])>( options[1] ),
-jig::STRING::Literal<char const *, jig::STRING::Length(options[2])>( options[2] )
-> option_list;
+// <iostream>は起動時の静的初期化(std::ios_base::Init)の分だけ起動を遅くするので、本体では使わない。
+// 出力はlfl/Output.hppのバッファを経由してWriteFileで書き出す。
+#if defined( _GLIBCXX_IOSTREAM ) || defined( _LIBCPP_IOSTREAM )
+#error "<iostream> must not be included in lfl: use lfl/Output.hpp"
+#endif
+
+using lfl::DELIMITER;
 
 namespace message {
 
 STATIC_CONSTEXPR jig::STRING::Literal VERSION( VERSION_STRING );
-STATIC_CONSTEXPR jig::STRING::Literal HELP( "Usage: lfl [directory]\nOutput one name of the latest updated file in specified directory.  default of directory is current directory.\nThis software don't support specification of multiple directories yet." );
+STATIC_CONSTEXPR jig::STRING::Literal HELP( "Usage: lfl [options] [directory...]\nOutput one name of the latest updated file in specified directories.  default of directory is current directory." );
 STATIC_CONSTEXPR jig::STRING::Literal USAGE_DIRECTORY( "--directory: Specify search directories.\n  ( This option is always specified if none is specified )." );
 STATIC_CONSTEXPR jig::STRING::Literal USAGE_HELP( "--help: Display this message." );
 STATIC_CONSTEXPR jig::STRING::Literal USAGE_VERSION( "--version: Display the version of this application." );
+STATIC_CONSTEXPR jig::STRING::Literal USAGE_COUNT( "--count N: Output the N latest updated files in descending order of time ( default: 1, at most 16777216; use --sort for more )." );
+STATIC_CONSTEXPR jig::STRING::Literal USAGE_TIME( "--time write|access|creation: Select the time to compare ( default: write )." );
+STATIC_CONSTEXPR jig::STRING::Literal USAGE_NULL( "--null, -0: Output full paths terminated by NUL instead of names terminated by newline." );
+STATIC_CONSTEXPR jig::STRING::Literal USAGE_JSON( "--json: Output JSON Lines with path, time ( ns since epoch ), size and type." );
+STATIC_CONSTEXPR jig::STRING::Literal USAGE_BINARY( "--binary: Output fixed-layout binary records ( see lfl/Format.hpp )." );
+STATIC_CONSTEXPR jig::STRING::Literal USAGE_SORT( "--sort: Output all of the entries in descending order of time." );
+STATIC_CONSTEXPR jig::STRING::Literal USAGE_RECURSIVE( "--recursive, -r: Search subdirectories too." );
+STATIC_CONSTEXPR jig::STRING::Literal USAGE_FOLLOW( "--follow, -L: Follow symbolic links and junctions.  Each directory is read only once even if it is reachable by several paths." );
+STATIC_CONSTEXPR jig::STRING::Literal USAGE_UNIQUE_INODES( "--unique-inodes: Report a file that has several hard links only once.  This queries every file, so it is slower." );
+STATIC_CONSTEXPR jig::STRING::Literal USAGE_XDEV( "--xdev: Do not descend into directories on other volumes." );
+STATIC_CONSTEXPR jig::STRING::Literal USAGE_MAX_DEPTH( "--max-depth N: Search at most N levels below the directories ( 1 is the directories themselves ).  This implies --recursive." );
+STATIC_CONSTEXPR jig::STRING::Literal USAGE_ORDER( "--order dfs|bfs|best: Read depth-first ( default, uses less memory ), one level at a time, or directories modified recently first." );
+STATIC_CONSTEXPR jig::STRING::Literal USAGE_DEADLINE( "--deadline MS: Stop searching after MS milliseconds and output the best result found so far ( implies --order best ).  The result is reported as approximate if the search was stopped." );
+STATIC_CONSTEXPR jig::STRING::Literal USAGE_DIRBUF( "--dirbuf SIZE: Buffer size to read a directory at once, 4K to 64M ( default: 1M )." );
+STATIC_CONSTEXPR jig::STRING::Literal USAGE_MAX_OPEN( "--max-open N: Open at most N handles at once while searching ( 2 or more ).  This limits the number of threads." );
+STATIC_CONSTEXPR jig::STRING::Literal USAGE_MAX_FRONTIER( "--max-frontier SIZE: Memory to keep pending directories as they are ( default: 64M ).  Beyond it they are packed into a compact form." );
+STATIC_CONSTEXPR jig::STRING::Literal USAGE_SHARD( "--shard I/N: Search only the I-th of N parts ( 0 <= I < N ) of the directories, to split one search across processes.  Use with --binary and combine the outputs by lfl merge." );
+STATIC_CONSTEXPR jig::STRING::Literal USAGE_SPLIT_DEPTH( "--split-depth N: Depth of the directories to be split by --shard ( default: 1 )." );
+STATIC_CONSTEXPR jig::STRING::Literal USAGE_MERGE( "lfl merge [options] [file...]: Combine outputs of --binary ( from standard input if no file ).  --count, --sort and the output formats can be used.  To search a directory named merge, write lfl -- merge or lfl .\\merge." );
+STATIC_CONSTEXPR jig::STRING::Literal USAGE_FROM_STDIN( "--from-stdin: Read the paths to check from standard input, one per line ( or terminated by NUL with -0 ), instead of searching directories." );
+STATIC_CONSTEXPR jig::STRING::Literal USAGE_NAME( "--name PATTERN: Report only the entries whose names match PATTERN ( '*' and '?' are wildcards, case-insensitive ). Repeat to match any of them." );
+STATIC_CONSTEXPR jig::STRING::Literal USAGE_MIN_SIZE( "--min-size N: Report only the entries of N bytes or more ( K, M, G and T suffixes are 1024 based )." );
+STATIC_CONSTEXPR jig::STRING::Literal USAGE_MAX_SIZE( "--max-size N: Report only the entries of N bytes or less." );
+STATIC_CONSTEXPR jig::STRING::Literal USAGE_TYPE( "--type file|directory|symlink|other: Report only the entries of the type. Repeat to match any of them." );
+STATIC_CONSTEXPR jig::STRING::Literal USAGE_MTIME_RANGE( "--mtime-range A..B: Report only the entries last written at A or later and before B ( YYYY-MM-DD[THH:MM[:SS]] in UTC; either side may be omitted )." );
+STATIC_CONSTEXPR jig::STRING::Literal USAGE_EXCLUDE( "--exclude PATTERN: Skip the entries matching PATTERN ( .gitignore syntax ). Excluded directories are never opened. Repeat to add more patterns." );
+STATIC_CONSTEXPR jig::STRING::Literal USAGE_EXCLUDE_FROM( "--exclude-from FILE: Read the patterns to skip from FILE, one per line ( .gitignore syntax )." );
+STATIC_CONSTEXPR jig::STRING::Literal USAGE_GITIGNORE( "--gitignore: Also skip the entries ignored by the .gitignore and .ignore files found while searching." );
+STATIC_CONSTEXPR jig::STRING::Literal USAGE_GROUP_BY( "--group-by ext|owner|dir1: Output the --count latest files of every extension, owner or directory just under the search directories, in one search.  Each line is prefixed by the group and a tab." );
+STATIC_CONSTEXPR jig::STRING::Literal USAGE_TREE( "--tree: Output every directory down to --max-depth with the latest entry anywhere beneath it, its time ( UTC ) and its name, in one search of the whole tree.  This implies --recursive." );
+STATIC_CONSTEXPR jig::STRING::Literal USAGE_PER_ROOT( "--per-root: Output the --count latest files of each directory separately, prefixed by the directory and a tab.  The directories are searched at once, and each result is output in the order of the arguments as soon as it and all of the former ones are finished." );
+STATIC_CONSTEXPR jig::STRING::Literal USAGE_ARCHIVES( "--archives: Also report the members of .tar and .zip files as \"archive.tar:member/path\", read from their headers without extraction.  Members have their modification times whatever --time is, and --name applies to their own names." );
+STATIC_CONSTEXPR jig::STRING::Literal USAGE_CACHE( "--cache TTL: Share the output with other lfl processes run with the same arguments on the same directories for TTL ( e.g. 5s ).  A cached output is used without searching while the directories themselves have not been modified.  Changes deep inside them are noticed only after TTL." );
+STATIC_CONSTEXPR jig::STRING::Literal USAGE_MAX_IOPS( "--max-iops N: Issue at most N file system calls per second in total over all threads ( opening or reading a directory, querying an entry, and so on ), to limit the impact on a busy machine." );
+STATIC_CONSTEXPR jig::STRING::Literal USAGE_MAX_DIRS_PER_SEC( "--max-dirs-per-sec N: Open at most N directories per second in total over all threads." );
+STATIC_CONSTEXPR jig::STRING::Literal USAGE_CHECKPOINT( "--checkpoint FILE: Save the progress of the search to FILE every 30 seconds and at the end, so that an interrupted search can be continued with --resume.  To save, the search waits up to 1 second for the directories being read to finish, and skips that save if they do not.  Only with the default output of the --count latest files." );
+STATIC_CONSTEXPR jig::STRING::Literal USAGE_RESUME( "--resume FILE: Continue the search saved to FILE by --checkpoint, reading only the directories not read yet.  The same directories must be given." );
+STATIC_CONSTEXPR jig::STRING::Literal USAGE_THREADS( "--threads N: Number of threads to scan and sort ( default: number of processors with --recursive, otherwise 1 )." );
 
 STATIC_CONSTEXPR jig::STRING::Literal NEW_LINE( "\n" );
 STATIC_CONSTEXPR jig::STRING::Literal DOUBLE_NEW( "\n\n" );
 
-STATIC_CONSTEXPR jig::STRING::Literal HELP_MESSAGE = HELP + DOUBLE_NEW + USAGE_DIRECTORY + NEW_LINE + USAGE_HELP + NEW_LINE + USAGE_VERSION + NEW_LINE;
+STATIC_CONSTEXPR jig::STRING::Literal HELP_MESSAGE = HELP + DOUBLE_NEW + USAGE_DIRECTORY + NEW_LINE + USAGE_COUNT + NEW_LINE + USAGE_TIME + NEW_LINE + USAGE_NULL + NEW_LINE + USAGE_JSON + NEW_LINE + USAGE_BINARY + NEW_LINE + USAGE_SORT + NEW_LINE + USAGE_RECURSIVE + NEW_LINE + USAGE_THREADS + NEW_LINE + USAGE_FOLLOW + NEW_LINE + USAGE_UNIQUE_INODES + NEW_LINE + USAGE_XDEV + NEW_LINE + USAGE_MAX_DEPTH + NEW_LINE + USAGE_ORDER + NEW_LINE + USAGE_DIRBUF + NEW_LINE + USAGE_DEADLINE + NEW_LINE + USAGE_MAX_OPEN + NEW_LINE + USAGE_MAX_FRONTIER + NEW_LINE + USAGE_SHARD + NEW_LINE + USAGE_SPLIT_DEPTH + NEW_LINE + USAGE_FROM_STDIN + NEW_LINE + USAGE_NAME + NEW_LINE + USAGE_MIN_SIZE + NEW_LINE + USAGE_MAX_SIZE + NEW_LINE + USAGE_TYPE + NEW_LINE + USAGE_MTIME_RANGE + NEW_LINE + USAGE_EXCLUDE + NEW_LINE + USAGE_EXCLUDE_FROM + NEW_LINE + USAGE_GITIGNORE + NEW_LINE + USAGE_GROUP_BY + NEW_LINE + USAGE_TREE + NEW_LINE + USAGE_PER_ROOT + NEW_LINE + USAGE_ARCHIVES + NEW_LINE + USAGE_CACHE + NEW_LINE + USAGE_MAX_IOPS + NEW_LINE + USAGE_MAX_DIRS_PER_SEC + NEW_LINE + USAGE_CHECKPOINT + NEW_LINE + USAGE_RESUME + NEW_LINE + USAGE_HELP + NEW_LINE + USAGE_VERSION + DOUBLE_NEW + USAGE_MERGE + NEW_LINE;
 
-template<jig::STRING::Literal MESSAGE, typename CharT, typename Traits>
-constexpr void Display( std::basic_ostream<CharT, Traits> & ost ) { ost << MESSAGE << std::endl; }
+// 一行ごとにはフラッシュしない。フラッシュはmainの終了時か、明示的に行う。
+template<jig::STRING::Literal MESSAGE, typename Writer>
+constexpr void Display( Writer & writer ) { writer << MESSAGE << '\n'; }
 
 } // message
 
-enum class PathTag {
-  ARG,
-  NON_ARG,
-  IMPLICIT,
-  NUM
-};
-
 bool isDotDirectory( std::string const & directory_path ) {
   // パスの構成要素に'.'かDELIMITER以外が見つかったら、
   // その時点でカレントディレクトリや親ディレクトリそのものを
@@ -73,403 +115,441 @@ bool isDirectory( std::string const & path ) {
   // その時点でWindows APIを使うまでもなくディレクトリだと分かる。
   if ( isDotDirectory( path ) ) { return 1; }
 
-  return( PathIsDirectory( path.c_str() ) );
-}
-
-// Ensure the path exists.
-class Path {
-public:
-  Path() : path_( "" ), exist_( 0 ) {}
-  Path( std::string const &, PathTag );
-  ~Path();
-
-  Path( const Path & obj ) = default;
-  Path & operator = ( const Path & obj ) = delete;
-  Path( Path && obj ) noexcept = default;
-  Path & operator = ( Path && obj ) noexcept = delete;
-
-  std::string getPath() const noexcept { return path_; }
-  PathTag getTag() const noexcept { return tag_; }
-  bool isExist() const noexcept { return exist_; }
-private:
-  std::string path_;
-  PathTag tag_;
-  // Windows API はなるべく呼び出したくないので、
-  // すでに検査したパスはもう一度検査しなくてもいいと示したい。
-  const bool exist_;
-
-  bool checkExist() const noexcept;
-};
-
-Path::Path( std::string const & path, PathTag tag )
-: path_( path ), tag_( tag ), exist_( checkExist() ) {
-  // If the path is directory, add path-delimiter into back of argument.
-  if ( ( path.back() != DELIMITER ) && isDirectory( path ) ) {
-    path_ += DELIMITER;
-  }
-}
-
-Path::~Path() {
+  // shlwapi.dll(PathIsDirectory)を読み込むと起動が遅くなるので、kernel32.dllの関数で調べる。
+  DWORD const attributes = GetFileAttributes( path.c_str() );
+  return ( attributes != INVALID_FILE_ATTRIBUTES ) && ( attributes & FILE_ATTRIBUTE_DIRECTORY );
 }
 
-bool Path::checkExist() const noexcept { return PathFileExists( path_.c_str() ); }
-
-// enum class OptionKey {
-//   DIRECTORY,
-//   HELP,
-//   NUM
-// };
-
-class CmdArg {
-public:
-  constexpr explicit CmdArg( char const *, bool const );
-  constexpr CmdArg( CmdArg const & ) = default;
-  constexpr CmdArg & operator=( CmdArg const & ) = default;
-  constexpr CmdArg( CmdArg && ) noexcept = default;
-  constexpr CmdArg & operator=( CmdArg && ) noexcept = default;
-  constexpr ~CmdArg();
-
-  constexpr inline std::string const & str() const noexcept { return arg_; }
-  constexpr inline bool isOption() const noexcept { return is_option_; }
-  constexpr inline bool isBinomial() const noexcept { return is_binomial_; }
-private:
-  std::string arg_;
-  bool is_option_;
-  bool is_binomial_;
-};
-
-constexpr CmdArg::CmdArg( char const * arg, bool const has_option_specifier )
-: arg_( arg ), is_option_( false ), is_binomial_( false ) {
-  if ( has_option_specifier ) {
-    auto [ is_option, option_index ] = option_list.matchIndex( arg );
-    is_option_ = is_option;
-
-    // 現状では、二項オプションかどうかは、
-    // option_listの添字で判断するしかない。
-    if ( is_option ) {
-      if ( !( option_index == 0 || option_index == 1 ) ) { is_binomial_ = true; }
+// lfl merge: --binaryで出力された部分結果(--shardの各組の出力など)をまとめる。
+// 入力のファイルは、ディレクトリと同じ位置(--directory)で受け取る。
+int mergePartials( lfl::Options const & options ) {
+  auto & out = lfl::OUTPUT::Out();
+  auto & err = lfl::OUTPUT::Err();
+
+  std::vector<std::string> inputs;
+  for ( auto const itr : options.directories ) { inputs.emplace_back( itr ); }
+  if ( inputs.empty() ) { inputs.emplace_back( "-" ); }
+
+  lfl::TopK top( options.count );
+  std::vector<lfl::Entry> all;
+  bool has_error = false;
+
+  std::string contents;
+  lfl::Entry entry;
+  for ( auto const & itr : inputs ) {
+    if ( !lfl::INPUT::ReadAll( itr, contents ) ) {
+      err << itr << ": cannot read the file\n";
+      has_error = true;
+      continue;
     }
-  }
-}
-
-constexpr CmdArg::~CmdArg() {}
-
-class CmdParse {
-public:
-  using value_type = CmdArg;
-  using container_type = std::vector<value_type>;
-
-  constexpr CmdParse( int const, char const *[] );
-  constexpr CmdParse( CmdParse const & ) = default;
-  constexpr CmdParse & operator=( CmdParse const & rhs ) = default;
-  constexpr CmdParse( CmdParse && ) = default;
-  constexpr CmdParse & operator=( CmdParse && ) = default;
-  constexpr ~CmdParse();
-
-  constexpr std::pair<std::string, std::string> get();
-
-  constexpr inline bool isThereHelp() const noexcept { return ( first_help_index_ ); }
-  constexpr inline bool next() noexcept {
-    index_ += ( arg_list_[index_].isBinomial() ) ? 2 : 1;
-    return ( index_ >= arg_list_.size() );
-  }
 
-  // constexpr inline bool isEnd() const noexcept { return ( index_ == arg_list_.size() - 1 ); }
-private:
-  std::size_t index_;
-  container_type arg_list_;
-  int first_help_index_;
-
-  // constexpr inline std::size_t lengthAsOption( char const * str ) const noexcept { auto [ ptr, length ] = option_list.isMatch( str ); return ptr != nullptr ? length : 0; }
-};
-
-// 何個目が二項オプションか、単項オプションか、あるいは、それはオプションかどうか
-// といったような、指定されたオプションの構造を調べる。
-constexpr CmdParse::CmdParse( int const arg_count, char const * arg_chars[] )
-:index_( 0 ), first_help_index_( -1 ) {
-  // オプションの構造解析フェーズ
-  for ( std::size_t arg_index = 1; arg_index < arg_count; ++arg_index ) {
-    // この時点ではまだ、arg_chars[arg_index]に"--"が付けられているのか、
-    // 付けられていないのかが分からない。
-    if ( !std::strncmp( arg_chars[arg_index], OPTION_SPECIFIER, NULL_EXCLUDE_OS_LENGTH ) ) {
-      arg_list_.emplace_back( CmdArg( arg_chars[arg_index] + NULL_EXCLUDE_OS_LENGTH, true ) );
-    } else {
-      arg_list_.emplace_back( CmdArg( arg_chars[arg_index], false ) );
-    }
-  }
-
-  // --helpがコマンドライン引数に含まれているかどうかを調べる。
-  auto it = std::find_if( arg_list_.begin(), arg_list_.end(), []( CmdArg const & arg ){ return arg.str() == "help"; } );
-  if ( !( it == arg_list_.end() ) ) { first_help_index_ = std::distance( arg_list_.begin(), it ); }
-}
-
-constexpr CmdParse::~CmdParse() {}
-
-constexpr std::pair<std::string, std::string> CmdParse::get() {
-  if ( index_ == arg_list_.size() ) { return std::pair( "", "" ); }
-
-  // return in help mode
-  if ( first_help_index_ != -1 ) {
-    if ( arg_list_[index_].str() == "help" ) {
-      if ( arg_list_.size() == 1 ) {
-        return std::pair( "help", "all" );
+    bool const is_valid = lfl::FORMAT::ReadBinaryEntries( contents, entry, [ & ]( lfl::Entry const & read ) {
+      if ( options.sort ) {
+        all.emplace_back( read );
       } else {
-        return std::pair( "help", ( index_ == first_help_index_ ) ? "" : arg_list_[index_].str() );
+        top.offer( lfl::Entry( read ) );
       }
-    }
-
-    return std::pair( "help", arg_list_[index_].str() );
-  }
+    } );
 
-  // return in NOT help mode
-  if ( arg_list_[index_].isOption() ) {
-    if ( arg_list_[index_].isBinomial() ) {
-      return std::pair( arg_list_[index_].str(), arg_list_[index_ + 1].str() );
-    } else {
-      return std::pair( arg_list_[index_].str(), "" );
+    if ( !is_valid ) {
+      err << itr << ": is not a binary output of lfl\n";
+      has_error = true;
     }
   }
+  err.flush();
 
-  return std::pair( "directory", arg_list_[index_].str() );
-}
+  lfl::BeginEntries( out, options.format );
 
-class CmdLine {
-public:
-  constexpr CmdLine( int const, char const * [] );
-  constexpr ~CmdLine();
-
-  constexpr int argNum() const noexcept { return options_.size(); }
-  constexpr std::vector<std::string> optionList( std::string const & );
-
-  template<std::size_t N>
-  constexpr bool isThere( char const (&)[N] ) const noexcept;
-private:
-  // このstd::pairの役割は基本的にはstd::mapと同じだが、
-  // ディレクトリが複数指定される可能性もある。
-  // そのため、キーの重複が許可されている必要があるので、
-  // std::mapは使えない。
-  std::vector<std::pair<std::string, std::string>> options_;
-};
-
-constexpr CmdLine::CmdLine( int const arg_count, char const * arg_chars [] ) {
-  try {
-    // コマンドライン上で与えられたすべての文字列を読み込むと前提している。
-    // そのため、与えられた文字列が一つだけのときは、
-    // 実行パス以外には何も指定されていないということ(=オプションが指定されていない)。
-    if ( arg_count != 1 ) {
-      CmdParse parse( arg_count, arg_chars );
-      do { options_.emplace_back( parse.get() ); } while( !parse.next() );
-    } else {
-      // for ( std::size_t arg_index = 1; arg_index < arg_count; ++arg_index ) {
-      //   options_.emplace_back( arg_chars[arg_index] );
-      // }
-    }
-  } catch ( ... ) {
-    throw;
-  }
-}
-
-constexpr CmdLine::~CmdLine() {}
-
-constexpr std::vector<std::string> CmdLine::optionList( std::string const & key ) {
-  std::vector<std::string> option_list;
-
-  for ( auto itr : options_ ) {
-    if ( itr.first == key ) { option_list.emplace_back( itr.second ); }
-  }
-
-  return option_list;
-}
-
-template<std::size_t N>
-constexpr bool CmdLine::isThere( char const ( & option )[N] ) const noexcept {
-  for ( auto itr : options_ ) {
-    if ( std::strncmp( itr.first.c_str(), option, N ) == 0 ) { return true; }
-  }
-
-  return false;
-}
-
-class Time : public UTIL::COMPARABLE::CompDef<Time> {
-public:
-  Time() = default;
-  Time( FILETIME const & );
-  ~Time();
-
-  Time( const Time & obj ) { *this = obj; }
-  Time & operator = ( const Time & obj ) {
-    if ( this != &obj ) {
-      memcpy( &time_, &obj, sizeof( FILETIME ) );
-    }
-    return *this;
-  }
-
-  Time & operator = ( const FILETIME & obj ) {
-    memcpy( &time_, &obj, sizeof( FILETIME ) );
-    return *this;
-  }
-
-  Time( Time && obj ) noexcept = default;
-  Time & operator = ( Time && obj ) noexcept = default;
-
-  FILETIME getFileTime() const noexcept { return time_; }
-
-  friend bool operator < ( Time const & time1, Time const & time2 ) noexcept {
-    // HighDateTimeに差があればその時点で大小関係が確定する。
-    if ( time1.time_.dwHighDateTime != time2.time_.dwHighDateTime ) {
-      return( time1.time_.dwHighDateTime < time2.time_.dwHighDateTime );
-    } else {
-      // HighDateTimeで大小関係が決まらなければ、LowDateTimeで大小関係を決める必要がある。
-      return( time1.time_.dwLowDateTime < time2.time_.dwLowDateTime );
-    }
+  if ( options.sort ) {
+    std::stable_sort( all.begin(), all.end(), lfl::NewerFirst() );
+    for ( auto const & itr : all ) { lfl::WriteEntry( out, itr, options.format ); }
+  } else {
+    for ( auto const & itr : top.take() ) { lfl::WriteEntry( out, itr, options.format ); }
   }
-private:
-  FILETIME time_;
-};
-
-Time::Time( FILETIME const & time ) {
-  memcpy( &time_, &time, sizeof(FILETIME) );
-}
-
-Time::~Time() {
-}
-
-void makeCandidate( std::vector<std::string> & candidate_directories, Path const & directory_path ) {
-  PathTag tag = directory_path.getTag();
-  std::string path_str = directory_path.getPath();
+  out.flush();
 
-  if ( directory_path.isExist() == true ) {
-    if ( ( tag == PathTag::ARG ) || ( tag == PathTag::IMPLICIT ) ) {
-      candidate_directories.emplace_back( path_str );
-    } else if ( !isDotDirectory( path_str ) ) {
-      candidate_directories.emplace_back( path_str );
-    }
-  }
+  return has_error ? -1 : 0;
 }
 
 int main( int argc, char const * argv [] ) {
-  std::vector<Path *> path_list;
+  // 標準出力への書き込みはすべてこのバッファを経由させる。
+  auto & out = lfl::OUTPUT::Out();
+  auto & err = lfl::OUTPUT::Err();
+
+  lfl::Options options;
 
   /* build paths list */
+  // 最初の引数が"merge"なら、走査せずに部分結果をまとめる。
+  bool const is_merge = lfl::IsMergeCommand( argc, argv );
+
   try {
-    CmdLine cmd_line( argc, argv );
+    lfl::CmdLine cmd_line( is_merge ? argc - 1 : argc, is_merge ? argv + 1 : argv );
+    options = lfl::ParseOptions( cmd_line );
 
-    if ( cmd_line.isThere( "help" ) ) {
+    if ( options.help ) {
       using namespace message;
 
-      auto help_list = cmd_line.optionList( "help" );
+      auto const & help_list = options.help_topics;
 
       if ( help_list.size() == 1 ) {
-        Display<HELP_MESSAGE>( std::cout );
+        Display<HELP_MESSAGE>( out );
       } else {
-        for ( auto itr : help_list ) {
-          if ( itr == "help" ) { Display<USAGE_HELP>( std::cout ); }
-          if ( itr == "version" ) { Display<USAGE_VERSION>( std::cout ); }
-          if ( itr == "directory" ) { Display<USAGE_DIRECTORY>( std::cout ); }
+        for ( auto const itr : help_list ) {
+          if ( itr == "help" ) { Display<USAGE_HELP>( out ); }
+          if ( itr == "version" ) { Display<USAGE_VERSION>( out ); }
+          if ( itr == "directory" ) { Display<USAGE_DIRECTORY>( out ); }
+          if ( itr == "count" ) { Display<USAGE_COUNT>( out ); }
+          if ( itr == "time" ) { Display<USAGE_TIME>( out ); }
+          if ( itr == "null" ) { Display<USAGE_NULL>( out ); }
+          if ( itr == "json" ) { Display<USAGE_JSON>( out ); }
+          if ( itr == "binary" ) { Display<USAGE_BINARY>( out ); }
+          if ( itr == "sort" ) { Display<USAGE_SORT>( out ); }
+          if ( itr == "recursive" ) { Display<USAGE_RECURSIVE>( out ); }
+          if ( itr == "threads" ) { Display<USAGE_THREADS>( out ); }
+          if ( itr == "follow" ) { Display<USAGE_FOLLOW>( out ); }
+          if ( itr == "unique-inodes" ) { Display<USAGE_UNIQUE_INODES>( out ); }
+          if ( itr == "xdev" ) { Display<USAGE_XDEV>( out ); }
+          if ( itr == "max-depth" ) { Display<USAGE_MAX_DEPTH>( out ); }
+          if ( itr == "order" ) { Display<USAGE_ORDER>( out ); }
+          if ( itr == "dirbuf" ) { Display<USAGE_DIRBUF>( out ); }
+          if ( itr == "deadline" ) { Display<USAGE_DEADLINE>( out ); }
+          if ( itr == "max-open" ) { Display<USAGE_MAX_OPEN>( out ); }
+          if ( itr == "max-frontier" ) { Display<USAGE_MAX_FRONTIER>( out ); }
+          if ( itr == "shard" ) { Display<USAGE_SHARD>( out ); }
+          if ( itr == "split-depth" ) { Display<USAGE_SPLIT_DEPTH>( out ); }
+          if ( itr == "from-stdin" ) { Display<USAGE_FROM_STDIN>( out ); }
+          if ( itr == "name" ) { Display<USAGE_NAME>( out ); }
+          if ( itr == "min-size" ) { Display<USAGE_MIN_SIZE>( out ); }
+          if ( itr == "max-size" ) { Display<USAGE_MAX_SIZE>( out ); }
+          if ( itr == "type" ) { Display<USAGE_TYPE>( out ); }
+          if ( itr == "mtime-range" ) { Display<USAGE_MTIME_RANGE>( out ); }
+          if ( itr == "exclude" ) { Display<USAGE_EXCLUDE>( out ); }
+          if ( itr == "exclude-from" ) { Display<USAGE_EXCLUDE_FROM>( out ); }
+          if ( itr == "gitignore" ) { Display<USAGE_GITIGNORE>( out ); }
+          if ( itr == "group-by" ) { Display<USAGE_GROUP_BY>( out ); }
+          if ( itr == "tree" ) { Display<USAGE_TREE>( out ); }
+          if ( itr == "per-root" ) { Display<USAGE_PER_ROOT>( out ); }
+          if ( itr == "archives" ) { Display<USAGE_ARCHIVES>( out ); }
+          if ( itr == "cache" ) { Display<USAGE_CACHE>( out ); }
+          if ( itr == "max-iops" ) { Display<USAGE_MAX_IOPS>( out ); }
+          if ( itr == "max-dirs-per-sec" ) { Display<USAGE_MAX_DIRS_PER_SEC>( out ); }
+          if ( itr == "checkpoint" ) { Display<USAGE_CHECKPOINT>( out ); }
+          if ( itr == "resume" ) { Display<USAGE_RESUME>( out ); }
         }
       }
       return 0;
     }
 
-    if ( cmd_line.isThere( "version" ) ) {
+    if ( options.version ) {
       using namespace message;
-      Display<VERSION>( std::cout );
+      Display<VERSION>( out );
       return 0;
     }
 
-    if ( cmd_line.argNum() == 0 ) {
-      path_list.emplace_back( new Path( ".\\", PathTag::IMPLICIT ) );
-    } else if ( cmd_line.argNum() > 2 ) {
-      std::cout << "yet unimplemented" << std::endl;
-      return 0;
-    } else {
-      std::vector<std::string> directory_list = cmd_line.optionList( "directory" );
-
-      for ( auto itr : directory_list ) {
-        path_list.emplace_back( new Path( itr, PathTag::ARG ) );
-      }
-    }
+    if ( is_merge ) { return mergePartials( options ); }
   } catch ( std::invalid_argument const & e ) {
     using namespace message;
-    std::cerr << e.what() << std::endl;
-
-    Display<HELP_MESSAGE>( std::cerr );
+    err << e.what() << '\n';
 
-    for ( auto itr : path_list ) { if ( itr != nullptr ) { delete itr; } }
+    Display<HELP_MESSAGE>( err );
 
     return -1;
   } catch ( std::exception const & e ) {
-    std::cerr << "error was occured: " << e.what() << std::endl;
-
-    for ( auto itr : path_list ) { if ( itr != nullptr ) { delete itr; } }
+    err << "error was occured: " << e.what() << '\n';
 
     return -1;
   }
 
-  // 存在することが確定したパスだけを判定候補に含める
+  // 存在することが確定したディレクトリだけを判定候補に含める(区切り文字で終わる形にそろえる)。
+  // パスの一覧を標準入力から受け取るときは、ディレクトリは使わない。
+  // --cacheのときは、起点がディレクトリかどうかを確かめる問い合わせで、起点の更新時刻も集める。
+  bool const wants_cache = ( options.cache_ttl.count() != 0 );
+  lfl::CACHE::Hasher cache_stamper;
+  bool is_stamped = wants_cache;
   std::vector<std::string> exist_directories;
-  for ( auto itr : path_list ) {
-    if ( isDirectory( itr->getPath() ) ) {
-      makeCandidate( exist_directories, *itr );
+  if ( !options.from_stdin ) {
+    if ( options.directories.empty() ) {
+      exist_directories.emplace_back( ".\\" );
+      if ( wants_cache ) { is_stamped = lfl::CACHE::StampDirectory( exist_directories.back(), cache_stamper ); }
     } else {
-      std::cerr << itr->getPath() << ": is NOT exist" << std::endl;
+      exist_directories.reserve( options.directories.size() );
+
+      for ( auto const itr : options.directories ) {
+        std::string path( itr );
+        if ( !( wants_cache ? lfl::CACHE::StampDirectory( path, cache_stamper ) : isDirectory( path ) ) ) {
+          err << path << ": is NOT exist\n";
+          continue;
+        }
+
+        if ( !path.empty() && path.back() != DELIMITER ) { path += DELIMITER; }
+        exist_directories.emplace_back( std::move( path ) );
+      }
     }
   }
+  err.flush();
+
+  // --from-stdin: 一覧をまとめて読み込み、パスは読み込んだ領域を参照するだけにする。
+  // -0が指定されていれば'\0'区切り(git ls-files -zなど)、そうでなければ改行区切り。
+  std::string stdin_contents;
+  std::vector<std::string_view> stdin_paths;
+  if ( options.from_stdin ) {
+    if ( !lfl::INPUT::ReadAll( "-", stdin_contents ) ) {
+      err << "cannot read the standard input\n";
+      err.flush();
+      return -1;
+    }
+
+    char const delimiter = ( options.format == lfl::Format::NUL ) ? '\0' : '\n';
+    lfl::INPUT::ForEachRecord( stdin_contents, delimiter, [ &stdin_paths ]( std::string_view const path ){ stdin_paths.emplace_back( path ); } );
+  }
 
   // 検査ディレクトリの数が0だったら、これ以上処理を進める必要は無い。
   // コマンドライン引数でディレクトリが指定されているが、
   // そのディレクトリがすべて見つからなかった場合、
   // 検査ディレクトリの数が0になる可能性がある。
-  if ( exist_directories.size() == 0 ) {
-    std::cout << "There are not any paths to check." << std::endl;
-
-    // for ( auto itr : path_list ) { delete itr; }
+  if ( ( options.from_stdin ? stdin_paths.size() : exist_directories.size() ) == 0 ) {
+    out << "There are not any paths to check.\n";
 
     return -2;
   }
 
-  WIN32_FIND_DATA path_data;
-  HANDLE hFind;
+  // --cache: 同じ問い合わせの結果が共有メモリにあれば、起点を確かめたときの更新時刻と比べるだけで答える。
+  lfl::CACHE::SharedSegment cache;
+  std::uint64_t cache_key = 0;
+  std::uint64_t const cache_stamp = cache_stamper.value();
+  std::string cached_output;
+  bool const use_cache = is_stamped && cache.open();
+  if ( use_cache ) {
+    cache_key = lfl::CACHE::MakeKey( exist_directories, argc, argv );
 
-  /* display the file-name had the latest ftLastWriteTime. */
-  Time path_time;
-  std::string latest_write_path = "";
+    std::uint64_t const ttl_ns = static_cast<std::uint64_t>( std::chrono::duration_cast<std::chrono::nanoseconds>( options.cache_ttl ).count() );
+    if ( lfl::CACHE::Load( *cache.get(), cache_key, cache_stamp, lfl::CACHE::Now(), ttl_ns, cached_output ) ) {
+      out << cached_output;
+      out.flush();
 
-  for ( auto itr : exist_directories ) {
-    std::string wildcard_path = itr + "*";
-    hFind = FindFirstFile( wildcard_path.c_str(), &path_data );
+      return 0;
+    }
 
-    if ( hFind == INVALID_HANDLE_VALUE ) {
-      std::cerr << "INVALID_HANDLE_VALUE" << std::endl;
+    // 保存できる大きさを超えたら、写すのをやめる。
+    out.capture( &cached_output, lfl::CACHE::SLOT_CAPACITY );
+  }
 
-      FindClose( hFind );
-      for ( auto itr : path_list ) { delete itr; }
+  // --threadsが指定されていなければ、サブディレクトリまで走査するときと、一覧のパスを調べるときだけ並列にする。
+  std::size_t const thread_num = ( options.threads != 0 ) ? options.threads : ( ( options.recursive || options.from_stdin ) ? lfl::DefaultThreadNum() : 1 );
+
+  lfl::ScanConfig config;
+  config.time_field = options.time_field;
+  config.recursive = options.recursive;
+  config.follow_links = options.follow_links;
+  config.unique_inodes = options.unique_inodes;
+  config.one_file_system = options.one_file_system;
+  // --treeでは、--max-depthは一覧に出す深さで、走査はその下まで行う。
+  config.max_depth = options.tree ? lfl::UNLIMITED_DEPTH : options.max_depth;
+  config.order = options.order;
+  config.directory_buffer_size = options.directory_buffer_size;
+  config.deadline = options.deadline;
+  config.max_open = options.max_open;
+  config.max_frontier = options.max_frontier;
+  config.shard = options.shard;
+  config.split_depth = options.split_depth;
+  config.filter = lfl::Filter( options.filter );
+  config.gitignore = options.gitignore;
+  config.query_owner = ( options.group_by == lfl::GroupBy::OWNER );
+  config.archives = options.archives;
+  config.max_iops = options.max_iops;
+  config.max_directories_per_second = options.max_directories_per_second;
+
+  // --exclude-fromのファイルは.gitignoreと同じく一行に一つの規則。規則は中身をコピーして持つ。
+  for ( auto const itr : options.excludes ) { config.exclude.add( itr ); }
+  for ( auto const itr : options.exclude_files ) {
+    std::string contents;
+    if ( !lfl::INPUT::ReadAll( std::string( itr ), contents ) ) {
+      err << itr << ": cannot read the exclude file\n";
+      err.flush();
 
       return -1;
     }
 
-    /* この時点ですでに、最終更新時刻の検査対象だけのリストが完成しておいてほしい */
-    do {
-      // ここでほしいのは大小関係だけなので、ローカルタイムに変換したり、
-      // SYSTEMTIME構造体に変換したりする必要はない。
-      Time current_path_write = path_data.ftLastWriteTime;
+    lfl::INPUT::ForEachRecord( contents, '\n', [ &config ]( std::string_view const line ){ config.exclude.add( line ); } );
+  }
 
-      if ( !isDotDirectory( path_data.cFileName ) ) {
-        // debug
-        // std::cout << path_data.ftLastWriteTime.dwHighDateTime << ", " << path_data.ftLastWriteTime.dwLowDateTime << " : " << path_data.cFileName << std::endl;
-        // std::cout << path_time.getFileTime().dwHighDateTime << ", " << path_time.getFileTime().dwLowDateTime << " : " << latest_write_path << std::endl;
+  // --resume: 保存した状態は、同じ起点について保存したものだけを使う。
+  lfl::CHECKPOINT::State resumed;
+  if ( !options.resume_file.empty() ) {
+    std::string contents;
+    if ( !lfl::INPUT::ReadAll( std::string( options.resume_file ), contents ) ) {
+      err << options.resume_file << ": cannot read the checkpoint\n";
+      err.flush();
+
+      return -1;
+    }
+    if ( !lfl::CHECKPOINT::Decode( contents, resumed ) ) {
+      err << options.resume_file << ": not a checkpoint of lfl\n";
+      err.flush();
 
-        if ( path_time < current_path_write ) { path_time = current_path_write; latest_write_path = path_data.cFileName; }
+      return -1;
+    }
+    if ( resumed.roots != exist_directories ) {
+      err << options.resume_file << ": the checkpoint was saved for other directories\n";
+      err.flush();
+
+      return -1;
+    }
+  }
+
+  lfl::BeginEntries( out, options.format );
+
+  auto const scan = [ & ]( std::vector<lfl::Sink *> const & sinks ) {
+    return options.from_stdin ? lfl::ScanPaths( config, stdin_paths, sinks ) : lfl::Scan( config, exist_directories, sinks );
+  };
+
+  lfl::ScanResult result;
+
+  if ( options.tree ) {
+    /* display the latest entry beneath every directory down to --max-depth */
+    std::vector<lfl::TreeRollup> tree_list;
+    std::vector<lfl::Sink *> sinks;
+    tree_list.reserve( thread_num );
+    for ( std::size_t index = 0; index < thread_num; ++index ) { sinks.emplace_back( &tree_list.emplace_back( options.max_depth, options.count ) ); }
+
+    result = scan( sinks );
+
+    lfl::TreeRollup & tree = tree_list.front();
+    for ( std::size_t index = 1; index < tree_list.size(); ++index ) { tree.merge( std::move( tree_list[index] ) ); }
+
+    for ( auto & node : tree.take() ) {
+      std::vector<lfl::Entry> const entries = node.top.take();
+      if ( entries.empty() ) { lfl::WriteTreeEntry( out, node.directory, nullptr, options.format ); }
+      for ( auto const & itr : entries ) { lfl::WriteTreeEntry( out, node.directory, &itr, options.format ); }
+    }
+  } else if ( options.per_root ) {
+    /* display the latest files of every directory in the order of the arguments */
+    std::size_t const root_num = exist_directories.size();
+    std::vector<lfl::RootTopK> root_list( thread_num, lfl::RootTopK( root_num, options.count ) );
+    std::vector<lfl::Sink *> sinks;
+    for ( auto & itr : root_list ) { sinks.emplace_back( &itr ); }
+
+    // 読み終えた起点は、それより前の起点がすべて出力されるまで出力せずにおく。
+    std::mutex mutex;
+    std::vector<bool> is_done( root_num, false );
+    std::size_t next_root = 0;
+    config.on_root_done = [ & ]( std::size_t const root ) {
+      std::lock_guard<std::mutex> lock( mutex );
+      is_done[root] = true;
+
+      for ( ; next_root < root_num && is_done[next_root]; ++next_root ) {
+        lfl::TopK & top = root_list.front().root( next_root );
+        for ( std::size_t index = 1; index < root_list.size(); ++index ) { top.merge( std::move( root_list[index].root( next_root ) ) ); }
+
+        for ( auto const & itr : top.take() ) { lfl::WriteGroupEntry( out, exist_directories[next_root], itr, options.format ); }
+        out.flush();
       }
-    } while ( FindNextFile( hFind, &path_data ) != 0 );
+    };
+
+    result = scan( sinks );
+  } else if ( options.group_by != lfl::GroupBy::NONE ) {
+    /* display the latest files of every group */
+    std::vector<lfl::GroupedTopK> group_list( thread_num, lfl::GroupedTopK( options.group_by, options.count ) );
+    std::vector<lfl::Sink *> sinks;
+    for ( auto & itr : group_list ) { sinks.emplace_back( &itr ); }
+
+    result = scan( sinks );
+
+    lfl::GroupedTopK & groups = group_list.front();
+    for ( std::size_t index = 1; index < group_list.size(); ++index ) { groups.merge( std::move( group_list[index] ) ); }
+
+    for ( auto & group : groups.take() ) {
+      for ( auto const & itr : group.top.take() ) { lfl::WriteGroupEntry( out, group.key, itr, options.format ); }
+    }
+  } else if ( options.sort ) {
+    /* display all of the entries in descending order of time */
+    std::vector<lfl::EntryTable> tables( thread_num );
+    std::vector<lfl::Sink *> sinks;
+    for ( auto & itr : tables ) { sinks.emplace_back( &itr ); }
+
+    result = scan( sinks );
+
+    lfl::EntryTable & table = tables.front();
+    for ( std::size_t index = 1; index < tables.size(); ++index ) { table.merge( std::move( tables[index] ) ); }
+
+    // 並べ替えるのは(時刻, 添字)の組だけで、パスは出力するときに組み立てる。
+    std::vector<lfl::SortKey> keys( table.size() );
+    for ( std::size_t index = 0; index < keys.size(); ++index ) { keys[index] = lfl::SortKey{ lfl::NewerFirstKey( table.row( index ).time ), index }; }
+    lfl::RadixSort( keys, thread_num );
+
+    lfl::Entry entry;
+    for ( auto const & itr : keys ) {
+      table.assign( entry, itr.index );
+      lfl::WriteEntry( out, entry, options.format );
+    }
+  } else {
+    /* display the file-names had the latest time. */
+    std::vector<lfl::TopK> top_list( thread_num, lfl::TopK( options.count ) );
+    std::vector<lfl::Sink *> sinks;
+    for ( auto & itr : top_list ) { sinks.emplace_back( &itr ); }
+
+    // 続きから走査するときは、保存しておいた上位count件から始める。
+    for ( auto & itr : resumed.entries ) { top_list.front().offer( std::move( itr ) ); }
+
+    // --checkpoint: 走査を止めている間は上位count件を写すだけにして、符号化と書き込みは再開してから行う。
+    lfl::CHECKPOINT::State checkpoint;
+    std::string checkpoint_data;
+    auto const save_checkpoint = [ & ] {
+      lfl::CHECKPOINT::Encode( checkpoint, checkpoint_data );
+      if ( !lfl::CHECKPOINT::WriteAtomically( std::string( options.checkpoint_file ), checkpoint_data ) ) {
+        err << options.checkpoint_file << ": cannot write the checkpoint\n";
+        err.flush();
+      }
+    };
+    if ( !options.checkpoint_file.empty() ) {
+      checkpoint.roots = exist_directories;
+      config.checkpoint.interval = lfl::CHECKPOINT::INTERVAL;
+      config.checkpoint.max_pause = lfl::CHECKPOINT::MAX_PAUSE;
+      config.checkpoint.capture = [ & ] {
+        lfl::TopK snapshot( options.count );
+        for ( auto const & itr : top_list ) { snapshot.merge( itr ); }
+        checkpoint.entries = snapshot.take();
+      };
+      config.checkpoint.save = [ & ]( std::vector<lfl::DirectoryJob> && frontier, std::vector<std::string> && errors ) {
+        checkpoint.frontier = std::move( frontier );
+        checkpoint.errors = resumed.errors;
+        for ( auto & itr : errors ) { checkpoint.errors.emplace_back( std::move( itr ) ); }
+        save_checkpoint();
+      };
+    }
+
+    result = options.resume_file.empty() ? scan( sinks ) : lfl::Resume( config, std::move( resumed.frontier ), sinks );
+    // 保存する前に読めなかったディレクトリも、続けた走査の結果に含める。
+    result.errors.insert( result.errors.begin(), resumed.errors.begin(), resumed.errors.end() );
+
+    lfl::TopK & top = top_list.front();
+    for ( std::size_t index = 1; index < top_list.size(); ++index ) { top.merge( std::move( top_list[index] ) ); }
+
+    std::vector<lfl::Entry> const entries = top.take();
+    for ( auto const & itr : entries ) { lfl::WriteEntry( out, itr, options.format ); }
+
+    // 最後まで読めたら、読み込み待ちの無い状態を保存する(続けても、同じ結果をすぐに出力する)。
+    if ( !options.checkpoint_file.empty() && !result.is_approximate ) {
+      checkpoint.entries = entries;
+      checkpoint.frontier.clear();
+      checkpoint.errors = result.errors;
+      save_checkpoint();
+    }
+  }
+  out.flush();
 
-    FindClose( hFind );
+  // 読めなかったディレクトリがあったり、時間切れだったりした結果は、他のプロセスに渡さない。
+  if ( use_cache && out.isCapturing() && out.good() && result.errors.empty() && !result.is_approximate ) {
+    // 起点の更新時刻は走査の前に調べたものなので、走査の間に起点が変わっていれば、この結果は次の問い合わせで使われない。
+    lfl::CACHE::Store( *cache.get(), cache_key, cache_stamp, lfl::CACHE::Now(), cached_output );
   }
+  out.capture( nullptr, 0 );
 
-  for ( auto itr : path_list ) { delete itr; }
+  for ( auto const & itr : result.errors ) { err << itr << ( options.from_stdin ? ": cannot read the file\n" : ": cannot read the directory\n" ); }
+  if ( result.is_approximate ) { err << "the deadline has passed: the result is approximate\n"; }
+  err.flush();
 
-  /* display the latest updated file name */
-  std::cout << latest_write_path << std::endl;
+  if ( !result.errors.empty() ) { return -1; }
 
-  return 0;
+  return result.is_approximate ? -3 : 0;
 }
@@ -0,0 +1,137 @@
+/****************************************
+ * MemoryFileSystem.cpp
+ *
+ * lfl/MemoryFileSystem.hppの呼び出し(FILE_FULL_DIR_INFOの並びの書き込み)
+ *****************************************/
+
+#include "lfl/MemoryFileSystem.hpp"
+
+// std
+#include <cstddef>
+#include <windows.h>
+
+namespace lfl {
+
+void * MemoryFileSystem::openDirectory( std::string const & path ) {
+  opens_.fetch_add( 1, std::memory_order_relaxed );
+  delay();
+
+  // 途中で失敗させるディレクトリは、開くことはできる。
+  Injection const * const injection = faultOf( path );
+  if ( injection != nullptr && injection->after == 0 ) { return nullptr; }
+
+  Node const * const directory = resolve( path );
+  if ( directory == nullptr || !( directory->attributes & Node::DIRECTORY ) ) { return nullptr; }
+
+  return new Cursor{ directory, injection };
+}
+
+ReadStatus MemoryFileSystem::readDirectory( void * const directory, void * const buffer, std::uint32_t const size ) {
+  reads_.fetch_add( 1, std::memory_order_relaxed );
+  delay();
+
+  Cursor & cursor = *static_cast<Cursor *>( directory );
+  if ( cursor.injection != nullptr && cursor.injection->after <= cursor.reads ) { return ReadStatus::FAILED; }
+
+  std::size_t const entry_num = cursor.directory->children.size() + 2;
+  if ( entry_num <= cursor.position ) { return ReadStatus::END; }
+
+  auto * const bytes = static_cast<unsigned char *>( buffer );
+  std::size_t offset = 0;
+  FILE_FULL_DIR_INFO * previous = nullptr;
+
+  for ( ; cursor.position < entry_num; ++cursor.position ) {
+    // "."と".."は、どちらもこのディレクトリ自身の情報で書く(走査は名前しか見ない)。
+    std::string_view name = ( cursor.position == 0 ) ? "." : "..";
+    Node const * node = cursor.directory;
+    if ( 2 <= cursor.position ) {
+      auto const & child = cursor.directory->children[cursor.position - 2];
+      name = child.first;
+      node = &nodes_[child.second];
+    }
+
+    std::size_t const length = offsetof( FILE_FULL_DIR_INFO, FileName ) + name.size() * sizeof( WCHAR );
+    if ( size < offset || size - offset < length ) { break; }
+
+    auto & info = *reinterpret_cast<FILE_FULL_DIR_INFO *>( bytes + offset );
+    info.NextEntryOffset = 0;
+    info.FileIndex = 0;
+    info.CreationTime.QuadPart = static_cast<LONGLONG>( node->time );
+    info.LastAccessTime.QuadPart = static_cast<LONGLONG>( node->time );
+    info.LastWriteTime.QuadPart = static_cast<LONGLONG>( node->time );
+    info.ChangeTime.QuadPart = static_cast<LONGLONG>( node->time );
+    info.EndOfFile.QuadPart = static_cast<LONGLONG>( node->size );
+    info.AllocationSize.QuadPart = static_cast<LONGLONG>( ( node->size + 4095 ) / 4096 * 4096 );
+    info.FileAttributes = node->attributes;
+    info.FileNameLength = static_cast<ULONG>( name.size() * sizeof( WCHAR ) );
+    // リパースポイントでは、EaSizeにリパースタグが入る。
+    info.EaSize = ( node->attributes & Node::REPARSE_POINT ) ? IO_REPARSE_TAG_SYMLINK : 0;
+
+    WCHAR * const file_name = info.FileName;
+    for ( std::size_t index = 0; index < name.size(); ++index ) { file_name[index] = static_cast<WCHAR>( static_cast<unsigned char>( name[index] ) ); }
+
+    if ( previous != nullptr ) { previous->NextEntryOffset = static_cast<ULONG>( reinterpret_cast<unsigned char *>( &info ) - reinterpret_cast<unsigned char *>( previous ) ); }
+    previous = &info;
+    // 次のエントリは8バイト境界に置く。
+    offset += ( length + 7 ) / 8 * 8;
+  }
+
+  // 一つのエントリも入らないバッファには読めない(GetFileInformationByHandleExのERROR_MORE_DATA)。
+  if ( previous == nullptr ) { return ReadStatus::FAILED; }
+
+  ++cursor.reads;
+  return ReadStatus::READ;
+}
+
+void MemoryFileSystem::closeDirectory( void * const directory ) noexcept { delete static_cast<Cursor *>( directory ); }
+
+bool MemoryFileSystem::queryInformation( std::string const & path, FileInformation & information ) {
+  queries_.fetch_add( 1, std::memory_order_relaxed );
+  delay();
+
+  Injection const * const injection = faultOf( path );
+  if ( injection != nullptr && injection->fault == Fault::NOT_FOUND ) { return false; }
+
+  Node const * const node = resolve( path );
+  if ( node == nullptr ) { return false; }
+
+  information.attributes = node->attributes;
+  information.creation_time = information.access_time = information.write_time = node->time;
+  information.size = node->size;
+  information.volume = VOLUME;
+  information.index = node->id;
+  information.links = node->links;
+  return true;
+}
+
+bool MemoryFileSystem::queryAttributes( std::string const & path, FileInformation & information ) {
+  queries_.fetch_add( 1, std::memory_order_relaxed );
+  delay();
+
+  Injection const * const injection = faultOf( path );
+  if ( injection != nullptr && injection->fault == Fault::NOT_FOUND ) { return false; }
+
+  Node const * const node = find( path );
+  if ( node == nullptr ) { return false; }
+
+  information = FileInformation();
+  information.attributes = node->attributes;
+  information.creation_time = information.access_time = information.write_time = node->time;
+  information.size = node->size;
+  return true;
+}
+
+bool MemoryFileSystem::readFile( std::string const & path, std::string & contents ) {
+  opens_.fetch_add( 1, std::memory_order_relaxed );
+  delay();
+
+  if ( faultOf( path ) != nullptr ) { return false; }
+
+  Node const * const node = resolve( path );
+  if ( node == nullptr || ( node->attributes & Node::DIRECTORY ) ) { return false; }
+
+  contents = node->contents;
+  return true;
+}
+
+} // lfl
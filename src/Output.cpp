@@ -0,0 +1,66 @@
+/****************************************
+ * Output.cpp
+ *
+ * lfl/Output.hppの書き出し先(Windows API)
+ *****************************************/
+
+#include "lfl/Output.hpp"
+
+// std
+#include <algorithm>
+#include <string>
+#include <windows.h>
+
+namespace lfl {
+
+namespace OUTPUT {
+
+bool WriteAll( void * const handle, char const * data, std::size_t size ) noexcept {
+  // WriteFileに渡せるのはDWORDの範囲までなので、大きな塊は分割する。
+  STATIC_CONSTEXPR std::size_t MAX_CHUNK = std::size_t( 1 ) << 30;
+
+  while ( size > 0 ) {
+    DWORD written = 0;
+    DWORD const chunk = static_cast<DWORD>( std::min( size, MAX_CHUNK ) );
+
+    if ( WriteFile( static_cast<HANDLE>( handle ), data, chunk, &written, nullptr ) == 0 || written == 0 ) { return false; }
+
+    data += written;
+    size -= written;
+  }
+
+  return true;
+}
+
+bool StdDevice::write( char const * data, std::size_t size ) const noexcept {
+  // GetStdHandleはプロセスの標準ハンドルを返すだけなので、毎回呼び出しても安い。
+  HANDLE const handle = GetStdHandle( ( channel_ == Channel::OUT ) ? STD_OUTPUT_HANDLE : STD_ERROR_HANDLE );
+  if ( handle == INVALID_HANDLE_VALUE || handle == nullptr ) { return false; }
+
+  return WriteAll( handle, data, size );
+}
+
+std::string_view StdDevice::toUtf8( std::string_view const ansi, std::string & buffer ) {
+  // ANSIコードページがUTF-8なら変換は要らない。
+  if ( GetACP() == CP_UTF8 ) { return ansi; }
+
+  // UTF-16を経てUTF-8にする。
+  thread_local std::basic_string<WCHAR> wide;
+  int const size = static_cast<int>( ansi.size() );
+  int const wide_length = MultiByteToWideChar( CP_ACP, 0, ansi.data(), size, nullptr, 0 );
+  if ( wide_length <= 0 ) { return ansi; }
+
+  wide.resize( static_cast<std::size_t>( wide_length ) );
+  MultiByteToWideChar( CP_ACP, 0, ansi.data(), size, wide.data(), wide_length );
+
+  int const length = WideCharToMultiByte( CP_UTF8, 0, wide.data(), wide_length, nullptr, 0, nullptr, nullptr );
+  if ( length <= 0 ) { return ansi; }
+
+  buffer.resize( static_cast<std::size_t>( length ) );
+  WideCharToMultiByte( CP_UTF8, 0, wide.data(), wide_length, buffer.data(), length, nullptr, nullptr );
+  return buffer;
+}
+
+} // OUTPUT
+
+} // lfl
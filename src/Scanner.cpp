@@ -0,0 +1,1088 @@
+/****************************************
+ * Scanner.cpp
+ *
+ * lfl/Scanner.hppの走査の実体(ファイルシステムの呼び出しはlfl/FileSystem.hpp)
+ *****************************************/
+
+#include "lfl/Scanner.hpp"
+#include "lfl/Archive.hpp"
+#include "lfl/Dispatch.hpp"
+#include "lfl/FileSystem.hpp"
+#include "lfl/Frontier.hpp"
+#include "lfl/IdentitySet.hpp"
+#include "lfl/Input.hpp"
+#include "lfl/NameMatcher.hpp"
+#include "lfl/Parallel.hpp"
+#include "lfl/Throttle.hpp"
+
+// std
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <windows.h>
+#include <aclapi.h>
+#include <sddl.h>
+
+namespace lfl {
+
+namespace {
+
+STATIC_CONSTEXPR std::size_t BATCHES_PER_HELPER = 2;
+
+// GetFileInformationByHandleExで読み込むバッファ。
+// FILE_FULL_DIR_INFOは8バイト境界に置く必要があるので、uint64_tの配列として確保する。
+// 最後のエントリの名前を越えて読んでも外に出ないように、WIDE_MATCH_PADDINGの余白を付けておく(lfl/NameMatcher.hpp)。
+// 0で埋めるのは余白だけにする。全体を埋めると、小さなディレクトリしか読まなくても
+// バッファのすべてのページに触れる(ページフォールトが起こる)ので、起動が遅くなる。
+class DirectoryBuffer {
+public:
+  DirectoryBuffer() = default;
+  explicit DirectoryBuffer( std::size_t const size ) : words_( new std::uint64_t[( size + 7 ) / 8 + WIDE_MATCH_PADDING / 8] ), size_( static_cast<DWORD>( ( size + 7 ) / 8 * 8 ) ) {
+    std::fill_n( words_.get() + size_ / 8, WIDE_MATCH_PADDING / 8, std::uint64_t( 0 ) );
+  }
+
+  void * data() const noexcept { return words_.get(); }
+  DWORD size() const noexcept { return size_; }
+  bool empty() const noexcept { return !words_; }
+private:
+  std::unique_ptr<std::uint64_t[]> words_;
+  DWORD size_ = 0;
+};
+
+// 大きなディレクトリを複数のスレッドで分担するときの、ディレクトリごとの共有状態。
+// 読み込んだスレッドのスタック上に置き、分担したバッチがすべて処理されるまで待ってから破棄する。
+class SharedDirectory {
+public:
+  SharedDirectory( DirectoryJob const & job, DirectoryContext const & context ) : job_( job ), context_( context ) {}
+
+  DirectoryJob const & job() const noexcept { return job_; }
+  DirectoryContext const & context() const noexcept { return context_; }
+
+  // 他のスレッドに渡す前に数えておく。
+  void acquire() {
+    std::lock_guard<std::mutex> lock( mutex_ );
+    ++outstanding_;
+  }
+
+  // 積めなかったときに、acquireを取り消す。
+  void cancel() {
+    std::lock_guard<std::mutex> lock( mutex_ );
+    --outstanding_;
+  }
+
+  // 処理の終わったバッチのバッファを返す。
+  void release( DirectoryBuffer && buffer ) {
+    {
+      std::lock_guard<std::mutex> lock( mutex_ );
+      spares_.emplace_back( std::move( buffer ) );
+      --outstanding_;
+    }
+    condition_.notify_all();
+  }
+
+  // 次の読み込みに使うバッファ。返されたものがあれば使い回す。
+  DirectoryBuffer spare( std::size_t const size ) {
+    {
+      std::lock_guard<std::mutex> lock( mutex_ );
+      if ( !spares_.empty() ) {
+        DirectoryBuffer buffer = std::move( spares_.back() );
+        spares_.pop_back();
+        return buffer;
+      }
+    }
+    return DirectoryBuffer( size );
+  }
+
+  void wait() {
+    std::unique_lock<std::mutex> lock( mutex_ );
+    condition_.wait( lock, [ this ](){ return outstanding_ == 0; } );
+  }
+private:
+  DirectoryJob const & job_;
+  DirectoryContext const & context_;
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  std::size_t outstanding_ = 0;
+  std::vector<DirectoryBuffer> spares_;
+};
+
+// 大きなディレクトリの2つ目以降のバッチ
+struct Batch {
+  SharedDirectory * directory = nullptr;
+  DirectoryBuffer buffer;
+};
+
+// 読み込み待ちのディレクトリを積んでおくスタック。
+// pending_は「積まれている数 + 読み込み中の数」で、
+// これが0になったら、もう新しいディレクトリが積まれることは無い。
+// 幅優先のときは、見つかったサブディレクトリをnext_に積み、
+// 今の階層のpending_が0になったところでjobs_と入れ替える。
+//
+// 最良優先のときは、jobs_がディレクトリの更新時刻の順に取り出す。
+// 期限を過ぎたら新しいディレクトリは取り出させず、読み残しがあれば打ち切ったことを記録する。
+//
+// --checkpointのときは、pause()で新しいディレクトリを取り出させずに、読み込み中の数(active_)が0になるのを待つ。
+// 読み込み中のディレクトリのバッチは取り出させるので、大きなディレクトリもそのまま読み終わる。
+// 待つのは期限までで、それまでに読み終わらなければ、その回は写さずに走査を続ける。
+//
+// --per-rootのときは、起点ごとにも「積まれている数 + 読み込み中の数」をroot_pending_に数え、
+// 0になったらその起点の下はすべて読み終えたとみなす。
+//
+// 分担するバッチも同じところで待ち合わせる。バッチはpending_に数えないが、
+// 読み込んだスレッドはすべてのバッチが処理されるまでdone()を呼ばないので、
+// バッチが残っている間にpending_が0になることは無い。
+class WorkStack {
+public:
+  using clock_type = std::chrono::steady_clock;
+
+  WorkStack( std::vector<DirectoryJob> && jobs, ScanConfig const & config, std::size_t const batch_capacity )
+  : jobs_( config.order, config.max_frontier ), next_( config.order, config.max_frontier ), pending_( jobs.size() ), order_( config.order ), batch_capacity_( batch_capacity ),
+    has_deadline_( config.deadline.count() != 0 ), deadline_( clock_type::now() + config.deadline ), root_pending_( config.on_root_done ? jobs.size() : 0, 1 ) {
+    // 続きから走査するときは読み込み待ちのディレクトリが多いので、兄弟をまとめて積む(上限を超えたら詰めて持つ)。
+    std::vector<DirectoryJob> siblings;
+    for ( auto & itr : jobs ) {
+      if ( !siblings.empty() && !isSibling( siblings.front(), itr ) ) { jobs_.push( siblings ); }
+      siblings.emplace_back( std::move( itr ) );
+    }
+    jobs_.push( siblings );
+  }
+
+  // ディレクトリかバッチを一つ取り出す。待たせているスレッドがいるので、バッチを優先する。
+  bool pop( DirectoryJob & job, Batch & batch ) {
+    std::unique_lock<std::mutex> lock( mutex_ );
+    auto const is_ready = [ this ](){ return !batches_.empty() || ( !is_paused_ && !jobs_.empty() ) || pending_ == 0; };
+
+    if ( has_deadline_ ) {
+      condition_.wait_until( lock, deadline_, is_ready );
+    } else {
+      condition_.wait( lock, is_ready );
+    }
+
+    if ( !batches_.empty() ) {
+      batch = std::move( batches_.front() );
+      batches_.pop_front();
+      return true;
+    }
+
+    if ( isExpired() ) {
+      if ( !jobs_.empty() || !next_.empty() ) { is_truncated_ = true; }
+      return false;
+    }
+
+    if ( !jobs_.pop( job ) ) { return false; }
+
+    ++active_;
+    batch.directory = nullptr;
+    return true;
+  }
+
+  bool isExpired() const noexcept { return has_deadline_ && ( deadline_ <= clock_type::now() ); }
+  // 待つのをやめる時刻(期限が無ければ待ち続ける)
+  clock_type::time_point limit() const noexcept { return has_deadline_ ? deadline_ : clock_type::time_point::max(); }
+
+  // ディレクトリを最後まで読まずに打ち切ったことを記録する。
+  void truncate() {
+    std::lock_guard<std::mutex> lock( mutex_ );
+    is_truncated_ = true;
+  }
+
+  bool isTruncated() {
+    std::lock_guard<std::mutex> lock( mutex_ );
+    return is_truncated_;
+  }
+
+  // 一つのディレクトリで見つかったサブディレクトリを、まとめて積む。
+  void push( std::vector<DirectoryJob> & jobs ) {
+    if ( jobs.empty() ) { return; }
+
+    // 一度に積むのは同じディレクトリのサブディレクトリなので、起点も同じ。
+    if ( order_ == TraversalOrder::BFS ) {
+      std::lock_guard<std::mutex> lock( mutex_ );
+      if ( !root_pending_.empty() ) { root_pending_[jobs.front().root] += jobs.size(); }
+      next_.push( jobs );
+      // 次の階層は、今の階層を読み終えるまで取り出させないので起こさない。
+      return;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock( mutex_ );
+      pending_ += jobs.size();
+      if ( !root_pending_.empty() ) { root_pending_[jobs.front().root] += jobs.size(); }
+      jobs_.push( jobs );
+    }
+
+    condition_.notify_all();
+  }
+
+  // キューに空きがあればバッチを積む。積めなければbatchはそのまま残る。
+  bool tryPushBatch( Batch & batch ) {
+    {
+      std::lock_guard<std::mutex> lock( mutex_ );
+      if ( batches_.size() >= batch_capacity_ ) { return false; }
+      batches_.emplace_back( std::move( batch ) );
+    }
+
+    condition_.notify_one();
+    return true;
+  }
+
+  // まだ誰にも取り出されていない、directoryのバッチを取り戻す。
+  std::vector<Batch> reclaim( SharedDirectory const * directory ) {
+    std::vector<Batch> reclaimed;
+
+    std::lock_guard<std::mutex> lock( mutex_ );
+    for ( auto itr = batches_.begin(); itr != batches_.end(); ) {
+      if ( itr->directory == directory ) {
+        reclaimed.emplace_back( std::move( *itr ) );
+        itr = batches_.erase( itr );
+      } else {
+        ++itr;
+      }
+    }
+
+    return reclaimed;
+  }
+
+  // rootの起点の下をすべて読み終えたらtrueを返す(--per-rootのときだけ)。
+  bool done( std::uint32_t const root ) {
+    bool is_level_end = false, is_root_end = false, is_quiet = false;
+    {
+      std::lock_guard<std::mutex> lock( mutex_ );
+      is_level_end = ( --pending_ == 0 );
+      is_quiet = ( --active_ == 0 ) && is_paused_;
+      is_root_end = !root_pending_.empty() && ( --root_pending_[root] == 0 );
+
+      // 次の階層に進む。next_が空なら走査は終わり。
+      if ( is_level_end && !next_.empty() ) {
+        std::swap( jobs_, next_ );
+        pending_ = jobs_.size();
+      }
+    }
+
+    if ( is_level_end || is_quiet ) { condition_.notify_all(); }
+    return is_root_end;
+  }
+
+  // 新しいディレクトリを取り出させずに、読み込み中のディレクトリがなくなるまで(0でなければmax_pauseまで)待つ。
+  // 走査が終わっていたり、打ち切られていたり、max_pauseまでに読み終わらなかったりして、写すべき状態が無ければfalseを返す。
+  // 戻り値に関わらず、後でresume()を呼ぶこと。
+  bool pause( std::chrono::milliseconds const max_pause ) {
+    std::unique_lock<std::mutex> lock( mutex_ );
+    is_paused_ = true;
+    auto const is_ready = [ this ](){ return active_ == 0 || pending_ == 0; };
+
+    bool is_quiet = true;
+    if ( max_pause.count() != 0 ) {
+      is_quiet = condition_.wait_for( lock, max_pause, is_ready );
+    } else {
+      condition_.wait( lock, is_ready );
+    }
+
+    return is_quiet && pending_ != 0 && !is_truncated_;
+  }
+
+  // pause()している間の読み込み待ちのディレクトリを写す。
+  void snapshot( Frontier & jobs, Frontier & next ) {
+    std::lock_guard<std::mutex> lock( mutex_ );
+    jobs = jobs_;
+    next = next_;
+  }
+
+  void resume() {
+    {
+      std::lock_guard<std::mutex> lock( mutex_ );
+      is_paused_ = false;
+    }
+    condition_.notify_all();
+  }
+
+  // 時間切れで読み終えられなかった起点
+  std::vector<std::size_t> unfinishedRoots() {
+    std::lock_guard<std::mutex> lock( mutex_ );
+
+    std::vector<std::size_t> roots;
+    for ( std::size_t index = 0; index < root_pending_.size(); ++index ) {
+      if ( root_pending_[index] != 0 ) { roots.emplace_back( index ); }
+    }
+    return roots;
+  }
+private:
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  Frontier jobs_;
+  Frontier next_;
+  std::deque<Batch> batches_;
+  std::size_t pending_;
+  TraversalOrder const order_;
+  std::size_t const batch_capacity_;
+  bool const has_deadline_;
+  clock_type::time_point const deadline_;
+  std::vector<std::size_t> root_pending_;
+  bool is_truncated_ = false;
+  bool is_paused_ = false;
+  // 取り出されて、まだdone()されていないディレクトリの数
+  std::size_t active_ = 0;
+
+  // 同じ親のサブディレクトリで、詰めて持つときに共通にする情報も同じもの
+  static bool isSibling( DirectoryJob const & lhs, DirectoryJob const & rhs ) noexcept {
+    std::size_t const parent_length = lhs.path.rfind( DELIMITER, lhs.path.size() - 2 ) + 1;
+    return lhs.root_length == rhs.root_length && lhs.depth == rhs.depth && lhs.volume == rhs.volume && lhs.ignore == rhs.ignore && lhs.root == rhs.root
+        && rhs.path.size() > parent_length && rhs.path.compare( 0, parent_length, lhs.path, 0, parent_length ) == 0 && rhs.path.find( DELIMITER, parent_length ) == rhs.path.size() - 1;
+  }
+};
+
+// "."と".."
+bool isDotEntry( WCHAR const * name, std::size_t const length ) noexcept {
+  return ( name[0] == L'.' ) && ( ( length == 1 ) || ( length == 2 && name[1] == L'.' ) );
+}
+
+// 時刻の比較に使う時刻を、--timeの指定(走査の実体化ごとに決まっている)に従って選ぶ。
+template<TimeField TIME>
+Time selectTime( FILE_FULL_DIR_INFO const & info ) noexcept {
+  if constexpr ( TIME == TimeField::ACCESS ) {
+    return Time::FromFileTime( static_cast<std::uint64_t>( info.LastAccessTime.QuadPart ) );
+  } else if constexpr ( TIME == TimeField::CREATION ) {
+    return Time::FromFileTime( static_cast<std::uint64_t>( info.CreationTime.QuadPart ) );
+  } else {
+    return Time::FromFileTime( static_cast<std::uint64_t>( info.LastWriteTime.QuadPart ) );
+  }
+}
+
+Time selectTime( FileInformation const & information, TimeField const time_field ) noexcept {
+  switch ( time_field ) {
+    case TimeField::ACCESS: return Time::FromFileTime( information.access_time );
+    case TimeField::CREATION: return Time::FromFileTime( information.creation_time );
+    default: return Time::FromFileTime( information.write_time );
+  }
+}
+
+// リパースポイントでは、EaSizeにリパースタグが入っている。
+EntryType selectType( FILE_FULL_DIR_INFO const & info ) noexcept {
+  if ( ( info.FileAttributes & FILE_ATTRIBUTE_REPARSE_POINT ) && ( info.EaSize == IO_REPARSE_TAG_SYMLINK ) ) { return EntryType::SYMLINK; }
+  if ( info.FileAttributes & FILE_ATTRIBUTE_DIRECTORY ) { return EntryType::DIRECTORY; }
+  if ( info.FileAttributes & FILE_ATTRIBUTE_DEVICE ) { return EntryType::OTHER; }
+
+  return EntryType::FILE;
+}
+
+FileIdentity toIdentity( FileInformation const & information ) noexcept { return FileIdentity{ information.volume, information.index }; }
+
+// 走査が読むファイルシステム。指定が無ければ実際のファイルシステム。
+FileSystem & fileSystemOf( ScanConfig const & config ) noexcept { return ( config.file_system != nullptr ) ? *config.file_system : NativeFileSystem(); }
+
+// --group-by=ownerで使う、所有者の名前の問い合わせ。
+// 所有者の種類はファイルの数よりずっと少ないので、SIDから名前への変換(LookupAccountSid)の結果は覚えておく。
+class OwnerCache {
+public:
+  // 問い合わせられなければ空を返す。返した名前は、このオブジェクトが生きている間有効。
+  std::string_view lookup( std::string const & path ) {
+    PSID sid = nullptr;
+    PSECURITY_DESCRIPTOR descriptor = nullptr;
+    if ( GetNamedSecurityInfo( path.c_str(), SE_FILE_OBJECT, OWNER_SECURITY_INFORMATION, &sid, nullptr, nullptr, nullptr, &descriptor ) != ERROR_SUCCESS ) { return std::string_view(); }
+
+    key_.assign( static_cast<char const *>( sid ), GetLengthSid( sid ) );
+    auto itr = names_.find( key_ );
+    if ( itr == names_.end() ) { itr = names_.emplace( key_, accountName( sid ) ).first; }
+    LocalFree( descriptor );
+
+    return itr->second;
+  }
+private:
+  // SIDのバイト列から、"DOMAIN\user"の形の名前へ
+  std::unordered_map<std::string, std::string> names_;
+  std::string key_;
+
+  static std::string accountName( PSID const sid ) {
+    char name[256], domain[256];
+    DWORD name_length = sizeof( name ), domain_length = sizeof( domain );
+    SID_NAME_USE use;
+    if ( LookupAccountSid( nullptr, sid, name, &name_length, domain, &domain_length, &use ) != 0 ) {
+      return std::string( domain, domain_length ).append( 1, DELIMITER ).append( name, name_length );
+    }
+
+    // 削除されたアカウントなどで名前が分からなければ、SIDの文字列("S-1-5-...")で表す。
+    LPSTR text = nullptr;
+    if ( ConvertSidToStringSid( sid, &text ) == 0 ) { return std::string(); }
+
+    std::string result( text );
+    LocalFree( text );
+    return result;
+  }
+};
+
+// --archives: アーカイブ(path)をメモリにマップし、メンバーを"archive_name:member/path"という名前のエントリにして、
+// 絞り込みを通ったものをoffer(FoundEntry const &)に渡す。nameはエントリの名前を組み立てるバッファ。
+// 開けない(あるいは空の)アーカイブは、メンバーが無いものとして扱う。アーカイブそのものはふつうのファイルとして報告される。
+template<typename Offer>
+void OfferArchiveMembers( ScanConfig const & config, ArchiveKind const kind, std::string const & path, std::string_view const archive_name, std::string_view const owner, std::string & name, Offer && offer ) {
+  HANDLE const file = CreateFile( path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr );
+  if ( file == INVALID_HANDLE_VALUE ) { return; }
+
+  // 大きさが0のファイルはマップできない。
+  LARGE_INTEGER size;
+  HANDLE const mapping = ( GetFileSizeEx( file, &size ) != 0 && size.QuadPart > 0 ) ? CreateFileMapping( file, nullptr, PAGE_READONLY, 0, 0, nullptr ) : nullptr;
+  void const * const view = ( mapping != nullptr ) ? MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 ) : nullptr;
+
+  if ( view != nullptr ) {
+    std::string_view const data( static_cast<char const *>( view ), static_cast<std::size_t>( size.QuadPart ) );
+    ARCHIVE::ForEachMember( kind, data, [ & ]( ArchiveMember const & member ) {
+      // --nameはメンバーの名前(パスの最後の構成要素)に当てはめる。
+      if ( !config.filter.matchName( member.path.substr( member.path.rfind( '/' ) + 1 ) ) ) { return; }
+
+      name.assign( archive_name ).append( 1, ARCHIVE::SEPARATOR ).append( member.path );
+      FoundEntry found{ name, member.time, member.size, member.type };
+      found.owner = owner;
+      if ( !config.filter.matchInformation( found, member.time ) ) { return; }
+
+      offer( found );
+    } );
+    UnmapViewOfFile( view );
+  }
+
+  if ( mapping != nullptr ) { CloseHandle( mapping ); }
+  CloseHandle( file );
+}
+
+// 走査全体で共有する、訪問済みの実体の集合
+struct VisitedSets {
+  // 読み込んだディレクトリ(循環や、複数の経路から辿り着くディレクトリを一度だけ読むため)
+  ConcurrentIdentitySet directories;
+  // ハードリンクが複数あるファイル(一度だけ報告するため)
+  ConcurrentIdentitySet files;
+};
+
+// 走査全体で共有する、I/Oの速さを抑えるトークンバケツ(lfl/Throttle.hpp)
+struct Throttles {
+  explicit Throttles( ScanConfig const & config ) noexcept : io( config.max_iops ), directories( config.max_directories_per_second ) {}
+
+  TokenBucket io;
+  TokenBucket directories;
+};
+
+// 走査の実体化で区別する受け取り側。TopKはcount == 1のときだけ別にする。
+enum class KernelSink : std::uint8_t {
+  GENERIC,
+  TOP_ONE,
+  TOP_K,
+  TABLE,
+  NUM
+};
+
+/****************************************
+ * エントリごとの処理で分岐していたオプションの組。
+ *
+ * FILTERS: --name、--min-sizeなどの絞り込みか、--exclude、--gitignoreのどれかがある
+ * FOLLOWS: -L
+ * 組ごとにWorker::processBatchを実体化し、走査を始める前に一つを選ぶ(lfl/Dispatch.hpp)。
+ ****************************************/
+template<TimeField TIME_FIELD, bool HAS_FILTERS, bool FOLLOWS_LINKS, KernelSink SINK_KIND>
+struct ScanPolicy {
+  static constexpr TimeField TIME = TIME_FIELD;
+  static constexpr bool FILTERS = HAS_FILTERS;
+  static constexpr bool FOLLOWS = FOLLOWS_LINKS;
+  static constexpr KernelSink SINK = SINK_KIND;
+};
+
+using KernelShape = DISPATCH::Shape<static_cast<std::size_t>( TimeField::NUM ), 2, 2, static_cast<std::size_t>( KernelSink::NUM )>;
+
+class Worker {
+public:
+  Worker( ScanConfig const & config, WorkStack & stack, VisitedSets & visited, Throttles & throttles, Sink & sink )
+  : config_( config ), file_system_( fileSystemOf( config ) ), stack_( stack ), visited_( visited ), sink_( sink ), wide_names_( config.filter.patterns() ), kernel_( selectKernel( config, sink ) ),
+    io_tokens_( throttles.io ), directory_tokens_( throttles.directories ) {}
+
+  void run() {
+    DirectoryJob job;
+    Batch batch;
+
+    while ( stack_.pop( job, batch ) ) {
+      if ( batch.directory != nullptr ) {
+        processSharedBatch( batch );
+        continue;
+      }
+
+      if ( visit( job ) ) {
+        loadIgnoreFiles( job );
+        readDirectory( job );
+      }
+      stack_.push( subdirectories_ );
+      if ( stack_.done( job.root ) ) { config_.on_root_done( job.root ); }
+    }
+  }
+
+  std::vector<std::string> & errors() noexcept { return errors_; }
+private:
+  ScanConfig const & config_;
+  FileSystem & file_system_;
+  WorkStack & stack_;
+  VisitedSets & visited_;
+  Sink & sink_;
+  WideNameMatcher const wide_names_;
+  // オプションの組に合わせて実体化したprocessBatch
+  using Kernel = void ( Worker::* )( DirectoryJob const &, DirectoryContext const &, void const * );
+  Kernel const kernel_;
+  std::vector<DirectoryJob> subdirectories_;
+  std::vector<std::string> errors_;
+  DirectoryBuffer buffer_;
+  std::string name_;
+  std::string entry_path_;
+  // アーカイブのメンバーの名前(lfl/Archive.hpp)
+  std::string member_name_;
+  std::string ignore_contents_;
+  OwnerCache owners_;
+  // --max-iopsと--max-dirs-per-secのトークンの手持ち
+  TokenAllowance io_tokens_;
+  TokenAllowance directory_tokens_;
+
+  // I/Oの前にトークンを一つ使う。期限までに使えなければ、打ち切ったことを記録してfalseを返す。
+  bool spend( TokenAllowance & tokens ) {
+    if ( tokens.take( stack_.limit() ) ) { return true; }
+
+    stack_.truncate();
+    return false;
+  }
+
+  // ディレクトリを読み込む前の準備。
+  // -Lのときはディレクトリの実体を登録し、すでに別の経路から読み込まれていたらfalseを返す。
+  // --xdevのときは起点のボリュームを記録する。
+  bool visit( DirectoryJob & job ) {
+    bool const is_root_on_xdev = config_.one_file_system && ( job.depth == 0 );
+    if ( !config_.follow_links && !is_root_on_xdev ) { return true; }
+
+    FileInformation information;
+    if ( !spend( io_tokens_ ) ) { return false; }
+
+    if ( !file_system_.queryInformation( job.path, information ) ) {
+      errors_.emplace_back( job.path );
+      return false;
+    }
+
+    if ( is_root_on_xdev ) { job.volume = information.volume; }
+
+    return !config_.follow_links || visited_.directories.insert( toIdentity( information ) );
+  }
+
+  // --gitignoreのときは、ディレクトリの.gitignoreと.ignoreを読み、
+  // このディレクトリより下に適用する規則としてjobに持たせる(サブディレクトリに引き継がれる)。
+  void loadIgnoreFiles( DirectoryJob & job ) {
+    if ( !config_.gitignore ) { return; }
+
+    ExcludeRules rules;
+    for ( char const * const itr : IGNORE_FILE_NAMES ) {
+      if ( !spend( io_tokens_ ) ) { break; }
+
+      entry_path_.assign( job.path ).append( itr );
+      if ( !file_system_.readFile( entry_path_, ignore_contents_ ) ) { continue; }
+
+      INPUT::ForEachRecord( ignore_contents_, '\n', [ &rules ]( std::string_view const line ){ rules.add( line ); } );
+    }
+    if ( rules.empty() ) { return; }
+
+    job.ignore = std::make_shared<IgnoreScope const>( IgnoreScope{ std::move( job.ignore ), job.path.substr( job.root_length ), std::move( rules ) } );
+  }
+
+  void readDirectory( DirectoryJob const & job ) {
+    if ( !spend( directory_tokens_ ) || !spend( io_tokens_ ) ) { return; }
+
+    void * const directory = file_system_.openDirectory( job.path );
+
+    if ( directory == nullptr ) {
+      errors_.emplace_back( job.path );
+      return;
+    }
+
+    DirectoryContext const context{ job.path, job.root_length, job.root };
+    sink_.enterDirectory( context );
+
+    SharedDirectory shared( job, context );
+    if ( buffer_.empty() ) { buffer_ = DirectoryBuffer( config_.directory_buffer_size ); }
+    DirectoryBuffer buffer = std::move( buffer_ );
+
+    // 最初のバッチは自分で処理する。
+    // 2つ目が読めるのはバッファに収まらない大きなディレクトリなので、それ以降は他のスレッドと分担する。
+    // 期限を過ぎたら、大きなディレクトリでも残りのバッチは読まない。
+    // ただし、今のバッチが最後だったかどうかは次を読むまで分からないので、期限を過ぎてからもう一度だけ読み、
+    // まだエントリがあったときだけ打ち切ったことにする(読み終えたディレクトリを近似にしない)。
+    // --max-iopsでは、一回分を読むごとにトークンを一つ使う(バッファの大きさは変えない)。
+    bool is_first = true, is_expired = false, is_truncated = false;
+    ReadStatus status = ReadStatus::END;
+    for ( ;; ) {
+      if ( !spend( io_tokens_ ) ) {
+        is_truncated = true;
+        break;
+      }
+      status = file_system_.readDirectory( directory, buffer.data(), buffer.size() );
+      if ( status != ReadStatus::READ ) { break; }
+
+      if ( is_first || !share( shared, buffer ) ) { ( this->*kernel_ )( job, context, buffer.data() ); }
+      is_first = false;
+
+      if ( is_expired ) {
+        is_truncated = true;
+        break;
+      }
+      is_expired = stack_.isExpired();
+    }
+
+    if ( is_truncated ) {
+      stack_.truncate();
+    } else if ( status == ReadStatus::FAILED ) {
+      errors_.emplace_back( job.path );
+    }
+    file_system_.closeDirectory( directory );
+
+    // まだ取り出されていないバッチは自分で処理し、他のスレッドが処理中のバッチを待つ。
+    for ( auto & itr : stack_.reclaim( &shared ) ) {
+      ( this->*kernel_ )( job, context, itr.buffer.data() );
+      shared.release( std::move( itr.buffer ) );
+    }
+    shared.wait();
+
+    buffer_ = std::move( buffer );
+  }
+
+  // バッチをキューに積めたら、bufferを次の読み込み用のものに差し替えてtrueを返す。
+  bool share( SharedDirectory & shared, DirectoryBuffer & buffer ) {
+    shared.acquire();
+
+    Batch batch{ &shared, std::move( buffer ) };
+    if ( stack_.tryPushBatch( batch ) ) {
+      buffer = shared.spare( config_.directory_buffer_size );
+      return true;
+    }
+
+    buffer = std::move( batch.buffer );
+    shared.cancel();
+    return false;
+  }
+
+  // 他のスレッドが読み込んだバッチを処理する。
+  // 見つかったサブディレクトリは、バッチを返す前に積んでおく(返した時点で読み込んだスレッドはdone()を呼びうる)。
+  void processSharedBatch( Batch & batch ) {
+    SharedDirectory & shared = *batch.directory;
+
+    sink_.enterDirectory( shared.context() );
+    ( this->*kernel_ )( shared.job(), shared.context(), batch.buffer.data() );
+    stack_.push( subdirectories_ );
+
+    shared.release( std::move( batch.buffer ) );
+  }
+
+  template<std::size_t FLAT>
+  struct KernelOf;
+
+  static Kernel selectKernel( ScanConfig const & config, Sink const & sink ) noexcept;
+
+  template<typename Policy>
+  void processBatch( DirectoryJob const & job, DirectoryContext const & context, void const * data ) {
+    // このディレクトリの中のエントリの深さはjob.depth + 1なので、
+    // サブディレクトリの中まで読むのはそれが上限より浅いときだけ。
+    bool const descends = config_.recursive && ( static_cast<std::size_t>( job.depth ) + 1 < config_.max_depth );
+    // 分担するときは、分ける深さより浅いディレクトリのエントリは0番目の組だけが報告する。
+    bool const reports = !config_.shard.isSharded() || ( config_.split_depth <= job.depth ) || ( config_.shard.index == 0 );
+    // サブディレクトリがちょうど分ける深さにあるなら、自分の組のものにだけ入る。
+    bool const splits = config_.shard.isSharded() && ( static_cast<std::size_t>( job.depth ) + 1 == config_.split_depth );
+
+    auto const * bytes = static_cast<unsigned char const *>( data );
+    for ( ;; ) {
+      auto const & info = *reinterpret_cast<FILE_FULL_DIR_INFO const *>( bytes );
+      processEntry<Policy>( job, context, info, descends, reports, splits );
+
+      if ( info.NextEntryOffset == 0 ) { break; }
+      bytes += info.NextEntryOffset;
+    }
+  }
+
+  template<typename Policy>
+  void offer( DirectoryContext const & context, FoundEntry const & found ) {
+    if constexpr ( Policy::SINK == KernelSink::TOP_ONE ) {
+      static_cast<TopK &>( sink_ ).offerSingle( context, found );
+    } else if constexpr ( Policy::SINK == KernelSink::TOP_K ) {
+      static_cast<TopK &>( sink_ ).offer( context, found );
+    } else if constexpr ( Policy::SINK == KernelSink::TABLE ) {
+      static_cast<EntryTable &>( sink_ ).offer( context, found );
+    } else {
+      sink_.offer( context, found );
+    }
+  }
+
+  template<typename Policy>
+  void processEntry( DirectoryJob const & job, DirectoryContext const & context, FILE_FULL_DIR_INFO const & info, bool const descends, bool const reports, bool const splits ) {
+    int const wide_length = static_cast<int>( info.FileNameLength / sizeof( WCHAR ) );
+    if ( isDotEntry( info.FileName, wide_length ) ) { return; }
+
+    bool const is_directory = ( info.FileAttributes & FILE_ATTRIBUTE_DIRECTORY ) != 0;
+    bool const may_descend = descends && ( info.FileAttributes & ( FILE_ATTRIBUTE_DIRECTORY | FILE_ATTRIBUTE_REPARSE_POINT ) );
+    Time const time = selectTime<Policy::TIME>( info );
+
+    // 上位だけを保持するときは、保持されない時刻のエントリを名前を変換する前に捨てる。
+    // -Lのリパースポイントはリンク先の時刻で比べるので、--unique-inodesは最初のパスを登録するので捨てない。
+    bool is_candidate = reports;
+    if constexpr ( Policy::SINK == KernelSink::TOP_ONE || Policy::SINK == KernelSink::TOP_K ) {
+      bool const is_link = Policy::FOLLOWS && ( info.FileAttributes & FILE_ATTRIBUTE_REPARSE_POINT );
+      if ( is_candidate && !is_link && !config_.unique_inodes && !static_cast<TopK const &>( sink_ ).accepts( time ) ) { is_candidate = false; }
+    }
+
+    // 名前で外れたエントリは報告しないので、入りうるディレクトリでなければ名前を変換する必要も無い。
+    // パターンがUTF-16のまま照合できる形なら、変換する前にここで照合する。
+    if constexpr ( Policy::FILTERS ) {
+      static_assert( sizeof( WCHAR ) == sizeof( char16_t ) );
+      is_candidate = is_candidate && ( !wide_names_.isEnabled() || wide_names_.match( reinterpret_cast<char16_t const *>( info.FileName ), static_cast<std::size_t>( wide_length ) ) );
+    }
+
+    // --archivesでは、アーカイブが名前や時刻で外れても、メンバーは調べる(メンバーの方が新しいこともある)。
+    // リンク(リパースポイント)の先のアーカイブは開かない。
+    ArchiveKind const archive = ( config_.archives && reports && !( info.FileAttributes & ( FILE_ATTRIBUTE_DIRECTORY | FILE_ATTRIBUTE_REPARSE_POINT ) ) )
+      ? ARCHIVE::KindOf( info.FileName, static_cast<std::size_t>( wide_length ) )
+      : ArchiveKind::NONE;
+    if ( !is_candidate && !may_descend && archive == ArchiveKind::NONE ) { return; }
+
+    // 名前はFindFirstFileA(これまでの読み込み方)と同じく、ANSIコードページで扱う(パスをそのままAPIに渡して開くため)。
+    // --jsonでは書き出すときにUTF-8に変換する(lfl/Format.hppのWriteJsonString)。
+    int const length = WideCharToMultiByte( CP_ACP, 0, info.FileName, wide_length, nullptr, 0, nullptr, nullptr );
+    name_.resize( static_cast<std::size_t>( length ) );
+    WideCharToMultiByte( CP_ACP, 0, info.FileName, wide_length, name_.data(), length, nullptr, nullptr );
+
+    std::string_view const name( name_ );
+
+    if constexpr ( Policy::FILTERS ) {
+      if ( is_candidate && !wide_names_.isEnabled() ) { is_candidate = config_.filter.matchName( name ); }
+      if ( !is_candidate && !descends && archive == ArchiveKind::NONE ) { return; }
+
+      // 除外されたディレクトリは読み込み待ちにも積まない(開かない)。除外されたエントリは報告しない。
+      if ( ( !config_.exclude.empty() || job.ignore ) && IsExcluded( config_.exclude, job.ignore.get(), std::string_view( job.path ).substr( job.root_length ), name, is_directory ) ) { return; }
+    }
+
+    FoundEntry found{ name, time, static_cast<std::uint64_t>( info.EndOfFile.QuadPart ), selectType( info ) };
+    DWORD attributes = info.FileAttributes;
+    // 更新時刻。最良優先の優先度と--mtime-rangeに使う。
+    Time priority = selectTime<TimeField::WRITE>( info );
+
+    // 実体の情報が必要になったときに、一度だけ問い合わせる。
+    FileInformation information;
+    bool is_queried = false, has_information = false;
+    auto const query = [ & ]() {
+      if ( !is_queried ) {
+        entry_path_.assign( job.path ).append( name );
+        has_information = spend( io_tokens_ ) && file_system_.queryInformation( entry_path_, information );
+        is_queried = true;
+      }
+      return has_information;
+    };
+
+    // -Lでは、リンクそのものではなく、リンク先の情報を報告する。
+    // リンク先が存在しなければ、リンクそのものの情報のまま報告し、その先には入らない。
+    if ( Policy::FOLLOWS && ( attributes & FILE_ATTRIBUTE_REPARSE_POINT ) ) {
+      if ( query() ) {
+        found.time = selectTime( information, Policy::TIME );
+        found.size = information.size;
+        found.type = ( information.attributes & FILE_ATTRIBUTE_DIRECTORY ) ? EntryType::DIRECTORY : EntryType::FILE;
+        attributes = information.attributes & ~FILE_ATTRIBUTE_REPARSE_POINT;
+        priority = selectTime( information, TimeField::WRITE );
+
+        // リンク先が別のボリュームなら、--xdevではその先に入らない。
+        if ( config_.one_file_system && ( information.volume != job.volume ) ) { attributes &= ~FILE_ATTRIBUTE_DIRECTORY; }
+      } else {
+        attributes &= ~FILE_ATTRIBUTE_DIRECTORY;
+      }
+    }
+
+    // ハードリンクが複数あるファイルは、最初に見つかったパスだけを報告する。
+    if ( is_candidate && config_.unique_inodes && !( attributes & FILE_ATTRIBUTE_DIRECTORY ) && query() && ( information.links > 1 ) ) {
+      if ( !visited_.files.insert( toIdentity( information ) ) ) { return; }
+    }
+
+    if ( is_candidate ) {
+      if constexpr ( Policy::FILTERS ) {
+        if ( !config_.filter.matchInformation( found, priority ) ) { is_candidate = false; }
+      }
+    }
+    if ( is_candidate && config_.query_owner && spend( io_tokens_ ) ) {
+      entry_path_.assign( job.path ).append( name );
+      found.owner = owners_.lookup( entry_path_ );
+    }
+    if ( is_candidate ) { offer<Policy>( context, found ); }
+
+    if ( archive != ArchiveKind::NONE && spend( io_tokens_ ) ) {
+      entry_path_.assign( job.path ).append( name );
+      std::string_view const owner = ( config_.query_owner && spend( io_tokens_ ) ) ? owners_.lookup( entry_path_ ) : std::string_view();
+      OfferArchiveMembers( config_, archive, entry_path_, name, owner, member_name_, [ & ]( FoundEntry const & member ){ offer<Policy>( context, member ); } );
+    }
+
+    // -Lが指定されていなければ、シンボリックリンクやジャンクション(リパースポイント)の先には入らない。
+    if ( descends && ( attributes & FILE_ATTRIBUTE_DIRECTORY ) && !( attributes & FILE_ATTRIBUTE_REPARSE_POINT ) ) {
+      if ( splits ) {
+        entry_path_.assign( job.path, job.root_length ).append( name );
+        if ( !IsShardOwner( config_.shard, entry_path_ ) ) { return; }
+      }
+
+      std::string path;
+      path.reserve( job.path.size() + name.size() + 1 );
+      path.assign( job.path ).append( name ).append( 1, DELIMITER );
+      subdirectories_.emplace_back( DirectoryJob{ std::move( path ), job.root_length, job.depth + 1, job.volume, priority, job.ignore, job.root } );
+    }
+  }
+};
+
+template<std::size_t FLAT>
+struct Worker::KernelOf {
+  using Policy = ScanPolicy<
+    static_cast<TimeField>( KernelShape::coordinate<0>( FLAT ) ),
+    KernelShape::coordinate<1>( FLAT ) != 0,
+    KernelShape::coordinate<2>( FLAT ) != 0,
+    static_cast<KernelSink>( KernelShape::coordinate<3>( FLAT ) )>;
+
+  static constexpr Kernel value = &Worker::processBatch<Policy>;
+};
+
+Worker::Kernel Worker::selectKernel( ScanConfig const & config, Sink const & sink ) noexcept {
+  STATIC_CONSTEXPR auto KERNELS = DISPATCH::MakeTable<KernelShape::SIZE, KernelOf>();
+
+  KernelSink kind = KernelSink::GENERIC;
+  switch ( sink.kind() ) {
+    case SinkKind::TOP_K: kind = ( static_cast<TopK const &>( sink ).count() == 1 ) ? KernelSink::TOP_ONE : KernelSink::TOP_K; break;
+    case SinkKind::TABLE: kind = KernelSink::TABLE; break;
+    default: break;
+  }
+
+  bool const has_filters = !config.filter.empty() || !config.exclude.empty() || config.gitignore;
+  return KERNELS[KernelShape::index( config.time_field, has_filters, config.follow_links, kind )];
+}
+
+} // namespace
+
+ScanResult ScanPaths( ScanConfig const & config, std::vector<std::string_view> const & paths, std::vector<Sink *> const & sinks ) {
+  std::size_t const worker_num = sinks.size();
+  std::vector<std::vector<std::string>> errors( worker_num );
+  VisitedSets visited;
+  Throttles throttles( config );
+  FileSystem & file_system = fileSystemOf( config );
+
+  // パスはそのまま出力するので、ディレクトリの部分は空にする。
+  std::string const empty_directory;
+  DirectoryContext const context{ empty_directory, 0 };
+
+  // 期限を過ぎたら、残りのパスは調べずに打ち切ったことを記録する。
+  using clock_type = std::chrono::steady_clock;
+  bool const has_deadline = ( config.deadline.count() != 0 );
+  clock_type::time_point const deadline = has_deadline ? clock_type::now() + config.deadline : clock_type::time_point::max();
+  std::atomic<bool> is_truncated{ false };
+
+  ParallelFor( worker_num, [ & ]( std::size_t const worker_index ) {
+    Sink & sink = *sinks[worker_index];
+    std::string path, member_name;
+    OwnerCache owners;
+    // 一覧のパスではディレクトリを読まないので、--max-iopsだけを使う。
+    TokenAllowance io_tokens( throttles.io );
+
+    // すべてのパスを空のディレクトリの中のエントリとして渡す(EntryTableはディレクトリを知らされてからエントリを受け取る)。
+    sink.enterDirectory( context );
+
+    std::size_t const end = PartitionBegin( paths.size(), worker_num, worker_index + 1 );
+    for ( std::size_t index = PartitionBegin( paths.size(), worker_num, worker_index ); index < end; ++index ) {
+      if ( has_deadline && deadline <= clock_type::now() ) {
+        is_truncated = true;
+        break;
+      }
+
+      // 名前で外れたパスは、情報を問い合わせずに飛ばす。
+      std::string_view const name = paths[index].substr( paths[index].find_last_of( "\\/" ) + 1 );
+
+      // Windows APIには'\0'で終わる文字列を渡す必要がある。
+      path.assign( paths[index] );
+
+      // --archivesでは、アーカイブが名前で外れても、除外されていなければメンバーは調べる。
+      ArchiveKind const archive = config.archives ? ARCHIVE::KindOf( name ) : ArchiveKind::NONE;
+      if ( archive != ArchiveKind::NONE && ( config.exclude.empty() || !IsExcluded( config.exclude, nullptr, paths[index].substr( 0, paths[index].size() - name.size() ), name, false ) ) ) {
+        // --max-iopsで待つ間に期限を過ぎたら、アーカイブも読まない。
+        if ( !io_tokens.take( deadline ) ) {
+          is_truncated = true;
+          break;
+        }
+        std::string_view owner;
+        if ( config.query_owner ) {
+          if ( io_tokens.take( deadline ) ) {
+            owner = owners.lookup( path );
+          } else {
+            is_truncated = true;
+          }
+        }
+        OfferArchiveMembers( config, archive, path, paths[index], owner, member_name, [ & ]( FoundEntry const & member ){ sink.offer( context, member ); } );
+      }
+
+      if ( !config.filter.matchName( name ) ) { continue; }
+      FoundEntry found{ paths[index], Time::Min(), 0, EntryType::FILE };
+      Time write_time;
+      // --max-iopsで待つ間に期限を過ぎたら、このパスも調べない。
+      if ( !io_tokens.take( deadline ) ) {
+        is_truncated = true;
+        break;
+      }
+
+      // -Lや--unique-inodesでは、ハンドルを開いて実体の情報を調べる。
+      // それ以外はハンドルを開かずに済む問い合わせ(GetFileAttributesEx)で足りる。
+      FileInformation information;
+      if ( config.follow_links || config.unique_inodes ) {
+        if ( !file_system.queryInformation( path, information ) ) {
+          errors[worker_index].emplace_back( path );
+          continue;
+        }
+
+        bool const is_directory = ( information.attributes & FILE_ATTRIBUTE_DIRECTORY );
+        if ( config.unique_inodes && !is_directory && ( information.links > 1 ) && !visited.files.insert( toIdentity( information ) ) ) { continue; }
+
+        found.type = is_directory ? EntryType::DIRECTORY : EntryType::FILE;
+      } else {
+        if ( !file_system.queryAttributes( path, information ) ) {
+          errors[worker_index].emplace_back( path );
+          continue;
+        }
+
+        // リパースタグは分からないので、リパースポイントはシンボリックリンクとみなす。
+        if ( information.attributes & FILE_ATTRIBUTE_REPARSE_POINT ) {
+          found.type = EntryType::SYMLINK;
+        } else if ( information.attributes & FILE_ATTRIBUTE_DIRECTORY ) {
+          found.type = EntryType::DIRECTORY;
+        }
+      }
+
+      found.time = selectTime( information, config.time_field );
+      found.size = information.size;
+      write_time = selectTime( information, TimeField::WRITE );
+
+      // パスはそのまま起点からの相対パスとみなして、除外の規則を当てはめる。
+      if ( !config.exclude.empty() && IsExcluded( config.exclude, nullptr, paths[index].substr( 0, paths[index].size() - name.size() ), name, found.type == EntryType::DIRECTORY ) ) { continue; }
+
+      if ( !config.filter.matchInformation( found, write_time ) ) { continue; }
+
+      // 所有者を問い合わせられなければ、所有者の無いまま渡して、打ち切ったことを記録する(Worker::spend()と同じ)。
+      if ( config.query_owner ) {
+        if ( io_tokens.take( deadline ) ) {
+          found.owner = owners.lookup( path );
+        } else {
+          is_truncated = true;
+        }
+      }
+      sink.offer( context, found );
+    }
+  } );
+
+  ScanResult result;
+  for ( auto & itr : errors ) {
+    std::move( itr.begin(), itr.end(), std::back_inserter( result.errors ) );
+  }
+  result.is_approximate = is_truncated;
+
+  return result;
+}
+
+namespace {
+
+ScanResult ScanJobs( ScanConfig const & config, std::vector<DirectoryJob> && jobs, std::vector<Sink *> const & sinks ) {
+  // 大きなディレクトリのバッチは、読み込んだスレッド以外の数の2倍まで積んでおく。
+  // それ以上は読み込んだスレッドが自分で処理するので、使うメモリには上限がある。
+  // --max-openが指定されていれば、同時に開くハンドルの数がそれを超えないようにスレッドを減らす。
+  // 使わなかったSinkは空のまま残る。
+  std::size_t worker_num = sinks.size();
+  if ( config.max_open != 0 ) { worker_num = std::min( worker_num, std::max<std::size_t>( config.max_open / HANDLES_PER_WORKER, 1 ) ); }
+
+  WorkStack stack( std::move( jobs ), config, ( worker_num == 0 ) ? 0 : ( worker_num - 1 ) * BATCHES_PER_HELPER );
+  VisitedSets visited;
+  Throttles throttles( config );
+
+  std::vector<Worker> workers;
+  workers.reserve( worker_num );
+  for ( std::size_t index = 0; index < worker_num; ++index ) { workers.emplace_back( config, stack, visited, throttles, *sinks[index] ); }
+
+  // --checkpoint: intervalごとに走査を止めて状態を写し、再開してから保存する。
+  // 保存している間(ファイルに書いている間)も、ワーカーは走査を続ける。
+  std::mutex checkpoint_mutex;
+  std::condition_variable checkpoint_condition;
+  bool is_finished = false;
+  std::thread checkpointer;
+  if ( config.checkpoint.interval.count() != 0 ) {
+    checkpointer = std::thread( [ & ] {
+      std::unique_lock<std::mutex> lock( checkpoint_mutex );
+      while ( !checkpoint_condition.wait_for( lock, config.checkpoint.interval, [ &is_finished ](){ return is_finished; } ) ) {
+        lock.unlock();
+
+        Frontier jobs( config.order, config.max_frontier ), next( config.order, config.max_frontier );
+        std::vector<std::string> errors;
+        bool const is_running = stack.pause( config.checkpoint.max_pause );
+        if ( is_running ) {
+          config.checkpoint.capture();
+          stack.snapshot( jobs, next );
+          // どのスレッドもディレクトリを読んでいないので、エラーは増えない。
+          for ( auto & itr : workers ) { errors.insert( errors.end(), itr.errors().begin(), itr.errors().end() ); }
+        }
+        stack.resume();
+
+        if ( is_running ) {
+          std::vector<DirectoryJob> frontier;
+          frontier.reserve( jobs.size() + next.size() );
+          auto const append = [ &frontier ]( DirectoryJob const & job ){ frontier.emplace_back( job ); };
+          jobs.forEach( append );
+          next.forEach( append );
+          config.checkpoint.save( std::move( frontier ), std::move( errors ) );
+        }
+
+        lock.lock();
+      }
+    } );
+  }
+
+  // 0番目のワーカーは呼び出し元のスレッドで動かす。
+  ParallelFor( workers.size(), [ &workers ]( std::size_t const index ){ workers[index].run(); } );
+  if ( checkpointer.joinable() ) {
+    {
+      std::lock_guard<std::mutex> lock( checkpoint_mutex );
+      is_finished = true;
+    }
+    checkpoint_condition.notify_all();
+    checkpointer.join();
+  }
+  if ( config.on_root_done ) {
+    for ( std::size_t const itr : stack.unfinishedRoots() ) { config.on_root_done( itr ); }
+  }
+
+  ScanResult result;
+  for ( auto & itr : workers ) {
+    std::move( itr.errors().begin(), itr.errors().end(), std::back_inserter( result.errors ) );
+  }
+  result.is_approximate = stack.isTruncated();
+
+  return result;
+}
+
+} // namespace
+
+ScanResult Scan( ScanConfig const & config, std::vector<std::string> const & roots, std::vector<Sink *> const & sinks ) {
+  std::vector<DirectoryJob> jobs;
+  jobs.reserve( roots.size() );
+
+  // スタックなので、先に指定されたディレクトリから読まれるように逆順に積む。
+  for ( std::size_t index = roots.size(); index > 0; --index ) {
+    std::string const & root = roots[index - 1];
+    jobs.emplace_back( DirectoryJob{ root, static_cast<std::uint32_t>( root.size() ), 0, 0, Time::Max(), nullptr, static_cast<std::uint32_t>( index - 1 ) } );
+  }
+
+  return ScanJobs( config, std::move( jobs ), sinks );
+}
+
+ScanResult Resume( ScanConfig const & config, std::vector<DirectoryJob> && frontier, std::vector<Sink *> const & sinks ) {
+  return ScanJobs( config, std::move( frontier ), sinks );
+}
+
+} // lfl
@@ -29,4 +29,8 @@ function( create_executable TEST_NAME TEST_SOURCE_PATH )
   target_compile_features( ${TEST_NAME} PUBLIC cxx_std_20 )
 
   target_compile_definitions( ${TEST_NAME} PUBLIC BOOST_TEST_NO_LIB=1 )
+
+  # 本体のソースコードがstd::threadを使っているため
+  find_package( Threads REQUIRED )
+  target_link_libraries( ${TEST_NAME} PUBLIC Threads::Threads )
 endfunction( create_executable )
@@ -4,6 +4,7 @@
 #include <boost/test/tools/interface.hpp>
 #include <boost/test/tools/old/interface.hpp>
 
+#include <compare>
 #include <iostream>
 #include <string>
 
@@ -21,6 +22,21 @@ public:
   friend bool operator < ( IntClass const & i1, IntClass const & i2 ) noexcept { return( i1.i_ < i2.i_ ); }
 };
 
+// <=>演算子を持つ。呼ばれた回数を数える。
+class ThreeWayClass : public COMPARABLE::CompDef<ThreeWayClass> {
+private:
+  int i_;
+public:
+  static inline int count = 0;
+
+  ThreeWayClass( int const i ) : UTIL::COMPARABLE::CompDef<ThreeWayClass>(), i_( i ) {}
+
+  friend std::strong_ordering operator <=> ( ThreeWayClass const & i1, ThreeWayClass const & i2 ) noexcept {
+    ++count;
+    return( i1.i_ <=> i2.i_ );
+  }
+};
+
 class NotHaveLT : COMPARABLE::CompDef<NotHaveLT> {
 public:
 };
@@ -43,6 +59,11 @@ BOOST_AUTO_TEST_CASE( test_compare_assert ) {
   static_assert(!( COMPARABLE::has_less_than<NotHaveLT, NotHaveLT>::value ), "X < X is NOT defined");
 
   static_assert(!COMPARABLE::has_less_than<NotHaveLT, IntClass>::value, "X < IntClass is NOT defined");
+
+  // <=>演算子だけでも、<演算子は定義されているとみなす。
+  static_assert(COMPARABLE::has_three_way<ThreeWayClass, ThreeWayClass>::value, "ThreeWayClass does NOT have operator <=>");
+  static_assert(COMPARABLE::has_less_than<ThreeWayClass, ThreeWayClass>::value, "ThreeWayClass does NOT have operator <");
+  static_assert(!COMPARABLE::has_three_way<IntClass, IntClass>::value, "IntClass has operator <=>");
 }
 
 // プロパティベースのテスト
@@ -76,4 +97,46 @@ BOOST_AUTO_TEST_CASE( test_compare_correctness ) {
   BOOST_CHECK( non_minimum != minimum == 1 );
 }
 
+BOOST_AUTO_TEST_CASE( test_three_way_correctness ) {
+  ThreeWayClass minimum(0), non_minimum(1);
+
+  BOOST_CHECK( ( minimum < non_minimum ) == 1 );
+  BOOST_CHECK( ( minimum > non_minimum ) == 0 );
+  BOOST_CHECK( ( minimum <= non_minimum ) == 1 );
+  BOOST_CHECK( ( minimum >= non_minimum ) == 0 );
+  BOOST_CHECK( ( minimum == non_minimum ) == 0 );
+  BOOST_CHECK( ( minimum != non_minimum ) == 1 );
+
+  BOOST_CHECK( ( non_minimum < non_minimum ) == 0 );
+  BOOST_CHECK( ( non_minimum > non_minimum ) == 0 );
+  BOOST_CHECK( ( non_minimum <= non_minimum ) == 1 );
+  BOOST_CHECK( ( non_minimum >= non_minimum ) == 1 );
+  BOOST_CHECK( ( non_minimum == non_minimum ) == 1 );
+  BOOST_CHECK( ( non_minimum != non_minimum ) == 0 );
+
+  BOOST_CHECK( ( non_minimum < minimum ) == 0 );
+  BOOST_CHECK( ( non_minimum > minimum ) == 1 );
+  BOOST_CHECK( ( non_minimum <= minimum ) == 0 );
+  BOOST_CHECK( ( non_minimum >= minimum ) == 1 );
+  BOOST_CHECK( ( non_minimum == minimum ) == 0 );
+  BOOST_CHECK( ( non_minimum != minimum ) == 1 );
+}
+
+// どの比較演算子も、<=>演算子を一度呼ぶだけで済む。
+BOOST_AUTO_TEST_CASE( test_three_way_count ) {
+  ThreeWayClass const one(1), two(2);
+  bool results[6] = {};
+
+  ThreeWayClass::count = 0;
+  results[0] = ( one == two );
+  results[1] = ( one != two );
+  results[2] = ( one < two );
+  results[3] = ( one > two );
+  results[4] = ( one <= two );
+  results[5] = ( one >= two );
+  BOOST_CHECK( ThreeWayClass::count == 6 );
+
+  BOOST_CHECK( !results[0] && results[1] && results[2] && !results[3] && results[4] && !results[5] );
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -8,6 +8,7 @@
 #include <string>
 #include <cstring>
 #include <utility>
+#include <string_view>
 
 #define OPTION_LIST { "directory", "help", "version" }
 
@@ -178,6 +179,31 @@ BOOST_AUTO_TEST_CASE( test_operator_lt ) {
   BOOST_CHECK( ( "eirectory" < literal3 ) == false );
 }
 
+BOOST_AUTO_TEST_CASE( test_operator_three_way ) {
+  using namespace jig::STRING;
+
+  STATIC_CONSTEXPR Literal literal1( "b" );
+  STATIC_CONSTEXPR Literal literal2( "abc" );
+  STATIC_CONSTEXPR Literal literal3( "ab" );
+
+  // 辞書順(最初に異なる文字で決まり、先頭部分なら短い方が小さい)
+  static_assert( ( literal1 <=> literal2 ) > 0 );
+  static_assert( ( literal2 < literal1 ) == true );
+  static_assert( ( literal1 < literal2 ) == false );
+  static_assert( ( literal3 < literal2 ) == true );
+  static_assert( ( literal2 > literal3 ) == true );
+  static_assert( ( literal2 <= literal2 ) == true );
+  static_assert( ( literal3 >= literal2 ) == false );
+
+  static_assert( ( literal2 <=> "abc" ) == 0 );
+  static_assert( ( "abd" <=> literal2 ) > 0 );
+  static_assert( ( "b" < literal2 ) == false );
+
+  // 長さの違う型どうしも比べられる。
+  BOOST_CHECK( literal2 != literal3 );
+  BOOST_CHECK( literal1 == Literal( "b" ) );
+}
+
 BOOST_AUTO_TEST_CASE( test_operator_plassign ) {
   using namespace jig::STRING;
 
@@ -486,4 +512,26 @@ BOOST_AUTO_TEST_CASE( test_OptionListMatchIndex ) {
   BOOST_CHECK( index_typo == 2 );
 }
 
+BOOST_AUTO_TEST_CASE( test_MakeOptionList ) {
+  using namespace jig::OPTION;
+
+  STATIC_CONSTEXPR char const * options[] = { "directory", "help", "count" };
+  STATIC_CONSTEXPR auto option_list = MakeOptionList<options>();
+
+  static_assert( option_list.matchIndex( std::string_view( "count" ) ).second == 2 );
+
+  auto [ bool_help, index_help ] = option_list.matchIndex( std::string_view( "help" ) );
+  BOOST_CHECK( bool_help == true );
+  BOOST_CHECK( index_help == 1 );
+
+  // std::string_viewでは前方一致ではなく完全一致で判定する
+  auto [ bool_prefix, index_prefix ] = option_list.matchIndex( std::string_view( "helpme" ) );
+  BOOST_CHECK( bool_prefix == false );
+  BOOST_CHECK( index_prefix == 3 );
+
+  auto [ bool_short, index_short ] = option_list.matchIndex( std::string_view( "hel" ) );
+  BOOST_CHECK( bool_short == false );
+  BOOST_CHECK( index_short == 3 );
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,332 @@
+#include "lfl/Archive.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/tools/interface.hpp>
+#include <boost/test/tools/old/interface.hpp>
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE( test_archive )
+
+using namespace lfl;
+
+namespace {
+
+constexpr Time::rep SECOND = 1000000000;
+
+struct Member {
+  std::string path;
+  Time time;
+  std::uint64_t size;
+  EntryType type;
+};
+
+template<typename Function>
+std::vector<Member> Members( Function && for_each, std::string_view const data, bool const is_valid = true ) {
+  std::vector<Member> members;
+  bool const result = for_each( data, [ & ]( ArchiveMember const & member ){ members.emplace_back( Member{ std::string( member.path ), member.time, member.size, member.type } ); } );
+  BOOST_CHECK( result == is_valid );
+  return members;
+}
+
+std::vector<Member> TarMembers( std::string_view const data, bool const is_valid = true ) {
+  return Members( []( std::string_view const bytes, auto && function ){ return ARCHIVE::ForEachTarMember( bytes, function ); }, data, is_valid );
+}
+
+std::vector<Member> ZipMembers( std::string_view const data, bool const is_valid = true ) {
+  return Members( []( std::string_view const bytes, auto && function ){ return ARCHIVE::ForEachZipMember( bytes, function ); }, data, is_valid );
+}
+
+void PutOctal( std::string & header, std::size_t const offset, std::size_t const width, std::uint64_t const value ) {
+  char text[32];
+  std::snprintf( text, sizeof( text ), "%0*llo", static_cast<int>( width - 1 ), static_cast<unsigned long long>( value ) );
+  header.replace( offset, width - 1, text );
+}
+
+// チェックサムを付ける(ヘッダを書き換えた後は付け直す)。
+std::string Checksummed( std::string header ) {
+  std::uint64_t sum = 0;
+  header.replace( 148, 8, 8, ' ' );
+  for ( std::size_t index = 0; index < ARCHIVE::TAR_BLOCK; ++index ) { sum += static_cast<unsigned char>( header[index] ); }
+  PutOctal( header, 148, 8, sum );
+  return header;
+}
+
+// ustarのヘッダと、ブロックに切り上げた中身
+std::string TarMember( std::string_view const name, char const type, std::string_view const contents, std::uint64_t const mtime, std::string_view const prefix = std::string_view() ) {
+  std::string header( ARCHIVE::TAR_BLOCK, '\0' );
+  header.replace( 0, name.size(), name );
+  PutOctal( header, 100, 8, 0644 );
+  PutOctal( header, 124, 12, contents.size() );
+  PutOctal( header, 136, 12, mtime );
+  header[156] = type;
+  header.replace( 257, 6, std::string_view( "ustar\0", 6 ) );
+  header.replace( 263, 2, "00" );
+  header.replace( 345, prefix.size(), prefix );
+
+  std::string block( contents );
+  block.resize( ( contents.size() + ARCHIVE::TAR_BLOCK - 1 ) / ARCHIVE::TAR_BLOCK * ARCHIVE::TAR_BLOCK, '\0' );
+  return Checksummed( std::move( header ) ) + block;
+}
+
+std::string TarEnd() { return std::string( ARCHIVE::TAR_BLOCK * 2, '\0' ); }
+
+// paxの一つのレコード("長さ key=value\n"。長さは自分自身の桁を含む)
+std::string PaxRecord( std::string_view const key, std::string_view const value ) {
+  std::size_t const body = key.size() + value.size() + 3;
+  std::size_t length = body + 1;
+  if ( std::to_string( length ).size() + body != length ) { length = std::to_string( length ).size() + body; }
+  return std::to_string( length ).append( " " ).append( key ).append( "=" ).append( value ).append( "\n" );
+}
+
+void PutLittle( std::string & data, std::uint64_t value, std::size_t const bytes ) {
+  for ( std::size_t index = 0; index < bytes; ++index, value >>= 8 ) { data.push_back( static_cast<char>( value & 0xFF ) ); }
+}
+
+struct ZipEntry {
+  std::string name;
+  std::uint32_t size;
+  std::uint16_t dos_date;
+  std::uint16_t dos_time;
+  std::string extra;
+  std::uint16_t made_by = 20;
+  std::uint32_t external = 0;
+};
+
+// セントラルディレクトリと終端レコードだけのzip(ローカルヘッダと中身は読まないので置かない)
+std::string Zip( std::vector<ZipEntry> const & entries, std::string_view const comment = std::string_view() ) {
+  std::string data( "local headers would be here" );
+  std::size_t const central = data.size();
+
+  for ( auto const & itr : entries ) {
+    PutLittle( data, ARCHIVE::ZIP_CENTRAL_SIGNATURE, 4 );
+    PutLittle( data, itr.made_by, 2 );
+    PutLittle( data, 20, 2 );
+    PutLittle( data, 0, 2 );
+    PutLittle( data, 8, 2 );
+    PutLittle( data, itr.dos_time, 2 );
+    PutLittle( data, itr.dos_date, 2 );
+    PutLittle( data, 0, 4 );
+    PutLittle( data, itr.size, 4 );
+    PutLittle( data, itr.size, 4 );
+    PutLittle( data, itr.name.size(), 2 );
+    PutLittle( data, itr.extra.size(), 2 );
+    PutLittle( data, 0, 2 );
+    PutLittle( data, 0, 2 );
+    PutLittle( data, 0, 2 );
+    PutLittle( data, itr.external, 4 );
+    PutLittle( data, 0, 4 );
+    data.append( itr.name ).append( itr.extra );
+  }
+
+  std::size_t const central_size = data.size() - central;
+  PutLittle( data, ARCHIVE::ZIP_END_SIGNATURE, 4 );
+  PutLittle( data, 0, 4 );
+  PutLittle( data, entries.size(), 2 );
+  PutLittle( data, entries.size(), 2 );
+  PutLittle( data, central_size, 4 );
+  PutLittle( data, central, 4 );
+  PutLittle( data, comment.size(), 2 );
+  data.append( comment );
+
+  return data;
+}
+
+std::string ExtraField( std::uint16_t const id, std::string_view const value ) {
+  std::string field;
+  PutLittle( field, id, 2 );
+  PutLittle( field, value.size(), 2 );
+  return field.append( value );
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE( test_kind ) {
+  BOOST_CHECK( ARCHIVE::KindOf( "build.tar" ) == ArchiveKind::TAR );
+  BOOST_CHECK( ARCHIVE::KindOf( "BUILD.ZIP" ) == ArchiveKind::ZIP );
+  BOOST_CHECK( ARCHIVE::KindOf( "build.tar.gz" ) == ArchiveKind::NONE );
+  BOOST_CHECK( ARCHIVE::KindOf( "build.txt" ) == ArchiveKind::NONE );
+  // 拡張子だけの名前はアーカイブとみなさない
+  BOOST_CHECK( ARCHIVE::KindOf( ".zip" ) == ArchiveKind::NONE );
+
+  // ディレクトリを読んだバッファの名前(UTF-16)のまま
+  std::u16string_view const wide( u"アーカイブ.Zip" );
+  BOOST_CHECK( ARCHIVE::KindOf( wide.data(), wide.size() ) == ArchiveKind::ZIP );
+  std::u16string_view const non_ascii( u"a.ziｐ" );
+  BOOST_CHECK( ARCHIVE::KindOf( non_ascii.data(), non_ascii.size() ) == ArchiveKind::NONE );
+}
+
+BOOST_AUTO_TEST_CASE( test_tar_number ) {
+  BOOST_CHECK( ARCHIVE::ReadTarNumber( std::string_view( "00000001750\0", 12 ) ) == 01750 );
+  BOOST_CHECK( ARCHIVE::ReadTarNumber( "   17 " ) == 017 );
+  // base-256(8GiB以上の大きさ)
+  BOOST_CHECK( ARCHIVE::ReadTarNumber( std::string_view( "\x80\0\0\0\0\0\0\x02\0\0\0\0", 12 ) ) == ( std::uint64_t( 2 ) << 32 ) );
+
+  // 64bitに収まらないbase-256は最大値になる。
+  BOOST_CHECK( ARCHIVE::ReadTarNumber( std::string_view( "\x80\x01\0\0\0\0\0\0\0\0\0\0", 12 ) ) == static_cast<std::uint64_t>( -1 ) );
+
+  Time time;
+  BOOST_CHECK( ARCHIVE::ParsePaxTime( "1700000000.5", time ) && time.ns() == 1700000000 * SECOND + 500000000 );
+  BOOST_CHECK( ARCHIVE::ParsePaxTime( "1700000000.123456789", time ) && time.ns() == 1700000000 * SECOND + 123456789 );
+  BOOST_CHECK( ARCHIVE::ParsePaxTime( "-1", time ) && time.ns() == -SECOND );
+  // ナノ秒より下の桁は切り捨てる。
+  BOOST_CHECK( ARCHIVE::ParsePaxTime( "1.0000000019999", time ) && time.ns() == SECOND + 1 );
+
+  // Timeに収まる最大の秒と、それを超えるもの
+  std::string const max_seconds = std::to_string( ARCHIVE::MAX_ARCHIVE_SECONDS );
+  BOOST_CHECK( ARCHIVE::ParsePaxTime( max_seconds + ".999999999", time ) && time.ns() == ARCHIVE::MAX_ARCHIVE_SECONDS * SECOND + 999999999 );
+  BOOST_CHECK( !ARCHIVE::ParsePaxTime( std::to_string( ARCHIVE::MAX_ARCHIVE_SECONDS + 1 ), time ) );
+  BOOST_CHECK( !ARCHIVE::ParsePaxTime( "99999999999999999999999999", time ) );
+  BOOST_CHECK( !ARCHIVE::ParsePaxTime( "", time ) );
+  BOOST_CHECK( !ARCHIVE::ParsePaxTime( "12x", time ) );
+}
+
+BOOST_AUTO_TEST_CASE( test_tar ) {
+  std::string const data = TarMember( "out/", '5', "", 1600000000 )
+    + TarMember( "app.exe", '0', std::string( 1000, 'x' ), 1700000000, "out" )
+    + TarMember( "latest", '2', "", 1650000000 )
+    + TarEnd();
+
+  std::vector<Member> const members = TarMembers( data );
+  BOOST_REQUIRE( members.size() == 3 );
+
+  BOOST_CHECK( members[0].path == "out" );
+  BOOST_CHECK( members[0].type == EntryType::DIRECTORY );
+  BOOST_CHECK( members[0].time.ns() == 1600000000 * SECOND );
+
+  // ustarのprefixとnameをつなぐ
+  BOOST_CHECK( members[1].path == "out/app.exe" );
+  BOOST_CHECK( members[1].type == EntryType::FILE );
+  BOOST_CHECK( members[1].size == 1000 );
+  BOOST_CHECK( members[1].time.ns() == 1700000000 * SECOND );
+
+  BOOST_CHECK( members[2].type == EntryType::SYMLINK );
+
+  // 終わりの0のブロックが無くても、データの終わりまで読めればよい。
+  BOOST_CHECK( TarMembers( TarMember( "a", '0', "a", 1 ) ).size() == 1 );
+  BOOST_CHECK( TarMembers( "" ).empty() );
+}
+
+BOOST_AUTO_TEST_CASE( test_tar_extensions ) {
+  std::string const long_name( 150, 'n' );
+  std::string const pax = PaxRecord( "path", "pax/name.txt" ) + PaxRecord( "mtime", "1700000000.25" );
+  std::string const data = TarMember( "././@LongLink", 'L', long_name + '\0', 0 )
+    + TarMember( "short", '0', "abc", 1600000000 )
+    + TarMember( "PaxHeaders/x", 'x', pax, 0 )
+    + TarMember( "truncated", '0', "", 1600000000 )
+    + TarMember( "plain", '0', "", 1600000000 )
+    + TarEnd();
+
+  std::vector<Member> const members = TarMembers( data );
+  BOOST_REQUIRE( members.size() == 3 );
+
+  // 拡張ヘッダそのものはメンバーではない。値は直後のメンバーにだけ当てはめる。
+  BOOST_CHECK( members[0].path == long_name );
+  BOOST_CHECK( members[0].size == 3 );
+  BOOST_CHECK( members[1].path == "pax/name.txt" );
+  BOOST_CHECK( members[1].time.ns() == 1700000000 * SECOND + 250000000 );
+  BOOST_CHECK( members[2].path == "plain" );
+  BOOST_CHECK( members[2].time.ns() == 1600000000 * SECOND );
+}
+
+BOOST_AUTO_TEST_CASE( test_tar_broken ) {
+  std::string const first = TarMember( "first", '0', "abc", 1 );
+
+  // チェックサムが合わないところで止める(それまでのメンバーは渡す)。
+  std::string broken = first + TarMember( "second", '0', "abc", 2 ) + TarEnd();
+  broken[first.size() + 10] = 'x';
+  BOOST_CHECK( TarMembers( broken, false ).size() == 1 );
+
+  // 中身の途中で切れている
+  std::string const truncated = first + TarMember( "second", '0', std::string( 1000, 'x' ), 2 );
+  BOOST_CHECK( TarMembers( truncated.substr( 0, truncated.size() - ARCHIVE::TAR_BLOCK ), false ).size() == 1 );
+  BOOST_CHECK( TarMembers( first.substr( 0, 100 ), false ).empty() );
+
+  // tarでないもの
+  BOOST_CHECK( TarMembers( std::string( 2048, 'x' ), false ).empty() );
+
+  // 残りより大きなbase-256の大きさ(ブロックに切り上げると溢れる)
+  std::string huge = TarMember( "huge", '0', "", 1 );
+  huge.replace( 124, 12, std::string( 12, '\xFF' ) );
+  BOOST_CHECK( TarMembers( first + Checksummed( huge ) + TarEnd(), false ).size() == 1 );
+
+  // Timeに収まらないbase-256の時刻
+  std::string future = TarMember( "future", '0', "", 1 );
+  future.replace( 136, 12, std::string( "\x80\0\0\0\x7F\xFF\xFF\xFF\xFF\xFF\xFF\xFF", 12 ) );
+  BOOST_CHECK( TarMembers( first + Checksummed( future ) + TarEnd(), false ).size() == 1 );
+
+  // 溢れるpaxのmtimeは使わず、ヘッダの時刻のままにする。
+  std::string const pax = PaxRecord( "mtime", "99999999999999999999999" );
+  std::vector<Member> const members = TarMembers( TarMember( "PaxHeaders/x", 'x', pax, 0 ) + TarMember( "plain", '0', "", 1600000000 ) + TarEnd() );
+  BOOST_REQUIRE( members.size() == 1 );
+  BOOST_CHECK( members[0].time.ns() == 1600000000 * SECOND );
+}
+
+BOOST_AUTO_TEST_CASE( test_zip ) {
+  // 2024-05-01 12:30:14(DOSの時刻は2秒単位)
+  std::uint16_t const date = ( ( 2024 - 1980 ) << 9 ) | ( 5 << 5 ) | 1;
+  std::uint16_t const time = ( 12 << 11 ) | ( 30 << 5 ) | 7;
+  Time::rep const dos_ns = ( VALUE::DaysFromCivil( 2024, 5, 1 ) * 86400 + 12 * 3600 + 30 * 60 + 14 ) * SECOND;
+
+  std::string unix_time;
+  PutLittle( unix_time, 0x01, 1 );
+  PutLittle( unix_time, 1700000000, 4 );
+
+  std::string ntfs( 4, '\0' );
+  PutLittle( ntfs, 0x0001, 2 );
+  PutLittle( ntfs, 24, 2 );
+  PutLittle( ntfs, Time::FILETIME_UNIX_EPOCH + 1710000000ULL * 10000000 + 5, 8 );
+  PutLittle( ntfs, 0, 16 );
+
+  std::string zip64;
+  PutLittle( zip64, std::uint64_t( 5 ) << 32, 8 );
+
+  std::vector<ZipEntry> entries;
+  entries.emplace_back( ZipEntry{ "dir/", 0, date, time, "" } );
+  entries.emplace_back( ZipEntry{ "dir/dos.txt", 10, date, time, "" } );
+  entries.emplace_back( ZipEntry{ "dir/unix.txt", 20, date, time, ExtraField( 0x5455, unix_time ) } );
+  // NTFSの時刻を、拡張タイムスタンプより優先する。
+  entries.emplace_back( ZipEntry{ "ntfs.txt", 30, date, time, ExtraField( 0x5455, unix_time ) + ExtraField( 0x000a, ntfs ) } );
+  entries.emplace_back( ZipEntry{ "huge.bin", 0xFFFFFFFF, date, time, ExtraField( 0x0001, zip64 ) } );
+  // UNIXで作られた、シンボリックリンク(S_IFLNK)
+  entries.emplace_back( ZipEntry{ "link", 4, date, time, "", ( 3 << 8 ) | 20, 0120777u << 16 } );
+
+  std::vector<Member> const members = ZipMembers( Zip( entries, "archive comment" ) );
+  BOOST_REQUIRE( members.size() == 6 );
+
+  BOOST_CHECK( members[0].path == "dir" );
+  BOOST_CHECK( members[0].type == EntryType::DIRECTORY );
+  BOOST_CHECK( members[1].path == "dir/dos.txt" );
+  BOOST_CHECK( members[1].size == 10 );
+  BOOST_CHECK( members[1].time.ns() == dos_ns );
+  BOOST_CHECK( members[2].time.ns() == 1700000000 * SECOND );
+  BOOST_CHECK( members[3].time.ns() == 1710000000 * SECOND + 500 );
+  BOOST_CHECK( members[4].size == ( std::uint64_t( 5 ) << 32 ) );
+  BOOST_CHECK( members[5].type == EntryType::SYMLINK );
+}
+
+BOOST_AUTO_TEST_CASE( test_zip_broken ) {
+  std::vector<ZipEntry> entries;
+  entries.emplace_back( ZipEntry{ "a.txt", 1, 0x21, 0, "" } );
+  entries.emplace_back( ZipEntry{ "b.txt", 1, 0x21, 0, "" } );
+  std::string const data = Zip( entries );
+
+  BOOST_CHECK( ZipMembers( data ).size() == 2 );
+  // 終端レコードが無い
+  BOOST_CHECK( ZipMembers( data.substr( 0, data.size() - 1 ), false ).empty() );
+  BOOST_CHECK( ZipMembers( "PK", false ).empty() );
+
+  // 2つ目のセントラルディレクトリのレコードが壊れている
+  std::string broken = data;
+  broken[broken.find( "b.txt" ) - ARCHIVE::ZIP_CENTRAL_SIZE] = 'x';
+  BOOST_CHECK( ZipMembers( broken, false ).size() == 1 );
+
+  BOOST_CHECK( ZipMembers( Zip( {} ) ).empty() );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,122 @@
+#include "lfl/Cache.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/tools/interface.hpp>
+#include <boost/test/tools/old/interface.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+
+BOOST_AUTO_TEST_SUITE( test_cache )
+
+using namespace lfl::CACHE;
+
+namespace {
+
+constexpr std::uint64_t SECOND = 1000000000ULL;
+
+// 新しく作られた共有メモリと同じく、0で埋まった領域
+std::unique_ptr<Segment> MakeSegment() { return std::make_unique<Segment>(); }
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE( test_round_trip ) {
+  auto const segment = MakeSegment();
+  std::string result;
+
+  // 空の領域には何も無い
+  BOOST_CHECK( !Load( *segment, 1, 2, 100 * SECOND, 5 * SECOND, result ) );
+
+  BOOST_CHECK( Store( *segment, 1, 2, 100 * SECOND, "dir\\latest.txt\n" ) );
+  BOOST_CHECK( Load( *segment, 1, 2, 101 * SECOND, 5 * SECOND, result ) );
+  BOOST_CHECK( result == "dir\\latest.txt\n" );
+
+  // 8バイトの倍数でない大きさ、NULを含む出力もそのまま戻る
+  std::string const binary( "a\0b\0c\0d\0e", 9 );
+  BOOST_CHECK( Store( *segment, 1, 2, 100 * SECOND, binary ) );
+  BOOST_CHECK( Load( *segment, 1, 2, 100 * SECOND, 5 * SECOND, result ) );
+  BOOST_CHECK( result == binary );
+}
+
+BOOST_AUTO_TEST_CASE( test_invalidation ) {
+  auto const segment = MakeSegment();
+  std::string result;
+  BOOST_CHECK( Store( *segment, 1, 2, 100 * SECOND, "x\n" ) );
+
+  // TTLが過ぎたもの
+  BOOST_CHECK( !Load( *segment, 1, 2, 105 * SECOND, 5 * SECOND, result ) );
+  BOOST_CHECK( Load( *segment, 1, 2, 105 * SECOND - 1, 5 * SECOND, result ) );
+  // 起点の更新時刻が変わったもの
+  BOOST_CHECK( !Load( *segment, 1, 3, 101 * SECOND, 5 * SECOND, result ) );
+  // 同じスロットに入る別のキー
+  BOOST_CHECK( !Load( *segment, 1 + SLOT_NUM, 2, 101 * SECOND, 5 * SECOND, result ) );
+  // 時計が戻ったときは使わない
+  BOOST_CHECK( !Load( *segment, 1, 2, 99 * SECOND, 5 * SECOND, result ) );
+
+  // 後から保存したキーが、同じスロットの前のキーを追い出す
+  BOOST_CHECK( Store( *segment, 1 + SLOT_NUM, 2, 100 * SECOND, "y\n" ) );
+  BOOST_CHECK( !Load( *segment, 1, 2, 101 * SECOND, 5 * SECOND, result ) );
+  BOOST_CHECK( Load( *segment, 1 + SLOT_NUM, 2, 101 * SECOND, 5 * SECOND, result ) );
+  BOOST_CHECK( result == "y\n" );
+}
+
+BOOST_AUTO_TEST_CASE( test_capacity ) {
+  auto const segment = MakeSegment();
+  std::string result;
+
+  BOOST_CHECK( Store( *segment, 1, 2, 100 * SECOND, std::string( SLOT_CAPACITY, 'a' ) ) );
+  BOOST_CHECK( Load( *segment, 1, 2, 100 * SECOND, SECOND, result ) );
+  BOOST_CHECK( result.size() == SLOT_CAPACITY );
+
+  // 収まらない出力と空の出力は保存しない
+  BOOST_CHECK( !Store( *segment, 3, 2, 100 * SECOND, std::string( SLOT_CAPACITY + 1, 'a' ) ) );
+  BOOST_CHECK( !Store( *segment, 4, 2, 100 * SECOND, "" ) );
+}
+
+BOOST_AUTO_TEST_CASE( test_writer_in_progress ) {
+  auto const segment = MakeSegment();
+  std::string result;
+  BOOST_CHECK( Store( *segment, 1, 2, 100 * SECOND, "x\n" ) );
+
+  // 他のプロセスが書き込み中(sequenceが奇数)なら、読み手は使わず、書き手は保存をあきらめる
+  Slot & slot = SlotOf( *segment, 1 );
+  std::atomic_ref<std::uint64_t>( slot.sequence ).fetch_add( 1 );
+  BOOST_CHECK( !Load( *segment, 1, 2, 100 * SECOND, SECOND, result ) );
+  BOOST_CHECK( !Store( *segment, 1, 2, 100 * SECOND, "y\n" ) );
+
+  std::atomic_ref<std::uint64_t>( slot.sequence ).fetch_add( 1 );
+  BOOST_CHECK( Load( *segment, 1, 2, 100 * SECOND, SECOND, result ) );
+  BOOST_CHECK( result == "x\n" );
+}
+
+BOOST_AUTO_TEST_CASE( test_concurrent ) {
+  auto const segment = MakeSegment();
+  std::string const outputs[] = { std::string( 1000, 'a' ), std::string( 3000, 'b' ) };
+
+  // 書き手が入れ替え続ける間に読んでも、どちらかの出力が欠けずに読める
+  std::atomic<bool> is_done( false );
+  std::thread writer( [ & ] {
+    for ( int index = 0; index < 20000; ++index ) { Store( *segment, 1, 2, 100 * SECOND, outputs[index % 2] ); }
+    is_done = true;
+  } );
+
+  std::string result;
+  bool is_consistent = true;
+  while ( !is_done ) {
+    if ( Load( *segment, 1, 2, 100 * SECOND, SECOND, result ) ) { is_consistent = is_consistent && ( result == outputs[0] || result == outputs[1] ); }
+  }
+  writer.join();
+
+  BOOST_CHECK( is_consistent );
+}
+
+BOOST_AUTO_TEST_CASE( test_hasher ) {
+  BOOST_CHECK( Hasher().add( "ab" ).add( "c" ).value() != Hasher().add( "a" ).add( "bc" ).value() );
+  BOOST_CHECK( Hasher().add( "ab" ).value() == Hasher().add( "ab" ).value() );
+  BOOST_CHECK( Hasher().add( std::uint64_t( 1 ) ).value() != Hasher().add( std::uint64_t( 2 ) ).value() );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,158 @@
+#include "lfl/Checkpoint.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/tools/interface.hpp>
+#include <boost/test/tools/old/interface.hpp>
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+
+BOOST_AUTO_TEST_SUITE( test_checkpoint )
+
+using namespace lfl;
+using namespace lfl::CHECKPOINT;
+
+namespace {
+
+Entry MakeEntry( std::string const & path, std::uint32_t const name_offset, std::int64_t const ns ) {
+  Entry entry;
+  entry.path = path;
+  entry.name_offset = name_offset;
+  entry.type = EntryType::FILE;
+  entry.size = 1234567;
+  entry.time = Time( ns );
+  return entry;
+}
+
+DirectoryJob MakeJob( std::string const & path, std::uint32_t const depth, Time const priority, std::uint32_t const root ) {
+  return DirectoryJob{ path, 3, depth, 0xdeadbeef, priority, nullptr, root };
+}
+
+State MakeState() {
+  State state;
+  state.roots = { "C:\\", "D:\\data\\" };
+  state.entries.emplace_back( MakeEntry( "C:\\a\\new.txt", 5, 1700000000000000000 ) );
+  state.entries.emplace_back( MakeEntry( "D:\\data\\old.txt", 8, -5 ) );
+  state.frontier.emplace_back( MakeJob( "C:\\a\\b\\", 2, Time::Max(), 0 ) );
+  state.frontier.emplace_back( MakeJob( "C:\\a\\c\\", 2, Time::Min(), 0 ) );
+  state.frontier.emplace_back( MakeJob( "D:\\data\\x\\", 1, Time( 42 ), 1 ) );
+  state.errors = { "C:\\denied\\", "D:\\data\\gone\\" };
+  return state;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE( test_number ) {
+  std::string out;
+  for ( std::uint64_t const itr : { std::uint64_t( 0 ), std::uint64_t( 127 ), std::uint64_t( 128 ), std::numeric_limits<std::uint64_t>::max() } ) { WriteNumber( out, itr ); }
+  for ( std::int64_t const itr : { std::int64_t( 0 ), std::int64_t( -1 ), std::numeric_limits<std::int64_t>::min(), std::numeric_limits<std::int64_t>::max() } ) { WriteSigned( out, itr ); }
+  // 小さい数は1バイトで済む
+  BOOST_CHECK( static_cast<unsigned char>( out[0] ) == 0 );
+  BOOST_CHECK( static_cast<unsigned char>( out[1] ) == 127 );
+
+  std::string_view data( out );
+  std::uint64_t number = 0;
+  BOOST_CHECK( ReadNumber( data, number ) && number == 0 );
+  BOOST_CHECK( ReadNumber( data, number ) && number == 127 );
+  BOOST_CHECK( ReadNumber( data, number ) && number == 128 );
+  BOOST_CHECK( ReadNumber( data, number ) && number == std::numeric_limits<std::uint64_t>::max() );
+
+  std::int64_t value = 1;
+  BOOST_CHECK( ReadSigned( data, value ) && value == 0 );
+  BOOST_CHECK( ReadSigned( data, value ) && value == -1 );
+  BOOST_CHECK( ReadSigned( data, value ) && value == std::numeric_limits<std::int64_t>::min() );
+  BOOST_CHECK( ReadSigned( data, value ) && value == std::numeric_limits<std::int64_t>::max() );
+  BOOST_CHECK( data.empty() );
+  BOOST_CHECK( !ReadNumber( data, number ) );
+}
+
+BOOST_AUTO_TEST_CASE( test_round_trip ) {
+  State const state = MakeState();
+  std::string encoded;
+  Encode( state, encoded );
+
+  State decoded;
+  BOOST_REQUIRE( Decode( encoded, decoded ) );
+  BOOST_CHECK( decoded.roots == state.roots );
+
+  BOOST_REQUIRE( decoded.entries.size() == 2 );
+  for ( std::size_t index = 0; index < 2; ++index ) {
+    BOOST_CHECK( decoded.entries[index].path == state.entries[index].path );
+    BOOST_CHECK( decoded.entries[index].name_offset == state.entries[index].name_offset );
+    BOOST_CHECK( decoded.entries[index].type == state.entries[index].type );
+    BOOST_CHECK( decoded.entries[index].size == state.entries[index].size );
+    BOOST_CHECK( decoded.entries[index].time.ns() == state.entries[index].time.ns() );
+  }
+  BOOST_CHECK( decoded.entries[1].name() == "old.txt" );
+
+  BOOST_REQUIRE( decoded.frontier.size() == 3 );
+  for ( std::size_t index = 0; index < 3; ++index ) {
+    BOOST_CHECK( decoded.frontier[index].path == state.frontier[index].path );
+    BOOST_CHECK( decoded.frontier[index].root_length == 3 );
+    BOOST_CHECK( decoded.frontier[index].depth == state.frontier[index].depth );
+    BOOST_CHECK( decoded.frontier[index].volume == 0xdeadbeef );
+    BOOST_CHECK( decoded.frontier[index].priority.ns() == state.frontier[index].priority.ns() );
+    BOOST_CHECK( decoded.frontier[index].root == state.frontier[index].root );
+  }
+  BOOST_CHECK( decoded.errors == state.errors );
+
+  // 空の状態(走査を終えたとき)も読み戻せる
+  State empty;
+  Encode( State{}, encoded );
+  BOOST_CHECK( Decode( encoded, empty ) );
+  BOOST_CHECK( empty.roots.empty() && empty.entries.empty() && empty.frontier.empty() && empty.errors.empty() );
+}
+
+BOOST_AUTO_TEST_CASE( test_prefix ) {
+  // 兄弟のディレクトリは親のパスを繰り返さない
+  State state;
+  state.roots = { "C:\\" };
+  std::string const parent( 200, 'p' );
+  for ( char name = 'a'; name <= 'z'; ++name ) { state.frontier.emplace_back( MakeJob( "C:\\" + parent + "\\" + name + "\\", 2, Time( 0 ), 0 ) ); }
+
+  std::string encoded;
+  Encode( state, encoded );
+  BOOST_CHECK( encoded.size() < parent.size() + state.frontier.size() * 16 );
+
+  State decoded;
+  BOOST_REQUIRE( Decode( encoded, decoded ) );
+  BOOST_REQUIRE( decoded.frontier.size() == state.frontier.size() );
+  for ( std::size_t index = 0; index < state.frontier.size(); ++index ) { BOOST_CHECK( decoded.frontier[index].path == state.frontier[index].path ); }
+}
+
+BOOST_AUTO_TEST_CASE( test_broken ) {
+  std::string encoded;
+  Encode( MakeState(), encoded );
+
+  State decoded;
+  // 途中で切れているもの
+  for ( std::size_t size = 0; size < encoded.size(); ++size ) { BOOST_CHECK( !Decode( std::string_view( encoded ).substr( 0, size ), decoded ) ); }
+  // 後ろに余計なものがあるもの
+  BOOST_CHECK( !Decode( encoded + '\0', decoded ) );
+  // 別の形式のもの(読めなかったディレクトリを持たない、前の形式も含む)
+  std::string other = encoded;
+  other[7] = '1';
+  BOOST_CHECK( !Decode( other, decoded ) );
+
+  // 名前の位置がパスを越えているエントリ
+  State state = MakeState();
+  state.entries.front().name_offset = static_cast<std::uint32_t>( state.entries.front().path.size() + 1 );
+  Encode( state, encoded );
+  BOOST_CHECK( !Decode( encoded, decoded ) );
+
+  // 無い起点を指すディレクトリ
+  state = MakeState();
+  state.frontier.back().root = 2;
+  Encode( state, encoded );
+  BOOST_CHECK( !Decode( encoded, decoded ) );
+
+  // 起点より短いディレクトリ
+  state = MakeState();
+  state.frontier.front().path = "C:";
+  Encode( state, encoded );
+  BOOST_CHECK( !Decode( encoded, decoded ) );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
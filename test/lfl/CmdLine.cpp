@@ -0,0 +1,427 @@
+#include "lfl/CmdLine.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/tools/interface.hpp>
+#include <boost/test/tools/old/interface.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+BOOST_AUTO_TEST_SUITE( test_cmdline )
+
+using namespace lfl;
+
+BOOST_AUTO_TEST_CASE( test_directories ) {
+  char const * argv[] = { "lfl", "dirA", "--directory", "dirB", "dirC" };
+  CmdLine cmd_line( jig::ArraySize( argv ), argv );
+
+  BOOST_CHECK( cmd_line.argNum() == 3 );
+
+  auto directories = cmd_line.optionList( "directory" );
+  BOOST_REQUIRE( directories.size() == 3 );
+  BOOST_CHECK( directories[0] == "dirA" );
+  BOOST_CHECK( directories[1] == "dirB" );
+  BOOST_CHECK( directories[2] == "dirC" );
+
+  // argvの文字列をコピーせずに参照していること
+  BOOST_CHECK( directories[0].data() == argv[1] );
+  BOOST_CHECK( directories[1].data() == argv[3] );
+}
+
+BOOST_AUTO_TEST_CASE( test_binomial_value ) {
+  char const * argv[] = { "lfl", "--count", "3", "--time=access", "dir" };
+  CmdLine cmd_line( jig::ArraySize( argv ), argv );
+
+  BOOST_CHECK( cmd_line.isThere( "count" ) );
+  BOOST_CHECK( cmd_line.isThere( "time" ) );
+  BOOST_CHECK( !cmd_line.isThere( "help" ) );
+
+  Options options = ParseOptions( cmd_line );
+  BOOST_CHECK( options.count == 3 );
+  BOOST_CHECK( options.time_field == TimeField::ACCESS );
+  BOOST_REQUIRE( options.directories.size() == 1 );
+  BOOST_CHECK( options.directories[0] == "dir" );
+}
+
+BOOST_AUTO_TEST_CASE( test_dash_value ) {
+  // '-'で始まる値は'='で連結すれば渡せる。
+  char const * argv[] = { "lfl", "--name=-foo", "--exclude=--bar", "dir" };
+  Options const options = ParseOptions( CmdLine( jig::ArraySize( argv ), argv ) );
+  BOOST_CHECK( ( options.filter.names == std::vector<std::string_view>{ "-foo" } ) );
+  BOOST_CHECK( ( options.excludes == std::vector<std::string_view>{ "--bar" } ) );
+  BOOST_CHECK( ( options.directories == std::vector<std::string_view>{ "dir" } ) );
+
+  // 値として読んだ引数は、オプションとしては扱わない。
+  char const * argv_help[] = { "lfl", "--name", "help", "dir" };
+  Options const help = ParseOptions( CmdLine( jig::ArraySize( argv_help ), argv_help ) );
+  BOOST_CHECK( !help.help );
+  BOOST_CHECK( ( help.directories == std::vector<std::string_view>{ "dir" } ) );
+}
+
+BOOST_AUTO_TEST_CASE( test_options_end ) {
+  char const * argv[] = { "lfl", "--count=2", "--", "--help", "dir" };
+  Options options = ParseOptions( CmdLine( jig::ArraySize( argv ), argv ) );
+
+  BOOST_CHECK( !options.help );
+  BOOST_CHECK( options.count == 2 );
+  BOOST_REQUIRE( options.directories.size() == 2 );
+  BOOST_CHECK( options.directories[0] == "--help" );
+  BOOST_CHECK( options.directories[1] == "dir" );
+}
+
+BOOST_AUTO_TEST_CASE( test_merge_command ) {
+  char const * argv_merge[] = { "lfl", "merge", "--count", "2", "a.bin" };
+  BOOST_CHECK( IsMergeCommand( jig::ArraySize( argv_merge ), argv_merge ) );
+
+  // "--"の後の"merge"は、その名前のディレクトリ
+  char const * argv_directory[] = { "lfl", "--", "merge" };
+  BOOST_CHECK( !IsMergeCommand( jig::ArraySize( argv_directory ), argv_directory ) );
+  Options const directory = ParseOptions( CmdLine( jig::ArraySize( argv_directory ), argv_directory ) );
+  BOOST_CHECK( ( directory.directories == std::vector<std::string_view>{ "merge" } ) );
+
+  // 最初の引数でなければサブコマンドではない。
+  char const * argv_second[] = { "lfl", "-r", "merge" };
+  BOOST_CHECK( !IsMergeCommand( jig::ArraySize( argv_second ), argv_second ) );
+
+  char const * argv_none[] = { "lfl" };
+  BOOST_CHECK( !IsMergeCommand( jig::ArraySize( argv_none ), argv_none ) );
+}
+
+BOOST_AUTO_TEST_CASE( test_format ) {
+  char const * argv_null[] = { "lfl", "-0", "dir" };
+  Options null_data = ParseOptions( CmdLine( jig::ArraySize( argv_null ), argv_null ) );
+  BOOST_CHECK( null_data.format == Format::NUL );
+  BOOST_CHECK( null_data.directories.size() == 1 );
+
+  // 最後に指定された出力形式を採用する
+  char const * argv_json[] = { "lfl", "--binary", "--json" };
+  BOOST_CHECK( ParseOptions( CmdLine( jig::ArraySize( argv_json ), argv_json ) ).format == Format::JSON );
+
+  // 別名ではない"-9"はディレクトリの名前
+  char const * argv_directory[] = { "lfl", "-9", "-0" };
+  Options const directory = ParseOptions( CmdLine( jig::ArraySize( argv_directory ), argv_directory ) );
+  BOOST_CHECK( directory.format == Format::NUL );
+  BOOST_CHECK( ( directory.directories == std::vector<std::string_view>{ "-9" } ) );
+
+  // 別名と同じ名前のディレクトリは"--"の後に書く
+  char const * argv_end[] = { "lfl", "--", "-0" };
+  Options const end = ParseOptions( CmdLine( jig::ArraySize( argv_end ), argv_end ) );
+  BOOST_CHECK( end.format == Format::TEXT );
+  BOOST_CHECK( ( end.directories == std::vector<std::string_view>{ "-0" } ) );
+}
+
+BOOST_AUTO_TEST_CASE( test_links ) {
+  char const * argv[] = { "lfl", "-r", "-L", "--unique-inodes", "dir" };
+  Options options = ParseOptions( CmdLine( jig::ArraySize( argv ), argv ) );
+  BOOST_CHECK( options.recursive );
+  BOOST_CHECK( options.follow_links );
+  BOOST_CHECK( options.unique_inodes );
+  BOOST_CHECK( options.directories.size() == 1 );
+
+  char const * argv_default[] = { "lfl", "dir" };
+  Options defaults = ParseOptions( CmdLine( jig::ArraySize( argv_default ), argv_default ) );
+  BOOST_CHECK( !defaults.follow_links );
+  BOOST_CHECK( !defaults.unique_inodes );
+}
+
+BOOST_AUTO_TEST_CASE( test_traversal ) {
+  char const * argv[] = { "lfl", "--max-depth", "3", "--order=bfs", "--xdev", "dir" };
+  Options options = ParseOptions( CmdLine( jig::ArraySize( argv ), argv ) );
+  BOOST_CHECK( options.max_depth == 3 );
+  // --max-depthは--recursiveを含む
+  BOOST_CHECK( options.recursive );
+  BOOST_CHECK( options.order == TraversalOrder::BFS );
+  BOOST_CHECK( options.one_file_system );
+
+  char const * argv_default[] = { "lfl", "-r" };
+  Options defaults = ParseOptions( CmdLine( jig::ArraySize( argv_default ), argv_default ) );
+  BOOST_CHECK( defaults.max_depth == UNLIMITED_DEPTH );
+  BOOST_CHECK( defaults.order == TraversalOrder::DFS );
+
+  char const * argv_zero[] = { "lfl", "--max-depth", "0" };
+  BOOST_CHECK_THROW( ParseOptions( CmdLine( jig::ArraySize( argv_zero ), argv_zero ) ), std::invalid_argument );
+
+  char const * argv_order[] = { "lfl", "--order", "random" };
+  BOOST_CHECK_THROW( ParseOptions( CmdLine( jig::ArraySize( argv_order ), argv_order ) ), std::invalid_argument );
+}
+
+BOOST_AUTO_TEST_CASE( test_deadline ) {
+  char const * argv[] = { "lfl", "-r", "--deadline", "50" };
+  Options options = ParseOptions( CmdLine( jig::ArraySize( argv ), argv ) );
+  BOOST_CHECK( options.deadline == std::chrono::milliseconds( 50 ) );
+  // 順序の指定が無ければ最良優先にする
+  BOOST_CHECK( options.order == TraversalOrder::BEST );
+
+  char const * argv_order[] = { "lfl", "--order=bfs", "--deadline", "2s" };
+  Options ordered = ParseOptions( CmdLine( jig::ArraySize( argv_order ), argv_order ) );
+  BOOST_CHECK( ordered.deadline == std::chrono::seconds( 2 ) );
+  BOOST_CHECK( ordered.order == TraversalOrder::BFS );
+
+  char const * argv_zero[] = { "lfl", "--deadline", "0" };
+  BOOST_CHECK_THROW( ParseOptions( CmdLine( jig::ArraySize( argv_zero ), argv_zero ) ), std::invalid_argument );
+}
+
+BOOST_AUTO_TEST_CASE( test_budget ) {
+  char const * argv[] = { "lfl", "--max-open", "256", "--max-frontier", "16M" };
+  Options options = ParseOptions( CmdLine( jig::ArraySize( argv ), argv ) );
+  BOOST_CHECK( options.max_open == 256 );
+  BOOST_CHECK( options.max_frontier == ( std::size_t( 16 ) << 20 ) );
+
+  // ディレクトリと問い合わせのハンドルを同時に開くので、2より少なくはできない
+  char const * argv_small[] = { "lfl", "--max-open", "1" };
+  BOOST_CHECK_THROW( ParseOptions( CmdLine( jig::ArraySize( argv_small ), argv_small ) ), std::invalid_argument );
+}
+
+BOOST_AUTO_TEST_CASE( test_from_stdin ) {
+  char const * argv[] = { "lfl", "--from-stdin", "-0", "--count", "3" };
+  Options options = ParseOptions( CmdLine( jig::ArraySize( argv ), argv ) );
+  BOOST_CHECK( options.from_stdin );
+  // -0は入力の区切りにも使う
+  BOOST_CHECK( options.format == Format::NUL );
+  BOOST_CHECK( options.directories.empty() );
+
+  char const * argv_deadline[] = { "lfl", "--from-stdin", "--deadline", "2s" };
+  BOOST_CHECK( ParseOptions( CmdLine( jig::ArraySize( argv_deadline ), argv_deadline ) ).deadline == std::chrono::seconds( 2 ) );
+
+  // ディレクトリを辿らないので、辿り方の指定は効かない。
+  char const * argv_depth[] = { "lfl", "--from-stdin", "--max-depth", "2" };
+  BOOST_CHECK_THROW( ParseOptions( CmdLine( jig::ArraySize( argv_depth ), argv_depth ) ), std::invalid_argument );
+  char const * argv_xdev[] = { "lfl", "--xdev", "--from-stdin" };
+  BOOST_CHECK_THROW( ParseOptions( CmdLine( jig::ArraySize( argv_xdev ), argv_xdev ) ), std::invalid_argument );
+  char const * argv_order[] = { "lfl", "--from-stdin", "--order", "bfs" };
+  BOOST_CHECK_THROW( ParseOptions( CmdLine( jig::ArraySize( argv_order ), argv_order ) ), std::invalid_argument );
+}
+
+BOOST_AUTO_TEST_CASE( test_filter ) {
+  char const * argv[] = { "lfl", "--name", "*.log", "--name=*.txt", "--min-size", "1M", "--type", "file", "--mtime-range", "..2024-01-01" };
+  Options options = ParseOptions( CmdLine( jig::ArraySize( argv ), argv ) );
+  BOOST_CHECK( options.filter.names.size() == 2 );
+  BOOST_CHECK( options.filter.min_size == ( std::uint64_t( 1 ) << 20 ) );
+  BOOST_CHECK( options.filter.type_mask == ( 1U << static_cast<unsigned>( EntryType::FILE ) ) );
+  BOOST_CHECK( options.filter.min_time == Time::Min() );
+  BOOST_CHECK( options.filter.max_time < Time::Max() );
+
+  char const * reversed_argv[] = { "lfl", "--min-size", "2K", "--max-size", "1K" };
+  BOOST_CHECK_THROW( ParseOptions( CmdLine( jig::ArraySize( reversed_argv ), reversed_argv ) ), std::invalid_argument );
+
+  char const * type_argv[] = { "lfl", "--type", "fifo" };
+  BOOST_CHECK_THROW( ParseOptions( CmdLine( jig::ArraySize( type_argv ), type_argv ) ), std::invalid_argument );
+}
+
+BOOST_AUTO_TEST_CASE( test_exclude ) {
+  char const * argv[] = { "lfl", "--exclude", "node_modules", "--exclude=.git/", "--exclude-from", "rules.txt", "--gitignore", "dir" };
+  Options options = ParseOptions( CmdLine( jig::ArraySize( argv ), argv ) );
+  BOOST_CHECK( ( options.excludes == std::vector<std::string_view>{ "node_modules", ".git/" } ) );
+  BOOST_CHECK( ( options.exclude_files == std::vector<std::string_view>{ "rules.txt" } ) );
+  BOOST_CHECK( options.gitignore );
+  BOOST_CHECK( ( options.directories == std::vector<std::string_view>{ "dir" } ) );
+}
+
+BOOST_AUTO_TEST_CASE( test_group_by ) {
+  char const * argv[] = { "lfl", "--group-by=ext", "--count", "2", "dir" };
+  Options options = ParseOptions( CmdLine( jig::ArraySize( argv ), argv ) );
+  BOOST_CHECK( options.group_by == GroupBy::EXT );
+  BOOST_CHECK( options.count == 2 );
+
+  char const * argv_default[] = { "lfl" };
+  BOOST_CHECK( ParseOptions( CmdLine( jig::ArraySize( argv_default ), argv_default ) ).group_by == GroupBy::NONE );
+
+  char const * argv_unknown[] = { "lfl", "--group-by", "size" };
+  BOOST_CHECK_THROW( ParseOptions( CmdLine( jig::ArraySize( argv_unknown ), argv_unknown ) ), std::invalid_argument );
+  // グループごとの出力は、バイナリ形式やすべてを並べる出力と組み合わせられない。
+  char const * argv_binary[] = { "lfl", "--group-by", "dir1", "--binary" };
+  BOOST_CHECK_THROW( ParseOptions( CmdLine( jig::ArraySize( argv_binary ), argv_binary ) ), std::invalid_argument );
+  char const * argv_sort[] = { "lfl", "--group-by", "owner", "--sort" };
+  BOOST_CHECK_THROW( ParseOptions( CmdLine( jig::ArraySize( argv_sort ), argv_sort ) ), std::invalid_argument );
+}
+
+BOOST_AUTO_TEST_CASE( test_tree ) {
+  char const * argv[] = { "lfl", "--tree", "--max-depth", "2", "dir" };
+  Options options = ParseOptions( CmdLine( jig::ArraySize( argv ), argv ) );
+  BOOST_CHECK( options.tree );
+  BOOST_CHECK( options.recursive );
+  BOOST_CHECK( options.max_depth == 2 );
+
+  char const * argv_sort[] = { "lfl", "--tree", "--sort" };
+  BOOST_CHECK_THROW( ParseOptions( CmdLine( jig::ArraySize( argv_sort ), argv_sort ) ), std::invalid_argument );
+  char const * argv_stdin[] = { "lfl", "--tree", "--from-stdin" };
+  BOOST_CHECK_THROW( ParseOptions( CmdLine( jig::ArraySize( argv_stdin ), argv_stdin ) ), std::invalid_argument );
+}
+
+BOOST_AUTO_TEST_CASE( test_per_root ) {
+  char const * argv[] = { "lfl", "--per-root", "-r", "a", "b" };
+  Options options = ParseOptions( CmdLine( jig::ArraySize( argv ), argv ) );
+  BOOST_CHECK( options.per_root );
+  BOOST_CHECK( ( options.directories == std::vector<std::string_view>{ "a", "b" } ) );
+
+  char const * argv_tree[] = { "lfl", "--per-root", "--tree" };
+  BOOST_CHECK_THROW( ParseOptions( CmdLine( jig::ArraySize( argv_tree ), argv_tree ) ), std::invalid_argument );
+  char const * argv_binary[] = { "lfl", "--per-root", "--binary" };
+  BOOST_CHECK_THROW( ParseOptions( CmdLine( jig::ArraySize( argv_binary ), argv_binary ) ), std::invalid_argument );
+}
+
+BOOST_AUTO_TEST_CASE( test_archives ) {
+  char const * argv[] = { "lfl", "--archives", "-r", "--count", "3" };
+  Options const options = ParseOptions( CmdLine( jig::ArraySize( argv ), argv ) );
+  BOOST_CHECK( options.archives );
+  BOOST_CHECK( options.count == 3 );
+
+  char const * argv_default[] = { "lfl" };
+  BOOST_CHECK( !ParseOptions( CmdLine( jig::ArraySize( argv_default ), argv_default ) ).archives );
+}
+
+BOOST_AUTO_TEST_CASE( test_cache ) {
+  char const * argv[] = { "lfl", "--cache", "5s", "-r" };
+  BOOST_CHECK( ParseOptions( CmdLine( jig::ArraySize( argv ), argv ) ).cache_ttl == std::chrono::seconds( 5 ) );
+
+  char const * argv_default[] = { "lfl" };
+  BOOST_CHECK( ParseOptions( CmdLine( jig::ArraySize( argv_default ), argv_default ) ).cache_ttl.count() == 0 );
+
+  char const * argv_zero[] = { "lfl", "--cache", "0" };
+  BOOST_CHECK_THROW( ParseOptions( CmdLine( jig::ArraySize( argv_zero ), argv_zero ) ), std::invalid_argument );
+  // 標準入力の一覧は、引数からは区別できない
+  char const * argv_stdin[] = { "lfl", "--cache", "5s", "--from-stdin" };
+  BOOST_CHECK_THROW( ParseOptions( CmdLine( jig::ArraySize( argv_stdin ), argv_stdin ) ), std::invalid_argument );
+}
+
+BOOST_AUTO_TEST_CASE( test_throttle ) {
+  char const * argv[] = { "lfl", "--max-iops", "500", "--max-dirs-per-sec", "20", "-r" };
+  Options const options = ParseOptions( CmdLine( jig::ArraySize( argv ), argv ) );
+  BOOST_CHECK( options.max_iops == 500 );
+  BOOST_CHECK( options.max_directories_per_second == 20 );
+
+  char const * argv_default[] = { "lfl" };
+  Options const defaults = ParseOptions( CmdLine( jig::ArraySize( argv_default ), argv_default ) );
+  BOOST_CHECK( defaults.max_iops == 0 );
+  BOOST_CHECK( defaults.max_directories_per_second == 0 );
+
+  char const * argv_zero[] = { "lfl", "--max-iops", "0" };
+  BOOST_CHECK_THROW( ParseOptions( CmdLine( jig::ArraySize( argv_zero ), argv_zero ) ), std::invalid_argument );
+}
+
+BOOST_AUTO_TEST_CASE( test_checkpoint ) {
+  char const * argv[] = { "lfl", "--checkpoint", "scan.ckpt", "--resume", "old.ckpt", "-r" };
+  Options const options = ParseOptions( CmdLine( jig::ArraySize( argv ), argv ) );
+  BOOST_CHECK( options.checkpoint_file == "scan.ckpt" );
+  BOOST_CHECK( options.resume_file == "old.ckpt" );
+
+  // 保存しない状態を持つ出力や走査とは組み合わせられない
+  char const * argv_sort[] = { "lfl", "--checkpoint", "scan.ckpt", "--sort" };
+  BOOST_CHECK_THROW( ParseOptions( CmdLine( jig::ArraySize( argv_sort ), argv_sort ) ), std::invalid_argument );
+  char const * argv_follow[] = { "lfl", "--resume", "old.ckpt", "-L" };
+  BOOST_CHECK_THROW( ParseOptions( CmdLine( jig::ArraySize( argv_follow ), argv_follow ) ), std::invalid_argument );
+}
+
+BOOST_AUTO_TEST_CASE( test_dirbuf ) {
+  char const * argv[] = { "lfl", "--dirbuf", "4M" };
+  BOOST_CHECK( ParseOptions( CmdLine( jig::ArraySize( argv ), argv ) ).directory_buffer_size == ( std::size_t( 4 ) << 20 ) );
+
+  char const * argv_default[] = { "lfl" };
+  BOOST_CHECK( ParseOptions( CmdLine( jig::ArraySize( argv_default ), argv_default ) ).directory_buffer_size == DEFAULT_DIRECTORY_BUFFER_SIZE );
+
+  // 一つのエントリも入らないほど小さいもの、大きすぎるものはエラー
+  char const * argv_small[] = { "lfl", "--dirbuf", "512" };
+  BOOST_CHECK_THROW( ParseOptions( CmdLine( jig::ArraySize( argv_small ), argv_small ) ), std::invalid_argument );
+  char const * argv_large[] = { "lfl", "--dirbuf", "1G" };
+  BOOST_CHECK_THROW( ParseOptions( CmdLine( jig::ArraySize( argv_large ), argv_large ) ), std::invalid_argument );
+}
+
+BOOST_AUTO_TEST_CASE( test_help ) {
+  char const * argv_all[] = { "lfl", "--help" };
+  Options all = ParseOptions( CmdLine( jig::ArraySize( argv_all ), argv_all ) );
+  BOOST_CHECK( all.help );
+  BOOST_REQUIRE( all.help_topics.size() == 1 );
+  BOOST_CHECK( all.help_topics[0] == "all" );
+
+  char const * argv_topic[] = { "lfl", "--help", "count" };
+  Options topic = ParseOptions( CmdLine( jig::ArraySize( argv_topic ), argv_topic ) );
+  BOOST_REQUIRE( topic.help_topics.size() == 2 );
+  BOOST_CHECK( topic.help_topics[1] == "count" );
+
+  // オプションではない"help"はディレクトリ名として扱う。
+  char const * argv_dir[] = { "lfl", "help" };
+  Options dir = ParseOptions( CmdLine( jig::ArraySize( argv_dir ), argv_dir ) );
+  BOOST_CHECK( !dir.help );
+  BOOST_CHECK( dir.directories.size() == 1 );
+}
+
+BOOST_AUTO_TEST_CASE( test_invalid_arguments ) {
+  char const * argv_unknown[] = { "lfl", "--unknown" };
+  BOOST_CHECK_THROW( CmdLine( jig::ArraySize( argv_unknown ), argv_unknown ), std::invalid_argument );
+
+  // "--help"の前方一致で受け付けてしまわないこと
+  char const * argv_prefix[] = { "lfl", "--helpme" };
+  BOOST_CHECK_THROW( CmdLine( jig::ArraySize( argv_prefix ), argv_prefix ), std::invalid_argument );
+
+  char const * argv_missing[] = { "lfl", "--count" };
+  BOOST_CHECK_THROW( CmdLine( jig::ArraySize( argv_missing ), argv_missing ), std::invalid_argument );
+
+  // 値の代わりにオプションが続いたら、それを値にはしない。
+  char const * argv_option_value[] = { "lfl", "--count", "-r" };
+  BOOST_CHECK_THROW( CmdLine( jig::ArraySize( argv_option_value ), argv_option_value ), std::invalid_argument );
+  char const * argv_end_value[] = { "lfl", "--count", "--", "dir" };
+  BOOST_CHECK_THROW( CmdLine( jig::ArraySize( argv_end_value ), argv_end_value ), std::invalid_argument );
+  char const * argv_dash_value[] = { "lfl", "--name", "-foo" };
+  BOOST_CHECK_THROW( CmdLine( jig::ArraySize( argv_dash_value ), argv_dash_value ), std::invalid_argument );
+
+  char const * argv_flag_value[] = { "lfl", "--version=1" };
+  BOOST_CHECK_THROW( CmdLine( jig::ArraySize( argv_flag_value ), argv_flag_value ), std::invalid_argument );
+
+  char const * argv_count[] = { "lfl", "--count", "x3" };
+  BOOST_CHECK_THROW( ParseOptions( CmdLine( jig::ArraySize( argv_count ), argv_count ) ), std::invalid_argument );
+
+  char const * argv_zero[] = { "lfl", "--count", "0" };
+  BOOST_CHECK_THROW( ParseOptions( CmdLine( jig::ArraySize( argv_zero ), argv_zero ) ), std::invalid_argument );
+
+  // 大きすぎる件数は、確保に失敗して落ちる前に拒む。
+  char const * argv_huge[] = { "lfl", "--count", "18446744073709551615" };
+  BOOST_CHECK_THROW( ParseOptions( CmdLine( jig::ArraySize( argv_huge ), argv_huge ) ), std::invalid_argument );
+  char const * argv_max[] = { "lfl", "--count", "16777216" };
+  BOOST_CHECK( ParseOptions( CmdLine( jig::ArraySize( argv_max ), argv_max ) ).count == MAX_COUNT );
+
+  char const * argv_time[] = { "lfl", "--time", "modify" };
+  BOOST_CHECK_THROW( ParseOptions( CmdLine( jig::ArraySize( argv_time ), argv_time ) ), std::invalid_argument );
+}
+
+BOOST_AUTO_TEST_CASE( test_value_parsers ) {
+  using namespace lfl::VALUE;
+
+  BOOST_CHECK( ParseInteger( "count", "42" ) == 42 );
+  BOOST_CHECK_THROW( ParseInteger( "count", "" ), std::invalid_argument );
+  BOOST_CHECK_THROW( ParseInteger( "count", "42x" ), std::invalid_argument );
+
+  BOOST_CHECK( ParseSize( "size", "512" ) == 512 );
+  BOOST_CHECK( ParseSize( "size", "64K" ) == 64 * 1024 );
+  BOOST_CHECK( ParseSize( "size", "1M" ) == 1024 * 1024 );
+  BOOST_CHECK_THROW( ParseSize( "size", "M" ), std::invalid_argument );
+
+  BOOST_CHECK( ParseDuration( "deadline", "50" ) == std::chrono::milliseconds( 50 ) );
+  BOOST_CHECK( ParseDuration( "deadline", "50ms" ) == std::chrono::milliseconds( 50 ) );
+  BOOST_CHECK( ParseDuration( "deadline", "2s" ) == std::chrono::milliseconds( 2000 ) );
+  BOOST_CHECK( ParseDuration( "deadline", "1m" ) == std::chrono::milliseconds( 60000 ) );
+  BOOST_CHECK_THROW( ParseDuration( "deadline", "2days" ), std::invalid_argument );
+
+  // 溢れる値は丸めずにエラーにする。
+  BOOST_CHECK( ParseSize( "size", "18446744073709551615" ) == std::numeric_limits<std::uint64_t>::max() );
+  BOOST_CHECK_THROW( ParseSize( "size", "18446744073709551616" ), std::invalid_argument );
+  BOOST_CHECK( ParseSize( "size", "16777215T" ) == ( std::uint64_t( 16777215 ) << 40 ) );
+  BOOST_CHECK_THROW( ParseSize( "size", "16777216T" ), std::invalid_argument );
+  BOOST_CHECK_THROW( ParseSize( "size", "99999999999999999999G" ), std::invalid_argument );
+
+  std::uint64_t const max_ms = static_cast<std::uint64_t>( MAX_DURATION.count() );
+  BOOST_CHECK( ParseDuration( "deadline", std::to_string( max_ms ) ) == MAX_DURATION );
+  BOOST_CHECK_THROW( ParseDuration( "deadline", std::to_string( max_ms + 1 ) ), std::invalid_argument );
+  std::uint64_t const max_hours = max_ms / ( 60 * 60 * 1000 );
+  BOOST_CHECK( ParseDuration( "deadline", std::to_string( max_hours ) + "h" ) == std::chrono::hours( max_hours ) );
+  BOOST_CHECK_THROW( ParseDuration( "deadline", std::to_string( max_hours + 1 ) + "h" ), std::invalid_argument );
+  BOOST_CHECK_THROW( ParseDuration( "deadline", "99999999999999999999" ), std::invalid_argument );
+
+  BOOST_CHECK( ( ParseEnum<TimeField, TIME_FIELD_NAMES>( "time", "creation" ) == TimeField::CREATION ) );
+  BOOST_CHECK_THROW( ( ParseEnum<TimeField, TIME_FIELD_NAMES>( "time", "writ" ) ), std::invalid_argument );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,52 @@
+#include "lfl/Dispatch.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/tools/interface.hpp>
+#include <boost/test/tools/old/interface.hpp>
+
+#include <cstddef>
+
+BOOST_AUTO_TEST_SUITE( test_dispatch )
+
+using namespace lfl;
+
+namespace {
+
+using TestShape = DISPATCH::Shape<3, 2, 4>;
+
+// 表の各要素に、自分の添字を各次元に分けたものを入れる。
+template<std::size_t FLAT>
+struct Coordinates {
+  static constexpr std::size_t value = TestShape::coordinate<0>( FLAT ) * 100 + TestShape::coordinate<1>( FLAT ) * 10 + TestShape::coordinate<2>( FLAT );
+};
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE( test_shape ) {
+  static_assert( TestShape::SIZE == 24 );
+  static_assert( TestShape::DIMENSION == 3 );
+  static_assert( TestShape::index( 0, 0, 0 ) == 0 );
+  static_assert( TestShape::index( 2, 1, 3 ) == 23 );
+
+  // 先頭の次元が最も大きく変わる。
+  BOOST_CHECK( TestShape::index( 0, 0, 1 ) == 1 );
+  BOOST_CHECK( TestShape::index( 0, 1, 0 ) == 4 );
+  BOOST_CHECK( TestShape::index( 1, 0, 0 ) == 8 );
+  // boolやenumもそのまま添字にできる。
+  BOOST_CHECK( TestShape::index( 1, true, 2 ) == 14 );
+
+  for ( std::size_t flat = 0; flat < TestShape::SIZE; ++flat ) {
+    BOOST_CHECK( TestShape::index( TestShape::coordinate<0>( flat ), TestShape::coordinate<1>( flat ), TestShape::coordinate<2>( flat ) ) == flat );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( test_make_table ) {
+  constexpr auto TABLE = DISPATCH::MakeTable<TestShape::SIZE, Coordinates>();
+  static_assert( TABLE.size() == TestShape::SIZE );
+
+  BOOST_CHECK( TABLE[TestShape::index( 0, 0, 0 )] == 0 );
+  BOOST_CHECK( TABLE[TestShape::index( 1, 0, 3 )] == 103 );
+  BOOST_CHECK( TABLE[TestShape::index( 2, 1, 2 )] == 212 );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,107 @@
+#include "lfl/Exclude.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/tools/interface.hpp>
+#include <boost/test/tools/old/interface.hpp>
+
+#include <initializer_list>
+#include <memory>
+#include <string_view>
+
+BOOST_AUTO_TEST_SUITE( test_exclude )
+
+using namespace lfl;
+
+namespace {
+
+ExcludeRules MakeRules( std::initializer_list<std::string_view> const lines ) {
+  ExcludeRules rules;
+  for ( auto const itr : lines ) { rules.add( itr ); }
+  return rules;
+}
+
+bool IsExcludedBy( ExcludeRules const & rules, std::string_view const directory, std::string_view const name, bool const is_directory = false ) {
+  return rules.match( directory, name, is_directory ) == ExcludeDecision::EXCLUDE;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE( test_names ) {
+  auto const rules = MakeRules( { "# comment", "", "node_modules", ".git/", "*.o  " } );
+
+  // 区切り文字を含まない規則は、どの深さの名前にも一致する
+  BOOST_CHECK( IsExcludedBy( rules, "", "node_modules", true ) );
+  BOOST_CHECK( IsExcludedBy( rules, "web\\app\\", "Node_Modules", true ) );
+  BOOST_CHECK( IsExcludedBy( rules, "src\\", "main.o" ) );
+  BOOST_CHECK( !IsExcludedBy( rules, "src\\", "main.obj" ) );
+
+  // 末尾の'/'はディレクトリだけ
+  BOOST_CHECK( IsExcludedBy( rules, "", ".git", true ) );
+  BOOST_CHECK( !IsExcludedBy( rules, "", ".git" ) );
+  BOOST_CHECK( !IsExcludedBy( rules, "", "comment" ) );
+}
+
+BOOST_AUTO_TEST_CASE( test_anchored ) {
+  auto const rules = MakeRules( { "/build", "src/gen/", "docs/**/*.tmp", "a/**" } );
+
+  BOOST_CHECK( IsExcludedBy( rules, "", "build", true ) );
+  BOOST_CHECK( !IsExcludedBy( rules, "sub\\", "build", true ) );
+
+  BOOST_CHECK( IsExcludedBy( rules, "src\\", "gen", true ) );
+  BOOST_CHECK( IsExcludedBy( rules, "SRC\\", "gen", true ) );
+  BOOST_CHECK( !IsExcludedBy( rules, "lib\\src\\", "gen", true ) );
+
+  // "**"は0個以上のディレクトリ
+  BOOST_CHECK( IsExcludedBy( rules, "docs\\", "a.tmp" ) );
+  BOOST_CHECK( IsExcludedBy( rules, "docs\\x\\y\\", "a.tmp" ) );
+  BOOST_CHECK( !IsExcludedBy( rules, "docs\\x\\", "a.txt" ) );
+
+  // 中身だけを除外する(中に入らないので、その下もすべて除外される)
+  BOOST_CHECK( IsExcludedBy( rules, "a\\", "anything", true ) );
+  BOOST_CHECK( !IsExcludedBy( rules, "", "a", true ) );
+}
+
+BOOST_AUTO_TEST_CASE( test_path_glob ) {
+  BOOST_CHECK( EXCLUDE::MatchPath( "src\\", "s*\\" ) );
+  // '*'と'?'は区切り文字をまたがない
+  BOOST_CHECK( !EXCLUDE::MatchPath( "src\\lib\\", "s*\\" ) );
+  BOOST_CHECK( !EXCLUDE::MatchPath( "a\\b\\", "a?b\\" ) );
+  BOOST_CHECK( EXCLUDE::MatchPath( "a\\b\\c\\", "**\\c\\" ) );
+  // '/'で区切られたパス(--from-stdin)
+  BOOST_CHECK( EXCLUDE::MatchPath( "src/gen/", "src\\gen\\" ) );
+}
+
+BOOST_AUTO_TEST_CASE( test_negation ) {
+  auto const rules = MakeRules( { "*.log", "!keep.log", "\\!bang" } );
+
+  BOOST_CHECK( IsExcludedBy( rules, "", "debug.log" ) );
+  BOOST_CHECK( rules.match( "", "keep.log", false ) == ExcludeDecision::INCLUDE );
+  BOOST_CHECK( IsExcludedBy( rules, "", "!bang" ) );
+  BOOST_CHECK( rules.match( "", "other", false ) == ExcludeDecision::NONE );
+
+  // 後の規則ほど優先する
+  auto const reordered = MakeRules( { "!keep.log", "*.log" } );
+  BOOST_CHECK( IsExcludedBy( reordered, "", "keep.log" ) );
+}
+
+BOOST_AUTO_TEST_CASE( test_scopes ) {
+  auto const global = MakeRules( { "dist" } );
+
+  // root\.gitignore と root\web\.gitignore
+  auto const outer = std::make_shared<IgnoreScope const>( IgnoreScope{ nullptr, "", MakeRules( { "*.tmp", "*.bak", "/out" } ) } );
+  auto const inner = std::make_shared<IgnoreScope const>( IgnoreScope{ outer, "web\\", MakeRules( { "!*.tmp", "/out", "dist" } ) } );
+
+  BOOST_CHECK( IsExcluded( global, outer.get(), "", "a.tmp", false ) );
+  BOOST_CHECK( IsExcluded( global, outer.get(), "", "out", true ) );
+  // 内側のファイルの規則を優先し、基準はそのファイルのディレクトリ
+  BOOST_CHECK( !IsExcluded( global, inner.get(), "web\\", "a.tmp", false ) );
+  BOOST_CHECK( IsExcluded( global, inner.get(), "web\\", "out", true ) );
+  BOOST_CHECK( !IsExcluded( global, inner.get(), "web\\src\\", "out", true ) );
+  // 内側のファイルの規則はその下のディレクトリにも及び、一致しなければ外側に従う
+  BOOST_CHECK( !IsExcluded( global, inner.get(), "web\\src\\", "b.tmp", false ) );
+  BOOST_CHECK( IsExcluded( global, inner.get(), "web\\src\\", "a.bak", false ) );
+  // コマンドラインの規則は常に除外する
+  BOOST_CHECK( IsExcluded( global, nullptr, "", "dist", true ) );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
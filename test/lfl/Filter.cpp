@@ -0,0 +1,112 @@
+#include "lfl/Filter.hpp"
+#include "lfl/Value.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/tools/interface.hpp>
+#include <boost/test/tools/old/interface.hpp>
+
+#include <stdexcept>
+
+BOOST_AUTO_TEST_SUITE( test_filter )
+
+using namespace lfl;
+
+BOOST_AUTO_TEST_CASE( test_pattern_kind ) {
+  using FILTER::PatternKind;
+
+  BOOST_CHECK( FILTER::CompilePattern( "Makefile" ).kind == PatternKind::EXACT );
+  BOOST_CHECK( FILTER::CompilePattern( "build*" ).kind == PatternKind::PREFIX );
+  BOOST_CHECK( FILTER::CompilePattern( "*.LOG" ).kind == PatternKind::SUFFIX );
+  BOOST_CHECK( FILTER::CompilePattern( "*.LOG" ).literal == ".log" );
+  BOOST_CHECK( FILTER::CompilePattern( "*cache*" ).kind == PatternKind::CONTAINS );
+  BOOST_CHECK( FILTER::CompilePattern( "a?c*.txt" ).kind == PatternKind::GLOB );
+}
+
+BOOST_AUTO_TEST_CASE( test_match_name ) {
+  FilterSpec spec;
+  spec.names = { "*.log", "a?c*.txt", "README" };
+  Filter const filter( spec );
+
+  // 安いパターンから調べる
+  BOOST_REQUIRE( filter.patterns().size() == 3 );
+  BOOST_CHECK( filter.patterns().front().kind == FILTER::PatternKind::EXACT );
+  BOOST_CHECK( filter.patterns().back().kind == FILTER::PatternKind::GLOB );
+
+  BOOST_CHECK( filter.matchName( "server.log" ) );
+  BOOST_CHECK( filter.matchName( "SERVER.Log" ) );
+  BOOST_CHECK( filter.matchName( "abc.txt" ) );
+  BOOST_CHECK( filter.matchName( "aXcdef.txt" ) );
+  BOOST_CHECK( filter.matchName( "readme" ) );
+  BOOST_CHECK( !filter.matchName( "ac.txt" ) );
+  BOOST_CHECK( !filter.matchName( "server.log.1" ) );
+  BOOST_CHECK( !filter.matchName( "README.md" ) );
+
+  // "*"があれば名前では絞り込まない
+  spec.names.emplace_back( "*" );
+  BOOST_CHECK( Filter( spec ).matchName( "anything" ) );
+  BOOST_CHECK( Filter().empty() );
+}
+
+BOOST_AUTO_TEST_CASE( test_glob ) {
+  BOOST_CHECK( FILTER::MatchGlob( "", "*" ) );
+  BOOST_CHECK( FILTER::MatchGlob( "abcabd", "*ab?" ) );
+  BOOST_CHECK( FILTER::MatchGlob( "a.b.c", "*.*.*" ) );
+  BOOST_CHECK( !FILTER::MatchGlob( "a.b", "*.*.*" ) );
+  BOOST_CHECK( !FILTER::MatchGlob( "abc", "??" ) );
+}
+
+BOOST_AUTO_TEST_CASE( test_match_information ) {
+  FilterSpec spec;
+  spec.min_size = 10;
+  spec.max_size = 100;
+  spec.type_mask = 1U << static_cast<unsigned>( EntryType::FILE );
+  spec.min_time = Time( 1000 );
+  spec.max_time = Time( 2000 );
+  Filter const filter( spec );
+
+  // 指定された条件だけが、安い順に命令になる
+  BOOST_REQUIRE( filter.program().size() == 5 );
+  BOOST_CHECK( filter.program().front().opcode == FILTER::Opcode::TYPE );
+  BOOST_CHECK( Filter( FilterSpec() ).program().empty() );
+
+  FoundEntry found{ "a", Time( 0 ), 50, EntryType::FILE };
+  BOOST_CHECK( filter.matchInformation( found, Time( 1000 ) ) );
+  // 範囲の終わりは含まない
+  BOOST_CHECK( !filter.matchInformation( found, Time( 2000 ) ) );
+  BOOST_CHECK( !filter.matchInformation( found, Time( 999 ) ) );
+
+  found.size = 101;
+  BOOST_CHECK( !filter.matchInformation( found, Time( 1500 ) ) );
+  found.size = 10;
+  found.type = EntryType::DIRECTORY;
+  BOOST_CHECK( !filter.matchInformation( found, Time( 1500 ) ) );
+}
+
+BOOST_AUTO_TEST_CASE( test_time_range ) {
+  STATIC_CONSTEXPR std::int64_t NS = 1000000000;
+
+  static_assert( VALUE::DaysFromCivil( 1970, 1, 1 ) == 0 );
+  static_assert( VALUE::DaysFromCivil( 2000, 3, 1 ) == 11017 );
+
+  BOOST_CHECK( VALUE::ParseTimePoint( "mtime-range", "1970-01-02" ) == Time( 86400 * NS ) );
+  BOOST_CHECK( VALUE::ParseTimePoint( "mtime-range", "2024-02-29T12:30:15" ) == Time( ( 1709209815 ) * NS ) );
+  BOOST_CHECK( VALUE::ParseTimePoint( "mtime-range", "1969-12-31 23:59" ) == Time( -60 * NS ) );
+
+  auto const [ begin, end ] = VALUE::ParseTimeRange( "mtime-range", "2024-01-01.." );
+  BOOST_CHECK( begin == Time( 1704067200 * NS ) );
+  BOOST_CHECK( end == Time::Max() );
+
+  BOOST_CHECK_THROW( VALUE::ParseTimeRange( "mtime-range", "2024-01-01" ), std::invalid_argument );
+  BOOST_CHECK_THROW( VALUE::ParseTimeRange( "mtime-range", "2024-02-01..2024-01-01" ), std::invalid_argument );
+  BOOST_CHECK_THROW( VALUE::ParseTimePoint( "mtime-range", "2024-1-01" ), std::invalid_argument );
+  BOOST_CHECK_THROW( VALUE::ParseTimePoint( "mtime-range", "2024-01-01T25:00" ), std::invalid_argument );
+
+  // 無い日付は翌月に繰り越さない
+  static_assert( VALUE::DaysInMonth( 2024, 2 ) == 29 && VALUE::DaysInMonth( 2023, 2 ) == 28 && VALUE::DaysInMonth( 1900, 2 ) == 28 && VALUE::DaysInMonth( 2000, 2 ) == 29 );
+  BOOST_CHECK_THROW( VALUE::ParseTimePoint( "mtime-range", "2024-02-31" ), std::invalid_argument );
+  BOOST_CHECK_THROW( VALUE::ParseTimePoint( "mtime-range", "2023-02-29" ), std::invalid_argument );
+  BOOST_CHECK_THROW( VALUE::ParseTimePoint( "mtime-range", "2024-04-31T00:00" ), std::invalid_argument );
+  BOOST_CHECK( VALUE::ParseTimePoint( "mtime-range", "2024-12-31" ) == Time( 1735603200 * NS ) );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
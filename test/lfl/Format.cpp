@@ -0,0 +1,195 @@
+#include "lfl/Format.hpp"
+#include "lfl/Output.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/tools/interface.hpp>
+#include <boost/test/tools/old/interface.hpp>
+
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE( test_format )
+
+using namespace lfl;
+
+namespace {
+
+Entry MakeEntry( std::string const & directory, std::string const & name ) {
+  Entry entry;
+  entry.path = directory + name;
+  entry.name_offset = directory.size();
+  entry.type = EntryType::FILE;
+  entry.size = 42;
+  entry.time = Time( 1700000000123456789 );
+  return entry;
+}
+
+template<typename Writer>
+std::string const & Flushed( Writer & writer ) { writer.flush(); return writer.device().str(); }
+
+// ANSIコードページをLatin-1とみなしてUTF-8にする書き出し先(StdDeviceのtoUtf8の代わり)
+class Latin1Device : public OUTPUT::StringDevice {
+public:
+  static std::string_view toUtf8( std::string_view const latin1, std::string & buffer ) {
+    buffer.clear();
+    for ( char const itr : latin1 ) {
+      unsigned char const one_char = static_cast<unsigned char>( itr );
+      if ( one_char < 0x80 ) {
+        buffer.push_back( itr );
+      } else {
+        buffer.push_back( static_cast<char>( 0xc0 | ( one_char >> 6 ) ) );
+        buffer.push_back( static_cast<char>( 0x80 | ( one_char & 0x3f ) ) );
+      }
+    }
+    return buffer;
+  }
+};
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE( test_time_from_filetime ) {
+  // 1970-01-01T00:00:00Z
+  static_assert( Time::FromFileTime( Time::FILETIME_UNIX_EPOCH ).ns() == 0 );
+  static_assert( Time::FromFileTime( Time::FILETIME_UNIX_EPOCH + 1 ).ns() == 100 );
+  static_assert( Time::FromFileTime( Time::FILETIME_UNIX_EPOCH - 1 ).ns() == -100 );
+
+  // 表せない範囲は飽和しても大小関係は保たれる
+  BOOST_CHECK( Time::FromFileTime( 0 ) < Time::FromFileTime( Time::FILETIME_UNIX_EPOCH ) );
+  BOOST_CHECK( Time::Min() < Time::FromFileTime( 0 ) );
+}
+
+BOOST_AUTO_TEST_CASE( test_find_json_escape ) {
+  using FORMAT::FindJsonEscape;
+
+  std::string const clean( 100, 'a' );
+  BOOST_CHECK( FindJsonEscape( clean.data(), clean.size() ) == clean.size() );
+
+  // 16バイト単位で調べる部分と、端数を調べる部分の両方で見つけられること
+  for ( std::size_t position : { 0, 5, 15, 16, 31, 40, 99 } ) {
+    for ( char special : { '"', '\\', '\n', '\x01', '\x1f' } ) {
+      std::string str = clean;
+      str[position] = special;
+      BOOST_CHECK( FindJsonEscape( str.data(), str.size() ) == position );
+    }
+  }
+
+  // 0x80以上のバイト(UTF-8)はエスケープしない
+  std::string const utf8 = std::string( 20, 'a' ) + "\xe3\x81\x82" + std::string( 20, 'b' );
+  BOOST_CHECK( FindJsonEscape( utf8.data(), utf8.size() ) == utf8.size() );
+}
+
+BOOST_AUTO_TEST_CASE( test_json ) {
+  OUTPUT::BasicWriter<OUTPUT::StringDevice, 256> writer;
+
+  WriteEntry( writer, MakeEntry( "dir\\", "a\"b\nc\x01.txt" ), Format::JSON );
+  BOOST_CHECK( Flushed( writer ) == "{\"path\":\"dir\\\\a\\\"b\\nc\\u0001.txt\",\"time\":1700000000123456789,\"size\":42,\"type\":\"file\"}\n" );
+}
+
+BOOST_AUTO_TEST_CASE( test_json_utf8 ) {
+  // ASCIIでない文字を含むパスは、書き出し先の変換でUTF-8にしてからエスケープする。
+  OUTPUT::BasicWriter<Latin1Device, 256> writer;
+  WriteEntry( writer, MakeEntry( "caf\xe9\\", "\"\xe0.txt" ), Format::JSON );
+  BOOST_CHECK( Flushed( writer ) == "{\"path\":\"caf\xc3\xa9\\\\\\\"\xc3\xa0.txt\",\"time\":1700000000123456789,\"size\":42,\"type\":\"file\"}\n" );
+
+  // TEXTは変換せずにそのまま書く。
+  OUTPUT::BasicWriter<Latin1Device, 256> text;
+  WriteEntry( text, MakeEntry( "dir\\", "caf\xe9.txt" ), Format::TEXT );
+  BOOST_CHECK( Flushed( text ) == "caf\xe9.txt\n" );
+}
+
+BOOST_AUTO_TEST_CASE( test_text_and_nul ) {
+  OUTPUT::BasicWriter<OUTPUT::StringDevice, 256> text;
+  WriteEntry( text, MakeEntry( "dir\\", "name.txt" ), Format::TEXT );
+  BOOST_CHECK( Flushed( text ) == "name.txt\n" );
+
+  OUTPUT::BasicWriter<OUTPUT::StringDevice, 256> nul;
+  WriteEntry( nul, MakeEntry( "dir\\", "new\nline" ), Format::NUL );
+  BOOST_CHECK( Flushed( nul ) == std::string( "dir\\new\nline\0", 13 ) );
+}
+
+BOOST_AUTO_TEST_CASE( test_group_entry ) {
+  OUTPUT::BasicWriter<OUTPUT::StringDevice, 256> text;
+  WriteGroupEntry( text, "txt", MakeEntry( "dir\\", "name.txt" ), Format::TEXT );
+  BOOST_CHECK( Flushed( text ) == "txt\tname.txt\n" );
+
+  OUTPUT::BasicWriter<OUTPUT::StringDevice, 256> nul;
+  WriteGroupEntry( nul, "", MakeEntry( "dir\\", "name" ), Format::NUL );
+  BOOST_CHECK( Flushed( nul ) == std::string( "\0dir\\name\0", 10 ) );
+
+  OUTPUT::BasicWriter<OUTPUT::StringDevice, 256> json;
+  WriteGroupEntry( json, "a\"b", MakeEntry( "dir\\", "x" ), Format::JSON );
+  BOOST_CHECK( Flushed( json ) == "{\"group\":\"a\\\"b\",\"path\":\"dir\\\\x\",\"time\":1700000000123456789,\"size\":42,\"type\":\"file\"}\n" );
+}
+
+BOOST_AUTO_TEST_CASE( test_tree_entry ) {
+  static_assert( FORMAT::CivilFromDays( 0 ).year == 1970 );
+  static_assert( FORMAT::CivilFromDays( 19844 ).month == 5 && FORMAT::CivilFromDays( 19844 ).day == 1 );
+  static_assert( FORMAT::CivilFromDays( -1 ).year == 1969 && FORMAT::CivilFromDays( -1 ).day == 31 );
+
+  char text[FORMAT::ISO_TIME_LENGTH];
+  FORMAT::FormatIsoTime( Time( 1700000000123456789 ), text );
+  BOOST_CHECK( std::string_view( text, sizeof( text ) ) == "2023-11-14T22:13:20Z" );
+  // エポックより前は、秒未満を切り捨てると一つ前の秒になる。
+  FORMAT::FormatIsoTime( Time( -1 ), text );
+  BOOST_CHECK( std::string_view( text, sizeof( text ) ) == "1969-12-31T23:59:59Z" );
+
+  Entry const entry = MakeEntry( "dir\\", "sub\\a.txt" );
+  OUTPUT::BasicWriter<OUTPUT::StringDevice, 256> text_writer;
+  WriteTreeEntry( text_writer, "dir\\sub\\", &entry, Format::TEXT );
+  WriteTreeEntry( text_writer, "dir\\empty\\", nullptr, Format::TEXT );
+  BOOST_CHECK( Flushed( text_writer ) == "dir\\sub\\\t2023-11-14T22:13:20Z\tsub\\a.txt\ndir\\empty\\\t-\t\n" );
+
+  OUTPUT::BasicWriter<OUTPUT::StringDevice, 256> json;
+  WriteTreeEntry( json, "d\\", &entry, Format::JSON );
+  WriteTreeEntry( json, "e\\", nullptr, Format::JSON );
+  BOOST_CHECK( Flushed( json ) == "{\"directory\":\"d\\\\\",\"path\":\"dir\\\\sub\\\\a.txt\",\"time\":1700000000123456789,\"size\":42,\"type\":\"file\"}\n{\"directory\":\"e\\\\\"}\n" );
+}
+
+BOOST_AUTO_TEST_CASE( test_binary ) {
+  OUTPUT::BasicWriter<OUTPUT::StringDevice, 256> writer;
+  Entry const entry = MakeEntry( "dir\\", "name.txt" );
+
+  BeginEntries( writer, Format::BINARY );
+  WriteEntry( writer, entry, Format::BINARY );
+  std::string const & bytes = Flushed( writer );
+
+  BOOST_REQUIRE( bytes.size() == sizeof( FORMAT::BinaryHeader ) + sizeof( FORMAT::BinaryRecord ) + entry.path.size() );
+  BOOST_CHECK( std::memcmp( bytes.data(), FORMAT::BINARY_MAGIC, 4 ) == 0 );
+
+  FORMAT::BinaryRecord record;
+  std::memcpy( &record, bytes.data() + sizeof( FORMAT::BinaryHeader ), sizeof( record ) );
+  BOOST_CHECK( record.time == entry.time.ns() );
+  BOOST_CHECK( record.size == 42 );
+  BOOST_CHECK( record.path_length == entry.path.size() );
+  BOOST_CHECK( record.type == static_cast<std::uint8_t>( EntryType::FILE ) );
+  BOOST_CHECK( bytes.substr( sizeof( FORMAT::BinaryHeader ) + sizeof( record ) ) == entry.path );
+}
+
+BOOST_AUTO_TEST_CASE( test_binary_round_trip ) {
+  OUTPUT::BasicWriter<OUTPUT::StringDevice, 256> writer;
+  BeginEntries( writer, Format::BINARY );
+  WriteEntry( writer, MakeEntry( "dir\\", "a.txt" ), Format::BINARY );
+  WriteEntry( writer, MakeEntry( "dir\\sub\\", "b.txt" ), Format::BINARY );
+  std::string const bytes = Flushed( writer );
+
+  std::vector<std::string> paths;
+  Entry entry;
+  BOOST_CHECK( FORMAT::ReadBinaryEntries( bytes, entry, [ & ]( Entry const & read ) {
+    paths.emplace_back( read.path );
+    BOOST_CHECK( read.time == Time( 1700000000123456789 ) );
+    BOOST_CHECK( read.size == 42 );
+    BOOST_CHECK( read.type == EntryType::FILE );
+  } ) );
+  BOOST_CHECK( ( paths == std::vector<std::string>{ "dir\\a.txt", "dir\\sub\\b.txt" } ) );
+
+  // 途中で切れているもの、ヘッダが違うものは読めない
+  auto const ignore = []( Entry const & ){};
+  BOOST_CHECK( !FORMAT::ReadBinaryEntries( std::string_view( bytes ).substr( 0, bytes.size() - 1 ), entry, ignore ) );
+  BOOST_CHECK( !FORMAT::ReadBinaryEntries( "not binary", entry, ignore ) );
+  // ヘッダだけなら空の結果
+  BOOST_CHECK( FORMAT::ReadBinaryEntries( std::string_view( bytes ).substr( 0, sizeof( FORMAT::BinaryHeader ) ), entry, ignore ) );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
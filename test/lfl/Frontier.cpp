@@ -0,0 +1,147 @@
+#include "lfl/Frontier.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/tools/interface.hpp>
+#include <boost/test/tools/old/interface.hpp>
+
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE( test_frontier )
+
+using namespace lfl;
+
+namespace {
+
+std::vector<DirectoryJob> Siblings( std::string const & parent, std::vector<std::string> const & names, Time::rep const ns = 0 ) {
+  std::vector<DirectoryJob> jobs;
+  for ( std::size_t index = 0; index < names.size(); ++index ) {
+    jobs.emplace_back( DirectoryJob{ parent + names[index] + DELIMITER, 5, 2, 7, Time( ns + static_cast<Time::rep>( index ) ) } );
+  }
+  return jobs;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE( test_expanded ) {
+  Frontier frontier( TraversalOrder::DFS, DEFAULT_FRONTIER_MEMORY );
+
+  auto jobs = Siblings( "root\\", { "a", "b" } );
+  frontier.push( jobs );
+  BOOST_CHECK( jobs.empty() );
+  BOOST_CHECK( frontier.size() == 2 );
+  BOOST_CHECK( frontier.spilledSize() == 0 );
+
+  // 後に積んだものから取り出す
+  DirectoryJob job;
+  BOOST_REQUIRE( frontier.pop( job ) );
+  BOOST_CHECK( job.path == "root\\b\\" );
+  BOOST_REQUIRE( frontier.pop( job ) );
+  BOOST_CHECK( job.path == "root\\a\\" );
+  BOOST_CHECK( !frontier.pop( job ) );
+  BOOST_CHECK( frontier.empty() );
+  BOOST_CHECK( frontier.memoryUsage() == 0 );
+}
+
+BOOST_AUTO_TEST_CASE( test_spill ) {
+  // 上限が0なら、起点以外はすべて詰めて保持する
+  Frontier frontier( TraversalOrder::DFS, 0 );
+
+  auto jobs = Siblings( "root\\sub\\", { "long-directory-name-0", "x", "long-directory-name-2" } );
+  auto const scope = std::make_shared<IgnoreScope const>();
+  for ( auto & itr : jobs ) {
+    itr.ignore = scope;
+    itr.root = 3;
+  }
+  frontier.push( jobs );
+  BOOST_CHECK( frontier.size() == 3 );
+  BOOST_CHECK( frontier.spilledSize() == 3 );
+  BOOST_CHECK( frontier.memoryUsage() != 0 );
+
+  std::set<std::string> paths;
+  DirectoryJob job;
+  while ( frontier.pop( job ) ) {
+    paths.emplace( job.path );
+    // 共通の情報は元のまま
+    BOOST_CHECK( job.root_length == 5 );
+    BOOST_CHECK( job.depth == 2 );
+    BOOST_CHECK( job.volume == 7 );
+    BOOST_CHECK( job.ignore == scope );
+    BOOST_CHECK( job.root == 3 );
+  }
+
+  BOOST_CHECK( ( paths == std::set<std::string>{ "root\\sub\\long-directory-name-0\\", "root\\sub\\x\\", "root\\sub\\long-directory-name-2\\" } ) );
+  BOOST_CHECK( frontier.empty() );
+  BOOST_CHECK( frontier.memoryUsage() == 0 );
+}
+
+BOOST_AUTO_TEST_CASE( test_spill_is_compact ) {
+  std::vector<std::string> names;
+  for ( int index = 0; index < 1000; ++index ) { names.emplace_back( "directory-" + std::to_string( index ) ); }
+
+  Frontier expanded( TraversalOrder::DFS, DEFAULT_FRONTIER_MEMORY );
+  Frontier spilled( TraversalOrder::DFS, 0 );
+  auto jobs1 = Siblings( "C:\\some\\deep\\parent\\directory\\", names );
+  auto jobs2 = jobs1;
+  expanded.push( jobs1 );
+  spilled.push( jobs2 );
+
+  // 親のパスを一度だけ持つので、展開して持つより小さい
+  BOOST_CHECK( spilled.memoryUsage() * 4 < expanded.memoryUsage() );
+}
+
+BOOST_AUTO_TEST_CASE( test_for_each ) {
+  Frontier frontier( TraversalOrder::BEST, 0 );
+
+  DirectoryJob root{ "root\\", 5, 0, 7, Time( 100 ) };
+  frontier.push( std::move( root ) );
+  auto jobs = Siblings( "root\\sub\\", { "a", "b", "c" }, 10 );
+  frontier.push( jobs );
+
+  // 一つ取り出した残りも、取り出さずにすべて渡す
+  DirectoryJob job;
+  BOOST_REQUIRE( frontier.pop( job ) );
+  BOOST_REQUIRE( frontier.pop( job ) );
+  BOOST_CHECK( job.path == "root\\sub\\a\\" );
+
+  std::vector<std::string> paths;
+  std::vector<Time::rep> priorities;
+  frontier.forEach( [ & ]( DirectoryJob const & itr ) {
+    paths.emplace_back( itr.path );
+    priorities.emplace_back( itr.priority.ns() );
+    BOOST_CHECK( itr.depth == 2 );
+  } );
+
+  BOOST_CHECK( ( paths == std::vector<std::string>{ "root\\sub\\b\\", "root\\sub\\c\\" } ) );
+  BOOST_CHECK( ( priorities == std::vector<Time::rep>{ 11, 12 } ) );
+  BOOST_CHECK( frontier.size() == 2 );
+}
+
+BOOST_AUTO_TEST_CASE( test_best_first ) {
+  Frontier frontier( TraversalOrder::BEST, DEFAULT_FRONTIER_MEMORY );
+
+  std::vector<DirectoryJob> jobs;
+  jobs.emplace_back( DirectoryJob{ "r\\old\\", 2, 1, 0, Time( 10 ) } );
+  jobs.emplace_back( DirectoryJob{ "r\\new\\", 2, 1, 0, Time( 30 ) } );
+  jobs.emplace_back( DirectoryJob{ "r\\mid\\", 2, 1, 0, Time( 20 ) } );
+  frontier.push( jobs );
+
+  DirectoryJob job;
+  BOOST_REQUIRE( frontier.pop( job ) );
+  BOOST_CHECK( job.path == "r\\new\\" );
+  BOOST_REQUIRE( frontier.pop( job ) );
+  BOOST_CHECK( job.path == "r\\mid\\" );
+  BOOST_REQUIRE( frontier.pop( job ) );
+  BOOST_CHECK( job.path == "r\\old\\" );
+
+  // 退避しても更新時刻は保たれる
+  Frontier spilled( TraversalOrder::BEST, 0 );
+  auto group = Siblings( "r\\", { "a" }, 42 );
+  spilled.push( group );
+  BOOST_REQUIRE( spilled.pop( job ) );
+  BOOST_CHECK( job.priority == Time( 42 ) );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
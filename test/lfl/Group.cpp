@@ -0,0 +1,100 @@
+#include "lfl/Group.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/tools/interface.hpp>
+#include <boost/test/tools/old/interface.hpp>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE( test_group )
+
+using namespace lfl;
+
+namespace {
+
+FoundEntry Found( std::string_view const name, Time::rep const ns ) { return FoundEntry{ name, Time( ns ), 1, EntryType::FILE }; }
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE( test_keys ) {
+  using GROUP::ExtensionKey;
+  BOOST_CHECK( ExtensionKey( "a.txt" ) == "txt" );
+  BOOST_CHECK( ExtensionKey( "a.tar.gz" ) == "gz" );
+  BOOST_CHECK( ExtensionKey( "Makefile" ).empty() );
+  // 先頭の'.'は拡張子の区切りではない
+  BOOST_CHECK( ExtensionKey( ".bashrc" ).empty() );
+  BOOST_CHECK( ExtensionKey( "a." ).empty() );
+
+  std::string const root( "root\\" );
+  std::string const deep( "root\\src\\lib\\" );
+  BOOST_CHECK( GROUP::TopDirectoryKey( DirectoryContext{ root, 5 }, "a.txt" ) == "." );
+  BOOST_CHECK( GROUP::TopDirectoryKey( DirectoryContext{ deep, 5 }, "a.txt" ) == "src" );
+
+  // --from-stdinのパス
+  std::string const empty;
+  BOOST_CHECK( GROUP::TopDirectoryKey( DirectoryContext{ empty, 0 }, "docs/a.md" ) == "docs" );
+  BOOST_CHECK( GROUP::TopDirectoryKey( DirectoryContext{ empty, 0 }, "a.md" ) == "." );
+}
+
+BOOST_AUTO_TEST_CASE( test_grouped_top_k ) {
+  std::string const root( "root\\" );
+  DirectoryContext const context{ root, 5 };
+
+  GroupedTopK first( GroupBy::EXT, 2 ), second( GroupBy::EXT, 2 );
+  first.offer( context, Found( "a.txt", 10 ) );
+  first.offer( context, Found( "b.TXT", 30 ) );
+  first.offer( context, Found( "c.txt", 20 ) );
+  first.offer( context, Found( "d.log", 5 ) );
+  second.offer( context, Found( "e.Log", 7 ) );
+  second.offer( context, Found( "f", 1 ) );
+  second.offer( context, Found( "g.txt", 25 ) );
+
+  first.merge( std::move( second ) );
+  BOOST_CHECK( second.size() == 0 );
+
+  // キーの順に並び、拡張子は小文字にそろえてある。
+  std::vector<GroupedTopK::Group> groups = first.take();
+  BOOST_REQUIRE( groups.size() == 3 );
+  BOOST_CHECK( groups[0].key == "" );
+  BOOST_CHECK( groups[1].key == "log" );
+  BOOST_CHECK( groups[2].key == "txt" );
+
+  std::vector<Entry> const logs = groups[1].top.take();
+  BOOST_REQUIRE( logs.size() == 2 );
+  BOOST_CHECK( logs[0].path == "root\\e.Log" );
+  BOOST_CHECK( logs[1].path == "root\\d.log" );
+
+  std::vector<Entry> const texts = groups[2].top.take();
+  BOOST_REQUIRE( texts.size() == 2 );
+  BOOST_CHECK( texts[0].path == "root\\b.TXT" );
+  BOOST_CHECK( texts[1].path == "root\\g.txt" );
+}
+
+BOOST_AUTO_TEST_CASE( test_many_groups ) {
+  // ハッシュ表を何度か広げても、すべてのグループが見つかること
+  std::string const root( "root\\" );
+  DirectoryContext const context{ root, 5 };
+
+  GroupedTopK groups( GroupBy::OWNER, 1 );
+  std::vector<std::string> owners;
+  for ( int index = 0; index < 1000; ++index ) { owners.emplace_back( "user" + std::to_string( index ) ); }
+
+  for ( int round = 0; round < 2; ++round ) {
+    for ( int index = 0; index < 1000; ++index ) {
+      FoundEntry found = Found( "a", round * 1000 + index );
+      found.owner = owners[index];
+      groups.offer( context, found );
+    }
+  }
+  BOOST_CHECK( groups.size() == 1000 );
+
+  for ( auto & itr : groups.take() ) {
+    std::vector<Entry> const entries = itr.top.take();
+    BOOST_REQUIRE( entries.size() == 1 );
+    BOOST_CHECK( entries[0].time == Time( 1000 + std::stoi( itr.key.substr( 4 ) ) ) );
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,44 @@
+#include "lfl/IdentitySet.hpp"
+#include "lfl/Parallel.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/tools/interface.hpp>
+#include <boost/test/tools/old/interface.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+BOOST_AUTO_TEST_SUITE( test_identity_set )
+
+using namespace lfl;
+
+BOOST_AUTO_TEST_CASE( test_insert ) {
+  ConcurrentIdentitySet set;
+
+  BOOST_CHECK( set.insert( FileIdentity{ 1, 100 } ) );
+  BOOST_CHECK( !set.insert( FileIdentity{ 1, 100 } ) );
+  // ボリュームが違えば、同じファイルインデックスでも別の実体
+  BOOST_CHECK( set.insert( FileIdentity{ 2, 100 } ) );
+  BOOST_CHECK( set.size() == 2 );
+}
+
+BOOST_AUTO_TEST_CASE( test_concurrent_insert ) {
+  STATIC_CONSTEXPR std::size_t THREAD_NUM = 8;
+  STATIC_CONSTEXPR std::uint64_t IDENTITY_NUM = 10000;
+
+  ConcurrentIdentitySet set;
+  std::atomic<std::size_t> first_count( 0 );
+
+  // すべてのスレッドが同じ識別子を登録しても、初めての登録と判定されるのは一度だけ
+  ParallelFor( THREAD_NUM, [ & ]( std::size_t ) {
+    for ( std::uint64_t index = 0; index < IDENTITY_NUM; ++index ) {
+      if ( set.insert( FileIdentity{ 7, index } ) ) { ++first_count; }
+    }
+  } );
+
+  BOOST_CHECK( first_count == IDENTITY_NUM );
+  BOOST_CHECK( set.size() == IDENTITY_NUM );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,48 @@
+#include "lfl/Input.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/tools/interface.hpp>
+#include <boost/test/tools/old/interface.hpp>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE( test_input )
+
+using namespace lfl;
+
+namespace {
+
+std::vector<std::string_view> Split( std::string_view const data, char const delimiter ) {
+  std::vector<std::string_view> records;
+  INPUT::ForEachRecord( data, delimiter, [ &records ]( std::string_view const record ){ records.emplace_back( record ); } );
+  return records;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE( test_lines ) {
+  // 空行は飛ばし、CRLFの'\r'は取り除く。最後の改行は無くてもよい
+  auto const records = Split( "a.txt\r\n\ndir\\b.txt\nc d.txt", '\n' );
+  BOOST_REQUIRE( records.size() == 3 );
+  BOOST_CHECK( records[0] == "a.txt" );
+  BOOST_CHECK( records[1] == "dir\\b.txt" );
+  BOOST_CHECK( records[2] == "c d.txt" );
+
+  BOOST_CHECK( Split( "", '\n' ).empty() );
+}
+
+BOOST_AUTO_TEST_CASE( test_nul ) {
+  // '\0'区切りなら、改行を含む名前もそのまま
+  std::string const data( "new\nline\0b.txt\0", 15 );
+  auto const records = Split( data, '\0' );
+  BOOST_REQUIRE( records.size() == 2 );
+  BOOST_CHECK( records[0] == "new\nline" );
+  BOOST_CHECK( records[1] == "b.txt" );
+
+  // 参照するだけで、コピーしない
+  BOOST_CHECK( records[0].data() == data.data() );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
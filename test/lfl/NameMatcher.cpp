@@ -0,0 +1,81 @@
+#include "lfl/NameMatcher.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/tools/interface.hpp>
+#include <boost/test/tools/old/interface.hpp>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE( test_name_matcher )
+
+using namespace lfl;
+
+namespace {
+
+WideNameMatcher MakeMatcher( std::vector<std::string_view> const & names ) {
+  FilterSpec spec;
+  spec.names = names;
+  return WideNameMatcher( Filter( spec ).patterns() );
+}
+
+// ディレクトリのバッファと同じく、名前の前後に読んでもよい余白を置いて照合する。
+bool Match( WideNameMatcher const & matcher, std::u16string_view const name ) {
+  std::u16string buffer( WIDE_LANES, u'#' );
+  buffer.append( name ).append( WIDE_LANES, u'#' );
+  return matcher.match( buffer.data() + WIDE_LANES, name.size() );
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE( test_enabled ) {
+  BOOST_CHECK( !WideNameMatcher().isEnabled() );
+  BOOST_CHECK( MakeMatcher( { "*.parquet", "*.log", "build*", "*cache*", "Makefile" } ).isEnabled() );
+
+  // 一つでも照合できない形があれば使わない
+  BOOST_CHECK( !MakeMatcher( { "*.log", "a?c" } ).isEnabled() );
+  BOOST_CHECK( !MakeMatcher( { "*.very-long-suffix" } ).isEnabled() );
+  BOOST_CHECK( !MakeMatcher( { "*\x82\xa0*" } ).isEnabled() );
+}
+
+BOOST_AUTO_TEST_CASE( test_suffix ) {
+  auto const matcher = MakeMatcher( { "*.parquet", "*.log" } );
+
+  BOOST_CHECK( Match( matcher, u"part-0001.parquet" ) );
+  BOOST_CHECK( Match( matcher, u"SERVER.LOG" ) );
+  // 名前が8文字より短くても、前の余白とは混ざらない
+  BOOST_CHECK( Match( matcher, u"a.log" ) );
+  BOOST_CHECK( Match( matcher, u".log" ) );
+  BOOST_CHECK( !Match( matcher, u"log" ) );
+  BOOST_CHECK( !Match( matcher, u"a.log.1" ) );
+  BOOST_CHECK( !Match( matcher, u"parquet" ) );
+  // ASCII以外の文字は大文字と小文字をそろえない
+  BOOST_CHECK( !Match( matcher, u"a.lÓg" ) );
+}
+
+BOOST_AUTO_TEST_CASE( test_exact_prefix ) {
+  auto const matcher = MakeMatcher( { "Makefile", "build*" } );
+
+  BOOST_CHECK( Match( matcher, u"makefile" ) );
+  BOOST_CHECK( !Match( matcher, u"Makefile.in" ) );
+  BOOST_CHECK( !Match( matcher, u"GNUmakefile" ) );
+  BOOST_CHECK( Match( matcher, u"Build-2024" ) );
+  BOOST_CHECK( Match( matcher, u"build" ) );
+  BOOST_CHECK( !Match( matcher, u"buil" ) );
+}
+
+BOOST_AUTO_TEST_CASE( test_contains ) {
+  auto const matcher = MakeMatcher( { "*cache*" } );
+
+  BOOST_CHECK( Match( matcher, u"cache" ) );
+  BOOST_CHECK( Match( matcher, u"my-CACHE-dir" ) );
+  // 8文字を越えた位置にあっても見つける
+  BOOST_CHECK( Match( matcher, u"0123456789abcdefcache" ) );
+  BOOST_CHECK( !Match( matcher, u"cach" ) );
+  BOOST_CHECK( !Match( matcher, u"cacxe-cahce" ) );
+  // 最後の文字が余白と重なる位置は候補にしない
+  BOOST_CHECK( !Match( MakeMatcher( { "*e#*" } ), u"cache" ) );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,91 @@
+#include "lfl/Output.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/tools/interface.hpp>
+#include <boost/test/tools/old/interface.hpp>
+
+#include <cstdint>
+#include <string>
+
+BOOST_AUTO_TEST_SUITE( test_output )
+
+using namespace lfl::OUTPUT;
+
+BOOST_AUTO_TEST_CASE( test_buffering ) {
+  BasicWriter<StringDevice, 16> writer;
+
+  writer << "abc" << '\n';
+  // バッファに収まっている間は書き出さない
+  BOOST_CHECK( writer.device().writeCount() == 0 );
+
+  writer << "0123456789" << '\n';
+  BOOST_CHECK( writer.device().writeCount() == 0 );
+
+  // 溢れる分を書こうとしたら、溜まっていた分だけをまとめて書き出す
+  writer << "xyz";
+  BOOST_CHECK( writer.device().writeCount() == 1 );
+  BOOST_CHECK( writer.device().str() == "abc\n0123456789\n" );
+
+  writer.flush();
+  BOOST_CHECK( writer.device().writeCount() == 2 );
+  BOOST_CHECK( writer.device().str() == "abc\n0123456789\nxyz" );
+
+  // 何も溜まっていなければ書き出さない
+  writer.flush();
+  BOOST_CHECK( writer.device().writeCount() == 2 );
+}
+
+BOOST_AUTO_TEST_CASE( test_large_write ) {
+  BasicWriter<StringDevice, 8> writer;
+  std::string const large( 20, 'a' );
+
+  writer << 'b' << large;
+  // バッファより大きな塊はコピーせずに直接書き出す
+  BOOST_CHECK( writer.device().writeCount() == 2 );
+  BOOST_CHECK( writer.device().str() == "b" + large );
+}
+
+BOOST_AUTO_TEST_CASE( test_many_lines ) {
+  BasicWriter<StringDevice, 1024> writer;
+
+  for ( int i = 0; i < 10000; ++i ) { writer << "line\n"; }
+  writer.flush();
+
+  BOOST_CHECK( writer.device().str().size() == 50000 );
+  // 1回の書き出しで204行(1020バイト)ずつ
+  BOOST_CHECK( writer.device().writeCount() == 50 );
+}
+
+BOOST_AUTO_TEST_CASE( test_capture ) {
+  BasicWriter<StringDevice, 8> writer;
+  std::string captured;
+
+  writer << "before";
+  writer.capture( &captured, 32 );
+  // 写すのはフラッシュのときなので、capture()の前に溜まっていた分も写る
+  writer << "+after" << std::string( 10, 'a' );
+  writer.flush();
+  BOOST_CHECK( writer.isCapturing() );
+  BOOST_CHECK( captured == "before+after" + std::string( 10, 'a' ) );
+  BOOST_CHECK( writer.device().str() == captured );
+
+  // 上限を超えたら写すのをやめて、写した分を捨てる
+  writer << std::string( 20, 'b' );
+  writer.flush();
+  BOOST_CHECK( !writer.isCapturing() );
+  BOOST_CHECK( captured.empty() );
+  BOOST_CHECK( writer.device().str() == "before+after" + std::string( 10, 'a' ) + std::string( 20, 'b' ) );
+}
+
+BOOST_AUTO_TEST_CASE( test_formatting ) {
+  BasicWriter<StringDevice, 64> writer;
+  STATIC_CONSTEXPR jig::STRING::Literal literal( "directory" );
+
+  writer << literal << ':' << std::uint64_t( 1234567890123 ) << ',' << -42;
+  writer.flush();
+
+  BOOST_CHECK( writer.device().str() == "directory:1234567890123,-42" );
+  BOOST_CHECK( writer.good() );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
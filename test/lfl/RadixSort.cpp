@@ -0,0 +1,68 @@
+#include "lfl/RadixSort.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/tools/interface.hpp>
+#include <boost/test/tools/old/interface.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE( test_radix_sort )
+
+using namespace lfl;
+
+namespace {
+
+std::vector<SortKey> MakeKeys( std::size_t const size, std::uint64_t const key_mask ) {
+  std::mt19937_64 engine( 12345 );
+  std::vector<SortKey> keys( size );
+
+  for ( std::size_t index = 0; index < size; ++index ) { keys[index] = SortKey{ engine() & key_mask, index }; }
+
+  return keys;
+}
+
+void CheckSorted( std::vector<SortKey> keys, std::size_t const thread_num ) {
+  std::vector<SortKey> expected = keys;
+  std::stable_sort( expected.begin(), expected.end(), []( SortKey const & lhs, SortKey const & rhs ){ return lhs.key < rhs.key; } );
+
+  RadixSort( keys, thread_num );
+
+  BOOST_REQUIRE( keys.size() == expected.size() );
+  bool is_same = true;
+  for ( std::size_t index = 0; index < keys.size(); ++index ) {
+    is_same = is_same && ( keys[index].key == expected[index].key ) && ( keys[index].index == expected[index].index );
+  }
+  BOOST_CHECK( is_same );
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE( test_newer_first_key ) {
+  // 新しい(大きい)時刻ほど小さいキーになる。負の時刻(1970年以前)も含めて順序が保たれる。
+  static_assert( NewerFirstKey( Time( 10 ) ) < NewerFirstKey( Time( 9 ) ) );
+  static_assert( NewerFirstKey( Time( 0 ) ) < NewerFirstKey( Time( -1 ) ) );
+  static_assert( NewerFirstKey( Time( -1 ) ) < NewerFirstKey( Time::Min() ) );
+}
+
+BOOST_AUTO_TEST_CASE( test_small ) {
+  CheckSorted( {}, 1 );
+  CheckSorted( MakeKeys( 1, ~0ULL ), 1 );
+  CheckSorted( MakeKeys( 1000, ~0ULL ), 4 );
+}
+
+// 重複するキーが多くても、元の並びが保たれること(安定性)
+BOOST_AUTO_TEST_CASE( test_stable ) {
+  CheckSorted( MakeKeys( 5000, 0x0F ), 1 );
+  CheckSorted( MakeKeys( 100000, 0xFF00 ), 3 );
+}
+
+// 閾値を超えると複数のスレッドで振り分ける
+BOOST_AUTO_TEST_CASE( test_parallel ) {
+  CheckSorted( MakeKeys( 200003, ~0ULL ), 4 );
+  CheckSorted( MakeKeys( 200003, 0xFFFFFFFFULL << 20 ), 7 );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
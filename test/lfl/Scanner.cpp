@@ -0,0 +1,451 @@
+#include "lfl/Scanner.hpp"
+#include "lfl/Frontier.hpp"
+#include "lfl/MemoryFileSystem.hpp"
+#include "lfl/Sink.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/tools/interface.hpp>
+#include <boost/test/tools/old/interface.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE( test_scanner )
+
+using namespace lfl;
+
+namespace {
+
+// すべてのエントリを受け取れる件数
+constexpr std::size_t ALL = 1 << 20;
+
+Time At( std::int64_t const seconds ) { return Time( seconds * 1000000000 ); }
+
+// C:\root\ ┬ a.txt(10)
+//          ├ sub\ ┬ b.txt(30)
+//          │      └ deep\ ┬ c.txt(50)
+//          │              └ d.txt(20)
+//          └ other\ ─ e.txt(40)
+// ディレクトリの時刻はすべて1
+void MakeTree( MemoryFileSystem & file_system ) {
+  file_system.addDirectory( "C:\\root", At( 1 ) );
+  file_system.addFile( "C:\\root\\a.txt", At( 10 ), 100 );
+  file_system.addDirectory( "C:\\root\\sub", At( 1 ) );
+  file_system.addFile( "C:\\root\\sub\\b.txt", At( 30 ), 300 );
+  file_system.addDirectory( "C:\\root\\sub\\deep", At( 1 ) );
+  file_system.addFile( "C:\\root\\sub\\deep\\c.txt", At( 50 ), 500 );
+  file_system.addFile( "C:\\root\\sub\\deep\\d.txt", At( 20 ), 200 );
+  file_system.addDirectory( "C:\\root\\other", At( 1 ) );
+  file_system.addFile( "C:\\root\\other\\e.txt", At( 40 ), 400 );
+}
+
+// width個のサブディレクトリにfile_num個ずつのファイルを持つ、depth階層の木。
+// 時刻は線形合同法でばらけさせる(同じ時刻は作らない)。
+void MakeWideTree( MemoryFileSystem & file_system, std::string const & path, int const depth, int const width, int const file_num, std::uint64_t & state ) {
+  file_system.addDirectory( path, At( 1 ) );
+  for ( int index = 0; index < file_num; ++index ) {
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    file_system.addFile( path + "\\file_" + std::to_string( index ) + ".dat", Time( static_cast<Time::rep>( ( state >> 24 ) << 7 ) ), index );
+  }
+  if ( depth == 0 ) { return; }
+
+  for ( int index = 0; index < width; ++index ) { MakeWideTree( file_system, path + "\\dir_" + std::to_string( index ), depth - 1, width, file_num, state ); }
+}
+
+ScanConfig MakeConfig( MemoryFileSystem & file_system ) {
+  ScanConfig config;
+  config.file_system = &file_system;
+  config.recursive = true;
+  return config;
+}
+
+struct Found {
+  ScanResult result;
+  std::vector<Entry> entries;
+};
+
+Found ScanTop( ScanConfig const & config, std::size_t const count, std::size_t const thread_num = 1, std::vector<std::string> const & roots = { "C:\\root\\" } ) {
+  std::vector<TopK> tops( thread_num, TopK( count ) );
+  std::vector<Sink *> sinks;
+  for ( auto & itr : tops ) { sinks.emplace_back( &itr ); }
+
+  Found found;
+  found.result = Scan( config, roots, sinks );
+  for ( std::size_t index = 1; index < tops.size(); ++index ) { tops.front().merge( std::move( tops[index] ) ); }
+  found.entries = tops.front().take();
+  return found;
+}
+
+std::vector<std::string> PathsOf( std::vector<Entry> const & entries ) {
+  std::vector<std::string> paths;
+  for ( auto const & itr : entries ) { paths.emplace_back( itr.path ); }
+  return paths;
+}
+
+bool Contains( std::vector<Entry> const & entries, std::string_view const path ) {
+  return std::any_of( entries.begin(), entries.end(), [ path ]( Entry const & entry ){ return entry.path == path; } );
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE( test_recursive ) {
+  MemoryFileSystem file_system;
+  MakeTree( file_system );
+
+  Found const found = ScanTop( MakeConfig( file_system ), 3 );
+  BOOST_CHECK( found.result.errors.empty() );
+  BOOST_CHECK( !found.result.is_approximate );
+  BOOST_CHECK( ( PathsOf( found.entries ) == std::vector<std::string>{ "C:\\root\\sub\\deep\\c.txt", "C:\\root\\other\\e.txt", "C:\\root\\sub\\b.txt" } ) );
+
+  Entry const & newest = found.entries.front();
+  BOOST_CHECK( newest.time.ns() == At( 50 ).ns() );
+  BOOST_CHECK( newest.size == 500 );
+  BOOST_CHECK( newest.type == EntryType::FILE );
+  BOOST_CHECK( newest.name() == "sub\\deep\\c.txt" );
+
+  // ディレクトリもエントリとして報告され、"."と".."は報告されない
+  Found const all = ScanTop( MakeConfig( file_system ), ALL );
+  BOOST_CHECK( all.entries.size() == 8 );
+  BOOST_CHECK( Contains( all.entries, "C:\\root\\sub\\deep" ) );
+  BOOST_CHECK( !Contains( all.entries, "C:\\root\\." ) );
+
+  // ディレクトリは一度ずつ開く
+  BOOST_CHECK( file_system.counters().opens == 4 * 2 );
+}
+
+BOOST_AUTO_TEST_CASE( test_max_depth ) {
+  MemoryFileSystem file_system;
+  MakeTree( file_system );
+
+  ScanConfig config = MakeConfig( file_system );
+  config.max_depth = 2;
+  BOOST_CHECK( ( PathsOf( ScanTop( config, 2 ).entries ) == std::vector<std::string>{ "C:\\root\\other\\e.txt", "C:\\root\\sub\\b.txt" } ) );
+
+  config.recursive = false;
+  Found const found = ScanTop( config, ALL );
+  BOOST_CHECK( found.entries.size() == 3 );
+  BOOST_CHECK( found.entries.front().path == "C:\\root\\a.txt" );
+}
+
+BOOST_AUTO_TEST_CASE( test_parallel ) {
+  MemoryFileSystem file_system;
+  std::uint64_t state = 88172645463325252ULL;
+  MakeWideTree( file_system, "C:\\root", 3, 6, 40, state );
+
+  ScanConfig config = MakeConfig( file_system );
+  Found const expected = ScanTop( config, 50 );
+  BOOST_REQUIRE( expected.entries.size() == 50 );
+
+  // 小さなバッファで、大きなディレクトリを複数のスレッドで分担させる。
+  config.directory_buffer_size = 512;
+  for ( auto const order : { TraversalOrder::DFS, TraversalOrder::BFS, TraversalOrder::BEST } ) {
+    config.order = order;
+    for ( std::size_t const thread_num : { 1, 2, 8 } ) {
+      Found const found = ScanTop( config, 50, thread_num );
+      BOOST_CHECK( found.result.errors.empty() );
+      BOOST_CHECK( PathsOf( found.entries ) == PathsOf( expected.entries ) );
+    }
+  }
+
+  // 読み込み待ちのディレクトリを詰めて持っても、結果は変わらない。
+  config.order = TraversalOrder::DFS;
+  config.max_frontier = 0;
+  BOOST_CHECK( PathsOf( ScanTop( config, 50, 4 ).entries ) == PathsOf( expected.entries ) );
+}
+
+BOOST_AUTO_TEST_CASE( test_access_denied ) {
+  MemoryFileSystem file_system;
+  MakeTree( file_system );
+  file_system.inject( "C:\\root\\sub\\deep", Fault::ACCESS_DENIED );
+
+  // 読めないディレクトリだけを飛ばし、他は読む。ディレクトリそのものは親から見える。
+  for ( std::size_t const thread_num : { 1, 4 } ) {
+    Found const found = ScanTop( MakeConfig( file_system ), ALL, thread_num );
+    BOOST_CHECK( ( found.result.errors == std::vector<std::string>{ "C:\\root\\sub\\deep\\" } ) );
+    BOOST_CHECK( !found.result.is_approximate );
+    BOOST_CHECK( found.entries.front().path == "C:\\root\\other\\e.txt" );
+    BOOST_CHECK( Contains( found.entries, "C:\\root\\sub\\deep" ) );
+    BOOST_CHECK( !Contains( found.entries, "C:\\root\\sub\\deep\\d.txt" ) );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( test_not_found ) {
+  MemoryFileSystem file_system;
+  MakeTree( file_system );
+  for ( int index = 0; index < 100; ++index ) { file_system.addFile( "C:\\root\\other\\many_" + std::to_string( index ) + ".txt", At( 100 + index ) ); }
+
+  // 一回分を読んだところで消される(読めた分は報告する)
+  file_system.inject( "C:\\root\\other\\", Fault::NOT_FOUND, 1 );
+  ScanConfig config = MakeConfig( file_system );
+  config.directory_buffer_size = 1024;
+
+  Found const found = ScanTop( config, ALL );
+  BOOST_CHECK( ( found.result.errors == std::vector<std::string>{ "C:\\root\\other\\" } ) );
+  BOOST_CHECK( Contains( found.entries, "C:\\root\\other\\many_0.txt" ) );
+  BOOST_CHECK( !Contains( found.entries, "C:\\root\\other\\many_99.txt" ) );
+  BOOST_CHECK( Contains( found.entries, "C:\\root\\sub\\deep\\c.txt" ) );
+
+  // 起点そのものが消されていれば、何も見つからない。
+  file_system.inject( "C:\\root", Fault::NOT_FOUND );
+  Found const nothing = ScanTop( config, ALL );
+  BOOST_CHECK( ( nothing.result.errors == std::vector<std::string>{ "C:\\root\\" } ) );
+  BOOST_CHECK( nothing.entries.empty() );
+}
+
+BOOST_AUTO_TEST_CASE( test_deadline ) {
+  MemoryFileSystem file_system;
+  std::uint64_t state = 1;
+  MakeWideTree( file_system, "C:\\root", 3, 4, 2, state );
+  file_system.setLatency( std::chrono::milliseconds( 5 ) );
+
+  ScanConfig config = MakeConfig( file_system );
+  config.deadline = std::chrono::milliseconds( 30 );
+
+  auto const begin = std::chrono::steady_clock::now();
+  Found const found = ScanTop( config, ALL, 2 );
+  auto const elapsed = std::chrono::steady_clock::now() - begin;
+
+  // 85個のディレクトリをすべて読むには、2つのスレッドでも200ms以上かかる。
+  BOOST_CHECK( found.result.is_approximate );
+  BOOST_CHECK( found.result.errors.empty() );
+  BOOST_CHECK( !found.entries.empty() );
+  BOOST_CHECK( elapsed < std::chrono::milliseconds( 200 ) );
+  BOOST_CHECK( file_system.counters().opens < 85 );
+}
+
+BOOST_AUTO_TEST_CASE( test_deadline_last_batch ) {
+  MemoryFileSystem file_system;
+  file_system.addDirectory( "C:\\root", At( 1 ) );
+  file_system.addFile( "C:\\root\\a.txt", At( 10 ) );
+  file_system.addFile( "C:\\root\\b.txt", At( 20 ) );
+  file_system.setLatency( std::chrono::milliseconds( 40 ) );
+
+  // 一回で読み終わるディレクトリを、読んでいる間に期限が過ぎる。
+  // 残りが無いことを確かめてから終わるので、結果は近似にならない。
+  ScanConfig config = MakeConfig( file_system );
+  config.deadline = std::chrono::milliseconds( 60 );
+
+  Found const found = ScanTop( config, ALL );
+  BOOST_CHECK( !found.result.is_approximate );
+  BOOST_CHECK( found.entries.size() == 2 );
+}
+
+BOOST_AUTO_TEST_CASE( test_throttle ) {
+  MemoryFileSystem file_system;
+  MakeTree( file_system );
+  file_system.addDirectory( "C:\\root\\x\\y", At( 1 ) );
+
+  // 一秒に20個なので、6個目のディレクトリは(最初のものから)250ms後にしか開けない。
+  ScanConfig config = MakeConfig( file_system );
+  config.max_directories_per_second = 20;
+
+  auto const begin = std::chrono::steady_clock::now();
+  Found const found = ScanTop( config, ALL, 4 );
+  auto const elapsed = std::chrono::steady_clock::now() - begin;
+
+  BOOST_CHECK( found.result.errors.empty() );
+  BOOST_CHECK( file_system.counters().opens == 6 );
+  BOOST_CHECK( elapsed >= std::chrono::milliseconds( 200 ) );
+}
+
+BOOST_AUTO_TEST_CASE( test_follow_links ) {
+  MemoryFileSystem file_system;
+  MakeTree( file_system );
+  // 親を指すリンク(循環)と、別の枝を指すリンク
+  file_system.addSymlink( "C:\\root\\sub\\loop", "C:\\root", At( 2 ) );
+  file_system.addSymlink( "C:\\root\\other\\deep", "C:\\root\\sub\\deep", At( 2 ) );
+
+  ScanConfig config = MakeConfig( file_system );
+  Found const plain = ScanTop( config, ALL );
+  BOOST_CHECK( plain.entries.size() == 10 );
+  BOOST_CHECK( std::count_if( plain.entries.begin(), plain.entries.end(), []( Entry const & entry ){ return entry.type == EntryType::SYMLINK; } ) == 2 );
+
+  // -Lでは、実体ごとに一度だけ読む(循環しても止まる)。リンクはリンク先の情報で報告する。
+  config.follow_links = true;
+  Found const followed = ScanTop( config, ALL, 4 );
+  BOOST_CHECK( followed.result.errors.empty() );
+  BOOST_CHECK( followed.entries.size() == 10 );
+  BOOST_CHECK( std::none_of( followed.entries.begin(), followed.entries.end(), []( Entry const & entry ){ return entry.type == EntryType::SYMLINK; } ) );
+  BOOST_CHECK( std::count_if( followed.entries.begin(), followed.entries.end(), []( Entry const & entry ){ return entry.path.ends_with( "\\c.txt" ); } ) == 1 );
+}
+
+BOOST_AUTO_TEST_CASE( test_unique_inodes ) {
+  MemoryFileSystem file_system;
+  MakeTree( file_system );
+  file_system.addHardLink( "C:\\root\\other\\c_link.txt", "C:\\root\\sub\\deep\\c.txt" );
+
+  ScanConfig config = MakeConfig( file_system );
+  BOOST_CHECK( ScanTop( config, 2 ).entries[1].time.ns() == At( 50 ).ns() );
+
+  config.unique_inodes = true;
+  Found const found = ScanTop( config, 2 );
+  BOOST_CHECK( found.entries[0].time.ns() == At( 50 ).ns() );
+  BOOST_CHECK( found.entries[1].path == "C:\\root\\other\\e.txt" );
+}
+
+BOOST_AUTO_TEST_CASE( test_gitignore ) {
+  MemoryFileSystem file_system;
+  MakeTree( file_system );
+  file_system.addFile( "C:\\root\\.gitignore", At( 2 ), std::string_view( "deep/\n" ) );
+  file_system.addFile( "C:\\root\\other\\.ignore", At( 3 ), std::string_view( "*.txt\n" ) );
+
+  ScanConfig config = MakeConfig( file_system );
+  config.gitignore = true;
+  Found const found = ScanTop( config, 2 );
+  BOOST_CHECK( ( PathsOf( found.entries ) == std::vector<std::string>{ "C:\\root\\sub\\b.txt", "C:\\root\\a.txt" } ) );
+}
+
+BOOST_AUTO_TEST_CASE( test_scan_paths ) {
+  MemoryFileSystem file_system;
+  MakeTree( file_system );
+
+  std::vector<std::string_view> const paths = { "C:\\root\\a.txt", "C:\\root\\missing.txt", "C:\\root\\sub\\deep\\c.txt" };
+  TopK top( ALL );
+  ScanConfig const config = MakeConfig( file_system );
+  ScanResult const result = ScanPaths( config, paths, { &top } );
+
+  BOOST_CHECK( ( result.errors == std::vector<std::string>{ "C:\\root\\missing.txt" } ) );
+  std::vector<Entry> const entries = top.take();
+  BOOST_REQUIRE( entries.size() == 2 );
+  BOOST_CHECK( entries[0].path == "C:\\root\\sub\\deep\\c.txt" );
+  BOOST_CHECK( entries[0].size == 500 );
+  BOOST_CHECK( entries[1].time.ns() == At( 10 ).ns() );
+}
+
+BOOST_AUTO_TEST_CASE( test_scan_paths_deadline ) {
+  MemoryFileSystem file_system;
+  std::vector<std::string> names;
+  for ( int index = 0; index < 200; ++index ) {
+    names.emplace_back( "C:\\root\\file_" + std::to_string( index ) + ".txt" );
+    file_system.addFile( names.back(), At( index ) );
+  }
+  file_system.setLatency( std::chrono::milliseconds( 2 ) );
+  std::vector<std::string_view> const paths( names.begin(), names.end() );
+
+  // 200個のパスを調べるには400ms以上かかる。
+  ScanConfig config = MakeConfig( file_system );
+  config.deadline = std::chrono::milliseconds( 30 );
+  TopK top( ALL );
+  ScanResult const result = ScanPaths( config, paths, { &top } );
+
+  BOOST_CHECK( result.is_approximate );
+  BOOST_CHECK( result.errors.empty() );
+  BOOST_CHECK( file_system.counters().queries < 100 );
+  BOOST_CHECK( !top.take().empty() );
+
+  // 期限までに調べ終えれば近似ではない。
+  file_system.setLatency( std::chrono::nanoseconds( 0 ) );
+  config.deadline = std::chrono::seconds( 10 );
+  TopK all( ALL );
+  BOOST_CHECK( !ScanPaths( config, paths, { &all } ).is_approximate );
+  BOOST_CHECK( all.take().size() == paths.size() );
+}
+
+BOOST_AUTO_TEST_CASE( test_scan_paths_table ) {
+  MemoryFileSystem file_system;
+  MakeTree( file_system );
+
+  // --from-stdin --sortと同じく、スレッドごとのEntryTableに集めてからまとめる。
+  std::vector<std::string_view> const paths = { "C:\\root\\a.txt", "C:\\root\\sub\\b.txt", "C:\\root\\sub\\deep\\c.txt", "C:\\root\\other\\e.txt" };
+  std::vector<EntryTable> tables( 2 );
+  ScanResult const result = ScanPaths( MakeConfig( file_system ), paths, { &tables[0], &tables[1] } );
+  tables[0].merge( std::move( tables[1] ) );
+
+  BOOST_CHECK( result.errors.empty() );
+  BOOST_REQUIRE( tables[0].size() == paths.size() );
+
+  std::vector<std::string> found;
+  Entry entry;
+  for ( std::size_t index = 0; index < tables[0].size(); ++index ) {
+    tables[0].assign( entry, index );
+    BOOST_CHECK( entry.name() == entry.path );
+    found.emplace_back( entry.path );
+  }
+  std::vector<std::string> expected( paths.begin(), paths.end() );
+  std::sort( found.begin(), found.end() );
+  std::sort( expected.begin(), expected.end() );
+  BOOST_CHECK( found == expected );
+}
+
+BOOST_AUTO_TEST_CASE( test_checkpoint_resume ) {
+  MemoryFileSystem file_system;
+  std::uint64_t state = 5;
+  MakeWideTree( file_system, "C:\\root", 3, 4, 5, state );
+  file_system.inject( "C:\\root\\dir_0\\dir_1", Fault::ACCESS_DENIED );
+  file_system.inject( "C:\\root\\dir_3\\dir_2", Fault::ACCESS_DENIED );
+
+  ScanConfig config = MakeConfig( file_system );
+  Found const expected = ScanTop( config, 20 );
+  std::vector<std::string> expected_errors = expected.result.errors;
+  std::sort( expected_errors.begin(), expected_errors.end() );
+  BOOST_REQUIRE( expected_errors.size() == 2 );
+
+  // 85個のディレクトリを読むのに時間がかかるようにして、走査の途中で一度だけ状態を写す。
+  file_system.setLatency( std::chrono::milliseconds( 2 ) );
+  std::vector<TopK> tops( 2, TopK( 20 ) );
+  TopK saved( 20 );
+  std::vector<DirectoryJob> frontier;
+  std::vector<std::string> saved_errors;
+  bool is_saved = false;
+
+  config.checkpoint.interval = std::chrono::milliseconds( 20 );
+  config.checkpoint.capture = [ & ] {
+    if ( is_saved ) { return; }
+    for ( auto const & itr : tops ) { saved.merge( itr ); }
+  };
+  config.checkpoint.save = [ & ]( std::vector<DirectoryJob> && jobs, std::vector<std::string> && errors ) {
+    if ( is_saved ) { return; }
+    frontier = std::move( jobs );
+    saved_errors = std::move( errors );
+    is_saved = true;
+  };
+  Scan( config, { "C:\\root\\" }, { &tops[0], &tops[1] } );
+  BOOST_REQUIRE( is_saved );
+  BOOST_CHECK( !frontier.empty() );
+
+  // 写したときの状態から、新しいSinkで続ける。
+  file_system.setLatency( std::chrono::milliseconds( 0 ) );
+  config.checkpoint = CheckpointHooks();
+  std::vector<TopK> resumed( 2, TopK( 20 ) );
+  ScanResult const result = Resume( config, std::move( frontier ), { &resumed[0], &resumed[1] } );
+
+  for ( auto & itr : resumed ) { saved.merge( std::move( itr ) ); }
+  BOOST_CHECK( PathsOf( saved.take() ) == PathsOf( expected.entries ) );
+
+  // 保存する前に読めなかったディレクトリと、続けてから読めなかったディレクトリを合わせると、もれも重なりも無い。
+  saved_errors.insert( saved_errors.end(), result.errors.begin(), result.errors.end() );
+  std::sort( saved_errors.begin(), saved_errors.end() );
+  BOOST_CHECK( saved_errors == expected_errors );
+  BOOST_CHECK( !result.is_approximate );
+}
+
+BOOST_AUTO_TEST_CASE( test_checkpoint_max_pause ) {
+  MemoryFileSystem file_system;
+  file_system.addDirectory( "C:\\root", At( 1 ) );
+  file_system.addDirectory( "C:\\root\\big", At( 1 ) );
+  for ( int index = 0; index < 400; ++index ) { file_system.addFile( "C:\\root\\big\\file_" + std::to_string( index ) + ".dat", At( 100 + index ) ); }
+  file_system.setLatency( std::chrono::milliseconds( 2 ) );
+
+  // 大きなディレクトリを読み終えるまでには、小さなバッファで何百回も読むので、max_pauseを待っても読み終わらない。
+  ScanConfig config = MakeConfig( file_system );
+  config.directory_buffer_size = 512;
+  config.checkpoint.interval = std::chrono::milliseconds( 30 );
+  config.checkpoint.max_pause = std::chrono::milliseconds( 5 );
+  std::size_t capture_num = 0, save_num = 0;
+  config.checkpoint.capture = [ & ] { ++capture_num; };
+  config.checkpoint.save = [ & ]( std::vector<DirectoryJob> &&, std::vector<std::string> && ) { ++save_num; };
+
+  // 待ちきれなかった回は写さずに、走査はそのまま最後まで続く。
+  Found const found = ScanTop( config, ALL, 2 );
+  BOOST_CHECK( found.result.errors.empty() );
+  BOOST_CHECK( found.entries.size() == 401 );
+  BOOST_CHECK( capture_num == 0 );
+  BOOST_CHECK( save_num == 0 );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
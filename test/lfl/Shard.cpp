@@ -0,0 +1,105 @@
+#include "lfl/Shard.hpp"
+#include "lfl/Format.hpp"
+#include "lfl/Output.hpp"
+#include "lfl/Sink.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/tools/interface.hpp>
+#include <boost/test/tools/old/interface.hpp>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE( test_shard )
+
+using namespace lfl;
+
+BOOST_AUTO_TEST_CASE( test_hash ) {
+  // FNV-1a(64bit)の既知の値。プロセスや計算機によらず同じになること
+  static_assert( ShardHash( "" ) == 0xCBF29CE484222325ULL );
+  static_assert( ShardHash( "a" ) == 0xAF63DC4C8601EC8CULL );
+}
+
+BOOST_AUTO_TEST_CASE( test_owner ) {
+  STATIC_CONSTEXPR std::uint64_t SHARD_NUM = 3;
+
+  // どのディレクトリも、ちょうど一つの組に割り当てられる
+  std::vector<std::size_t> owned( SHARD_NUM, 0 );
+  for ( int index = 0; index < 300; ++index ) {
+    std::string const path = "project-" + std::to_string( index );
+
+    std::size_t owner_num = 0;
+    for ( std::uint64_t shard = 0; shard < SHARD_NUM; ++shard ) {
+      if ( IsShardOwner( Shard{ shard, SHARD_NUM }, path ) ) {
+        ++owner_num;
+        ++owned[shard];
+      }
+    }
+    BOOST_CHECK( owner_num == 1 );
+  }
+
+  // 極端に偏らない
+  for ( auto const itr : owned ) { BOOST_CHECK( itr > 50 ); }
+
+  // 分担しなければ、すべて自分のもの
+  BOOST_CHECK( IsShardOwner( Shard(), "anything" ) );
+}
+
+BOOST_AUTO_TEST_CASE( test_parse ) {
+  Shard const shard = VALUE::ParseShard( "shard", "2/4" );
+  BOOST_CHECK( shard.index == 2 );
+  BOOST_CHECK( shard.count == 4 );
+  BOOST_CHECK( shard.isSharded() );
+
+  BOOST_CHECK_THROW( VALUE::ParseShard( "shard", "4/4" ), std::invalid_argument );
+  BOOST_CHECK_THROW( VALUE::ParseShard( "shard", "0/0" ), std::invalid_argument );
+  BOOST_CHECK_THROW( VALUE::ParseShard( "shard", "1" ), std::invalid_argument );
+}
+
+// 組ごとの上位k件をバイナリ形式で受け渡してまとめると、全体の上位k件と一致する(lfl mergeと同じ手順)。
+BOOST_AUTO_TEST_CASE( test_merge_partials ) {
+  STATIC_CONSTEXPR std::uint64_t SHARD_NUM = 4;
+  STATIC_CONSTEXPR std::size_t COUNT = 5;
+
+  std::string const root( "root\\" );
+  DirectoryContext const context{ root, 5 };
+  std::vector<std::string> names;
+  for ( int index = 0; index < 100; ++index ) { names.emplace_back( "file-" + std::to_string( index ) ); }
+
+  TopK whole( COUNT );
+  std::vector<std::string> partials;
+  for ( std::uint64_t shard = 0; shard < SHARD_NUM; ++shard ) {
+    TopK top( COUNT );
+    for ( std::size_t index = 0; index < names.size(); ++index ) {
+      if ( !IsShardOwner( Shard{ shard, SHARD_NUM }, names[index] ) ) { continue; }
+      top.offer( context, FoundEntry{ names[index], Time( static_cast<Time::rep>( ( index * 37 ) % 101 ) ), index, EntryType::FILE } );
+    }
+
+    OUTPUT::BasicWriter<OUTPUT::StringDevice, 256> writer;
+    BeginEntries( writer, Format::BINARY );
+    for ( auto const & itr : top.take() ) { WriteEntry( writer, itr, Format::BINARY ); }
+    writer.flush();
+    partials.emplace_back( writer.device().str() );
+  }
+
+  for ( std::size_t index = 0; index < names.size(); ++index ) {
+    whole.offer( context, FoundEntry{ names[index], Time( static_cast<Time::rep>( ( index * 37 ) % 101 ) ), index, EntryType::FILE } );
+  }
+
+  TopK merged( COUNT );
+  Entry entry;
+  for ( auto const & itr : partials ) {
+    BOOST_REQUIRE( FORMAT::ReadBinaryEntries( itr, entry, [ & ]( Entry const & read ) { merged.offer( Entry( read ) ); } ) );
+  }
+
+  std::vector<Entry> const expected = whole.take();
+  std::vector<Entry> const actual = merged.take();
+  BOOST_REQUIRE( actual.size() == expected.size() );
+  for ( std::size_t index = 0; index < expected.size(); ++index ) {
+    BOOST_CHECK( actual[index].path == expected[index].path );
+    BOOST_CHECK( actual[index].time == expected[index].time );
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
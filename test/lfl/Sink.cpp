@@ -0,0 +1,116 @@
+#include "lfl/Sink.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/tools/interface.hpp>
+#include <boost/test/tools/old/interface.hpp>
+
+#include <string>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE( test_sink )
+
+using namespace lfl;
+
+namespace {
+
+FoundEntry Found( std::string_view const name, Time::rep const ns ) { return FoundEntry{ name, Time( ns ), 1, EntryType::FILE }; }
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE( test_top_k ) {
+  std::string const root( "root\\" );
+  std::string const sub( "root\\sub\\" );
+  DirectoryContext const root_context{ root, 5 };
+  DirectoryContext const sub_context{ sub, 5 };
+
+  TopK top1( 2 ), top2( 2 );
+  top1.offer( root_context, Found( "a", 10 ) );
+  top1.offer( root_context, Found( "b", 30 ) );
+  top1.offer( root_context, Found( "c", 20 ) );
+  top2.offer( sub_context, Found( "d", 25 ) );
+  top2.offer( sub_context, Found( "e", 5 ) );
+
+  top1.merge( std::move( top2 ) );
+  std::vector<Entry> const entries = top1.take();
+
+  BOOST_REQUIRE( entries.size() == 2 );
+  BOOST_CHECK( entries[0].path == "root\\b" );
+  BOOST_CHECK( entries[1].path == "root\\sub\\d" );
+  // ファイル名は起点のディレクトリからの相対パス
+  BOOST_CHECK( entries[1].name() == "sub\\d" );
+}
+
+BOOST_AUTO_TEST_CASE( test_top_one ) {
+  std::string const root( "root\\" );
+  DirectoryContext const context{ root, 5 };
+
+  TopK top( 1 );
+  BOOST_CHECK( top.kind() == SinkKind::TOP_K );
+  BOOST_CHECK( top.accepts( Time( 0 ) ) );
+
+  top.offerSingle( context, Found( "a", 10 ) );
+  BOOST_CHECK( top.accepts( Time( 11 ) ) );
+  // 同じ時刻なら先に見つかったものを残す(offerと同じ)。
+  BOOST_CHECK( !top.accepts( Time( 10 ) ) );
+
+  top.offerSingle( context, Found( "b", 30 ) );
+  top.offerSingle( context, Found( "c", 20 ) );
+
+  std::vector<Entry> const entries = top.take();
+  BOOST_REQUIRE( entries.size() == 1 );
+  BOOST_CHECK( entries[0].path == "root\\b" );
+}
+
+BOOST_AUTO_TEST_CASE( test_root_top_k ) {
+  std::string const first( "a\\" );
+  std::string const second( "b\\sub\\" );
+  DirectoryContext const first_context{ first, 2, 0 };
+  DirectoryContext const second_context{ second, 2, 1 };
+
+  RootTopK roots( 2, 1 );
+  roots.enterDirectory( first_context );
+  roots.offer( first_context, Found( "x", 10 ) );
+  roots.enterDirectory( second_context );
+  roots.offer( second_context, Found( "y", 5 ) );
+  roots.enterDirectory( first_context );
+  roots.offer( first_context, Found( "z", 20 ) );
+
+  // 起点ごとに別々に保持する。
+  std::vector<Entry> const first_entries = roots.root( 0 ).take();
+  BOOST_REQUIRE( first_entries.size() == 1 );
+  BOOST_CHECK( first_entries[0].path == "a\\z" );
+
+  std::vector<Entry> const second_entries = roots.root( 1 ).take();
+  BOOST_REQUIRE( second_entries.size() == 1 );
+  BOOST_CHECK( second_entries[0].path == "b\\sub\\y" );
+}
+
+BOOST_AUTO_TEST_CASE( test_entry_table ) {
+  std::string const root( "root\\" );
+  std::string const sub( "root\\sub\\" );
+  DirectoryContext const root_context{ root, 5 };
+  DirectoryContext const sub_context{ sub, 5 };
+
+  EntryTable table1, table2;
+  table1.enterDirectory( root_context );
+  table1.offer( root_context, Found( "a", 10 ) );
+  table1.offer( root_context, Found( "bb", 30 ) );
+  table2.enterDirectory( sub_context );
+  table2.offer( sub_context, Found( "ccc", 20 ) );
+
+  table1.merge( std::move( table2 ) );
+  BOOST_REQUIRE( table1.size() == 3 );
+  BOOST_CHECK( table2.size() == 0 );
+
+  Entry entry;
+  table1.assign( entry, 1 );
+  BOOST_CHECK( entry.path == "root\\bb" );
+  BOOST_CHECK( entry.time.ns() == 30 );
+
+  table1.assign( entry, 2 );
+  BOOST_CHECK( entry.path == "root\\sub\\ccc" );
+  BOOST_CHECK( entry.name() == "sub\\ccc" );
+  BOOST_CHECK( entry.time.ns() == 20 );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,62 @@
+#include "lfl/Throttle.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/tools/interface.hpp>
+#include <boost/test/tools/old/interface.hpp>
+
+#include <chrono>
+#include <cstdint>
+
+BOOST_AUTO_TEST_SUITE( test_throttle )
+
+using namespace lfl;
+using namespace std::chrono_literals;
+
+BOOST_AUTO_TEST_CASE( test_chunk ) {
+  // 一秒の1/20ずつ受け取る。少ないときも一つずつは受け取る
+  BOOST_CHECK( TokenBucket( 1000 ).chunk() == 50 );
+  BOOST_CHECK( TokenBucket( 5 ).chunk() == 1 );
+  BOOST_CHECK( TokenBucket( 1000 ).isEnabled() );
+  BOOST_CHECK( !TokenBucket( 0 ).isEnabled() );
+}
+
+BOOST_AUTO_TEST_CASE( test_reserve ) {
+  TokenBucket bucket( 1000 );
+  auto const now = TokenBucket::clock_type::now();
+
+  // 最初の塊はすぐに使え、続く塊は50個分(50ms)ずつ後になる
+  BOOST_CHECK( bucket.reserve( now ) == now );
+  BOOST_CHECK( bucket.reserve( now ) == now + 50ms );
+  BOOST_CHECK( bucket.reserve( now + 10ms ) == now + 100ms );
+
+  // 使わずにいた時間の分は溜まらない
+  BOOST_CHECK( bucket.reserve( now + 1s ) == now + 1s );
+  BOOST_CHECK( bucket.reserve( now + 1s ) == now + 1s + 50ms );
+}
+
+BOOST_AUTO_TEST_CASE( test_allowance ) {
+  // 制限しなければ待たない
+  TokenBucket unlimited( 0 );
+  TokenAllowance free_tokens( unlimited );
+  for ( int index = 0; index < 100000; ++index ) { BOOST_REQUIRE( free_tokens.take() ); }
+
+  // 一秒に200個(一塊10個)なら、60個を使い切るには少なくとも5塊分(250ms)待つ
+  TokenBucket bucket( 200 );
+  TokenAllowance tokens( bucket );
+  auto const begin = TokenBucket::clock_type::now();
+  for ( int index = 0; index < 60; ++index ) { BOOST_REQUIRE( tokens.take() ); }
+  BOOST_CHECK( TokenBucket::clock_type::now() - begin >= 250ms );
+}
+
+BOOST_AUTO_TEST_CASE( test_limit ) {
+  TokenBucket bucket( 20 );
+  TokenAllowance tokens( bucket );
+  BOOST_CHECK( tokens.take() );
+
+  // 次の塊(50ms後)より前に期限が来るなら、期限まで待って諦める
+  auto const limit = TokenBucket::clock_type::now() + 10ms;
+  BOOST_CHECK( !tokens.take( limit ) );
+  BOOST_CHECK( limit <= TokenBucket::clock_type::now() );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,97 @@
+#include "lfl/Tree.hpp"
+#include "lfl/CmdLine.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/tools/interface.hpp>
+#include <boost/test/tools/old/interface.hpp>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE( test_tree )
+
+using namespace lfl;
+
+namespace {
+
+FoundEntry Found( std::string_view const name, Time::rep const ns ) { return FoundEntry{ name, Time( ns ), 1, EntryType::FILE }; }
+
+// ディレクトリを読むときと同じ順に呼ぶ。
+void Offer( TreeRollup & tree, std::string const & directory, std::string_view const name, Time::rep const ns ) {
+  DirectoryContext const context{ directory, 5 };
+  tree.enterDirectory( context );
+  tree.offer( context, Found( name, ns ) );
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE( test_paths ) {
+  std::string const deep( "root\\a\\b\\c\\" );
+  DirectoryContext const context{ deep, 5 };
+  BOOST_CHECK( TREE::ListedDirectory( context, 1 ) == "root\\" );
+  BOOST_CHECK( TREE::ListedDirectory( context, 2 ) == "root\\a\\" );
+  BOOST_CHECK( TREE::ListedDirectory( context, 3 ) == "root\\a\\b\\" );
+  BOOST_CHECK( TREE::ListedDirectory( context, 10 ) == deep );
+  BOOST_CHECK( TREE::ListedDirectory( context, UNLIMITED_DEPTH ) == deep );
+
+  BOOST_CHECK( TREE::ParentDirectory( "root\\a\\b\\" ) == "root\\a\\" );
+  BOOST_CHECK( TREE::ParentDirectory( "root\\a\\" ) == "root\\" );
+}
+
+BOOST_AUTO_TEST_CASE( test_rollup ) {
+  std::string const root( "root\\" );
+  std::string const a( "root\\a\\" );
+  std::string const ab( "root\\a\\b\\" );
+  std::string const abc( "root\\a\\b\\c\\" );
+  std::string const d( "root\\d\\" );
+
+  TreeRollup first( 3, 1 ), second( 3, 1 );
+  Offer( first, root, "x", 10 );
+  Offer( first, a, "y", 20 );
+  // 一覧に出す深さより深いディレクトリのエントリは、その深さの祖先(root\a\b\)に数える。
+  Offer( second, abc, "z", 40 );
+  Offer( second, ab, "w", 30 );
+  // エントリの無いディレクトリも一覧に出す。
+  DirectoryContext const d_context{ d, 5 };
+  second.enterDirectory( d_context );
+
+  first.merge( std::move( second ) );
+  std::vector<TreeRollup::Node> nodes = first.take();
+
+  BOOST_REQUIRE( nodes.size() == 4 );
+  BOOST_CHECK( nodes[0].directory == root );
+  BOOST_CHECK( nodes[1].directory == a );
+  BOOST_CHECK( nodes[2].directory == ab );
+  BOOST_CHECK( nodes[3].directory == d );
+
+  std::vector<Entry> const newest_root = nodes[0].top.take();
+  BOOST_REQUIRE( newest_root.size() == 1 );
+  BOOST_CHECK( newest_root[0].path == "root\\a\\b\\c\\z" );
+
+  std::vector<Entry> const newest_a = nodes[1].top.take();
+  BOOST_REQUIRE( newest_a.size() == 1 );
+  BOOST_CHECK( newest_a[0].path == "root\\a\\b\\c\\z" );
+
+  BOOST_CHECK( nodes[3].top.take().empty() );
+}
+
+BOOST_AUTO_TEST_CASE( test_missing_parent ) {
+  // 読めなかったディレクトリ(root\a\)を飛ばして、その上に伝える。
+  std::string const ab( "root\\a\\b\\" );
+  std::string const root( "root\\" );
+
+  TreeRollup tree( UNLIMITED_DEPTH, 2 );
+  Offer( tree, root, "x", 10 );
+  Offer( tree, ab, "y", 20 );
+
+  std::vector<TreeRollup::Node> nodes = tree.take();
+  BOOST_REQUIRE( nodes.size() == 2 );
+
+  std::vector<Entry> const entries = nodes[0].top.take();
+  BOOST_REQUIRE( entries.size() == 2 );
+  BOOST_CHECK( entries[0].path == "root\\a\\b\\y" );
+  BOOST_CHECK( entries[1].path == "root\\x" );
+}
+
+BOOST_AUTO_TEST_SUITE_END()